@@ -0,0 +1,253 @@
+#pragma once
+
+#include <utility>
+#include <variant>
+
+#include <llvm/Support/ErrorHandling.h>
+
+#include "AST/Nodes/Decl.hpp"
+#include "AST/Nodes/Expr.hpp"
+#include "AST/Nodes/Stmt.hpp"
+#include "AST/Pattern.hpp"
+#include "AST/TypeSystem/Type.hpp"
+
+namespace phi {
+
+//===----------------------------------------------------------------------===//
+// Kind dispatch
+//===----------------------------------------------------------------------===//
+
+// Both switches are generated from the node lists, so every kind is covered
+// and the compiler can lower each one to a single jump table.
+
+/// Calls \p Fn with \p E cast to its concrete class
+template <typename F> decltype(auto) dispatch(Expr &E, F &&Fn) {
+  switch (E.getKind()) {
+#define EXPR(CLASS, KIND)                                                      \
+  case Expr::Kind::KIND:                                                       \
+    return Fn(static_cast<CLASS &>(E));
+#include "AST/Nodes/ExprNodes.def"
+  }
+  llvm_unreachable("unknown expression kind");
+}
+
+/// Calls \p Fn with \p S cast to its concrete class
+template <typename F> decltype(auto) dispatch(Stmt &S, F &&Fn) {
+  switch (S.getKind()) {
+#define STMT(CLASS, KIND)                                                      \
+  case Stmt::Kind::KIND:                                                       \
+    return Fn(static_cast<CLASS &>(S));
+#include "AST/Nodes/StmtNodes.def"
+  }
+  llvm_unreachable("unknown statement kind");
+}
+
+//===----------------------------------------------------------------------===//
+// ASTVisitor - Kind-switch dispatch over expressions and statements
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief CRTP base that dispatches an Expr or Stmt to its concrete class
+ *
+ * `visit(Expr &)` and `visit(Stmt &)` switch once on `getKind()` and call
+ * `Derived::visit(CLASS &)` for the node's concrete class. The switch is
+ * generated from ExprNodes.def and StmtNodes.def, so a new node kind only
+ * has to be listed there.
+ *
+ * A derived pass pulls the dispatchers in with `using ASTVisitor::visit;` and
+ * declares one `visit` overload per node it handles. A kind the pass does
+ * not handle lands in the default overload below, which is unreachable.
+ *
+ * Walks under another name (for example `finalize`) use the same switch
+ * through `dispatch`, which hands the concrete node to a callable instead.
+ */
+template <typename Derived, typename ExprRetTy = void,
+          typename StmtRetTy = void>
+class ASTVisitor {
+public:
+  ExprRetTy visit(Expr &E) {
+    return dispatch(E, [this](auto &X) -> ExprRetTy {
+      return derived().visit(X);
+    });
+  }
+
+  StmtRetTy visit(Stmt &S) {
+    return dispatch(S, [this](auto &X) -> StmtRetTy {
+      return derived().visit(X);
+    });
+  }
+
+  // Defaults for kinds a pass does not handle. Without these, a missing
+  // overload would convert back to Expr & and recurse forever.
+#define EXPR(CLASS, KIND)                                                      \
+  ExprRetTy visit(CLASS &) { llvm_unreachable("unhandled " #CLASS); }
+#include "AST/Nodes/ExprNodes.def"
+#define STMT(CLASS, KIND)                                                      \
+  StmtRetTy visit(CLASS &) { llvm_unreachable("unhandled " #CLASS); }
+#include "AST/Nodes/StmtNodes.def"
+
+protected:
+  Derived &derived() { return static_cast<Derived &>(*this); }
+};
+
+//===----------------------------------------------------------------------===//
+// RecursiveASTVisitor - Walks every expression and statement in a body
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief ASTVisitor whose default for every node is to visit its children
+ *
+ * A pass overrides only the nodes it cares about, and calls
+ * `RecursiveASTVisitor::visit(X)` from an override to keep descending.
+ * Types written in the source (variable annotations, explicit type arguments
+ * and cast targets) are handed to `visitType`, which does nothing by default.
+ *
+ * A match arm's result expression is the tail of its body, so only the body
+ * is walked.
+ */
+template <typename Derived>
+class RecursiveASTVisitor : public ASTVisitor<Derived> {
+  using Base = ASTVisitor<Derived>;
+  using Base::derived;
+
+public:
+  using Base::visit;
+
+  void visitType(TypeRef) {}
+
+  void visit(Block &B) {
+    for (auto &S : B.getStmts()) {
+      derived().visit(*S);
+    }
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Statements
+  //===--------------------------------------------------------------------===//
+
+  void visit(ReturnStmt &S) {
+    if (S.hasExpr()) {
+      derived().visit(S.getExpr());
+    }
+  }
+  void visit(DeferStmt &S) { derived().visit(S.getDeferred()); }
+  void visit(IfStmt &S) {
+    derived().visit(S.getCond());
+    derived().visit(S.getThen());
+    if (S.hasElse()) {
+      derived().visit(S.getElse());
+    }
+  }
+  void visit(WhileStmt &S) {
+    derived().visit(S.getCond());
+    derived().visit(S.getBody());
+  }
+  void visit(ForStmt &S) {
+    derived().visit(S.getRange());
+    derived().visit(S.getBody());
+  }
+  void visit(DeclStmt &S) {
+    for (auto &Var : S.getDecls()) {
+      if (Var->hasType()) {
+        derived().visitType(Var->getType());
+      }
+    }
+    if (S.hasInit()) {
+      derived().visit(S.getInit());
+    }
+  }
+  void visit(ContinueStmt &) {}
+  void visit(BreakStmt &) {}
+  void visit(ExprStmt &S) { derived().visit(S.getExpr()); }
+  void visit(ImportStmt &) {}
+  void visit(UseStmt &) {}
+
+  //===--------------------------------------------------------------------===//
+  // Expressions
+  //===--------------------------------------------------------------------===//
+
+  void visit(IntLiteral &) {}
+  void visit(FloatLiteral &) {}
+  void visit(StrLiteral &) {}
+  void visit(CharLiteral &) {}
+  void visit(BoolLiteral &) {}
+  void visit(RangeLiteral &E) {
+    derived().visit(E.getStart());
+    derived().visit(E.getEnd());
+  }
+  void visit(TupleLiteral &E) {
+    for (auto &Elem : E.getElements()) {
+      derived().visit(*Elem);
+    }
+  }
+  void visit(ArrayLiteral &E) {
+    for (auto &Elem : E.getElements()) {
+      derived().visit(*Elem);
+    }
+  }
+  void visit(DeclRefExpr &) {}
+  void visit(FunCallExpr &E) {
+    derived().visit(E.getCallee());
+    for (auto &Ty : E.getTypeArgs()) {
+      derived().visitType(Ty);
+    }
+    for (auto &Arg : E.getArgs()) {
+      derived().visit(*Arg);
+    }
+  }
+  void visit(BinaryOp &E) {
+    derived().visit(E.getLhs());
+    derived().visit(E.getRhs());
+  }
+  void visit(UnaryOp &E) { derived().visit(E.getOperand()); }
+  void visit(MemberInit &E) {
+    if (E.getInitValue()) {
+      derived().visit(*E.getInitValue());
+    }
+  }
+  void visit(FieldAccessExpr &E) { derived().visit(*E.getBase()); }
+  void visit(MethodCallExpr &E) {
+    derived().visit(*E.getBase());
+    for (auto &Ty : E.getTypeArgs()) {
+      derived().visitType(Ty);
+    }
+    for (auto &Arg : E.getArgs()) {
+      derived().visit(*Arg);
+    }
+  }
+  void visit(MatchExpr &E) {
+    derived().visit(*E.getScrutinee());
+    for (auto &Arm : E.getArms()) {
+      for (auto &Pat : Arm.Patterns) {
+        if (auto *Lit = std::get_if<PatternAtomics::Literal>(&Pat)) {
+          derived().visit(*Lit->Value);
+        }
+      }
+      derived().visit(*Arm.Body);
+    }
+  }
+  void visit(AdtInit &E) {
+    for (auto &Ty : E.getTypeArgs()) {
+      derived().visitType(Ty);
+    }
+    for (auto &Init : E.getInits()) {
+      derived().visit(*Init);
+    }
+  }
+  void visit(IntrinsicCall &E) {
+    for (auto &Arg : E.getArgs()) {
+      derived().visit(*Arg);
+    }
+  }
+  void visit(TupleIndex &E) { derived().visit(*E.getBase()); }
+  void visit(ArrayIndex &E) {
+    derived().visit(*E.getBase());
+    derived().visit(*E.getIndex());
+  }
+  void visit(CastExpr &E) {
+    derived().visit(*E.getFrom());
+    derived().visitType(E.getTo());
+  }
+};
+
+} // namespace phi
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include <llvm/ADT/DenseMapInfo.h>
+#include <llvm/ADT/StringRef.h>
+
+namespace phi {
+
+//===----------------------------------------------------------------------===//
+// Identifier - Interned name handle
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief A handle to a uniqued identifier spelling
+ *
+ * Every distinct spelling is stored once in a process-wide table, together
+ * with its hash, and an Identifier is a pointer to that entry. Two
+ * identifiers are equal exactly when their pointers are, and hashing one
+ * never touches its characters. Interning is safe to call concurrently;
+ * reading an existing Identifier needs no synchronisation at all.
+ */
+class Identifier {
+public:
+  //===--------------------------------------------------------------------===//
+  // Constructors
+  //===--------------------------------------------------------------------===//
+
+  /// The empty identifier
+  Identifier();
+
+  /// Interns \p Str, reusing the existing entry if it was seen before.
+  /// Interning takes a global lock, so conversions are always spelled out.
+  explicit Identifier(llvm::StringRef Str);
+  explicit Identifier(const std::string &Str)
+      : Identifier(llvm::StringRef(Str)) {}
+  explicit Identifier(const char *Str) : Identifier(llvm::StringRef(Str)) {}
+
+  /// Returns the identifier spelled \p Str if it was ever interned, without
+  /// adding it. A spelling nobody interned cannot name any declaration.
+  static std::optional<Identifier> find(llvm::StringRef Str);
+
+  //===--------------------------------------------------------------------===//
+  // Getters
+  //===--------------------------------------------------------------------===//
+
+  [[nodiscard]] const std::string &str() const { return E->Str; }
+  [[nodiscard]] unsigned getHash() const { return E->Hash; }
+  [[nodiscard]] bool empty() const { return E->Str.empty(); }
+  [[nodiscard]] const void *getOpaqueValue() const { return E; }
+
+  //===--------------------------------------------------------------------===//
+  // Comparison
+  //===--------------------------------------------------------------------===//
+
+  friend bool operator==(Identifier A, Identifier B) { return A.E == B.E; }
+  friend bool operator!=(Identifier A, Identifier B) { return A.E != B.E; }
+
+  /// Orders by spelling, for output that must not depend on addresses
+  friend bool operator<(Identifier A, Identifier B) {
+    return A.E->Str < B.E->Str;
+  }
+
+  /// Storage for one interned spelling; owned by the identifier table
+  struct Entry {
+    std::string Str;
+    unsigned Hash;
+  };
+
+private:
+  friend struct llvm::DenseMapInfo<Identifier>;
+
+  explicit Identifier(const Entry *E) : E(E) {}
+
+  const Entry *E;
+};
+
+} // namespace phi
+
+namespace llvm {
+
+template <> struct DenseMapInfo<phi::Identifier> {
+  static phi::Identifier getEmptyKey() {
+    return phi::Identifier(
+        DenseMapInfo<const phi::Identifier::Entry *>::getEmptyKey());
+  }
+  static phi::Identifier getTombstoneKey() {
+    return phi::Identifier(
+        DenseMapInfo<const phi::Identifier::Entry *>::getTombstoneKey());
+  }
+  static unsigned getHashValue(phi::Identifier Id) { return Id.getHash(); }
+  static bool isEqual(phi::Identifier A, phi::Identifier B) { return A == B; }
+};
+
+} // namespace llvm
+
+template <> struct std::hash<phi::Identifier> {
+  std::size_t operator()(phi::Identifier Id) const { return Id.getHash(); }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+#include "AST/TypeSystem/Type.hpp"
+
+namespace phi {
+
+class NamedDecl;
+
+//===----------------------------------------------------------------------===//
+// TypeInstantiation - Represents a specific instantiation of a generic type
+//===----------------------------------------------------------------------===//
+
+struct TypeInstantiation {
+  const NamedDecl *GenericDecl;
+  std::vector<TypeRef> TypeArgs;
+
+  bool operator==(const TypeInstantiation &Other) const {
+    if (GenericDecl != Other.GenericDecl)
+      return false;
+    if (TypeArgs.size() != Other.TypeArgs.size())
+      return false;
+    for (size_t I = 0; I < TypeArgs.size(); ++I) {
+      if (TypeArgs[I].getPtr() != Other.TypeArgs[I].getPtr())
+        return false;
+    }
+    return true;
+  }
+};
+
+struct TypeInstantiationHash {
+  std::size_t operator()(const TypeInstantiation &TI) const noexcept {
+    std::size_t H = std::hash<const void *>()(TI.GenericDecl);
+    for (const auto &Arg : TI.TypeArgs) {
+      H ^= std::hash<const void *>()(Arg.getPtr()) + 0x9e3779b9 + (H << 6) +
+           (H >> 2);
+    }
+    return H;
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// InstantiationSet - Deduplicated instantiations in first-seen order
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief The concrete instantiations a module's bodies use
+ *
+ * Filled in by type finalization, which is where every generic use gets its
+ * concrete type arguments, and consumed by monomorphization. Iteration
+ * follows the order in which instantiations were first recorded.
+ */
+class InstantiationSet {
+public:
+  /// Returns true if \p TI was not in the set yet
+  bool insert(TypeInstantiation TI) {
+    if (!Seen.insert(TI).second) {
+      return false;
+    }
+    Order.push_back(std::move(TI));
+    return true;
+  }
+
+  using const_iterator = std::vector<TypeInstantiation>::const_iterator;
+  [[nodiscard]] const_iterator begin() const { return Order.begin(); }
+  [[nodiscard]] const_iterator end() const { return Order.end(); }
+  [[nodiscard]] std::size_t size() const { return Order.size(); }
+  [[nodiscard]] bool empty() const { return Order.empty(); }
+
+  void append(const InstantiationSet &Other) {
+    for (const auto &TI : Other) {
+      insert(TI);
+    }
+  }
+
+private:
+  std::vector<TypeInstantiation> Order;
+  std::unordered_set<TypeInstantiation, TypeInstantiationHash> Seen;
+};
+
+} // namespace phi
@@ -10,8 +10,11 @@
 #include <utility>
 #include <vector>
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/Support/Casting.h>
 
+#include "AST/Identifier.hpp"
+#include "AST/Instantiation.hpp"
 #include "AST/Nodes/Stmt.hpp"
 #include "AST/TypeSystem/Context.hpp"
 #include "AST/TypeSystem/Type.hpp"
@@ -39,6 +42,14 @@ enum class Mutability {
   Var,
 };
 
+/// An item attribute: `#[Name]` or `#[Name(Args...)]`. The name resolver
+/// checks that the attribute exists and fits the item.
+struct Attribute {
+  SrcSpan Span;
+  std::string Name;
+  std::vector<std::string> Args;
+};
+
 //===----------------------------------------------------------------------===//
 // Decl - Root of all declarations
 //===----------------------------------------------------------------------===//
@@ -90,22 +101,22 @@ protected:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  NamedDecl(Kind K, SrcSpan Span, std::string Id)
-      : Decl(K, Span), Id(std::move(Id)) {}
+  NamedDecl(Kind K, SrcSpan Span, Identifier Id) : Decl(K, Span), Id(Id) {}
 
 public:
   //===--------------------------------------------------------------------===//
   // Getters
   //===--------------------------------------------------------------------===//
-  [[nodiscard]] const std::string &getId() const { return Id; }
+  [[nodiscard]] const std::string &getId() const { return Id.str(); }
+  [[nodiscard]] Identifier getIdentifier() const { return Id; }
 
 private:
-  const std::string Id;
+  const Identifier Id;
 };
 
 class TypeArgDecl : public NamedDecl {
 public:
-  TypeArgDecl(SrcSpan Span, std::string Id)
+  TypeArgDecl(SrcSpan Span, Identifier Id)
       : NamedDecl(Decl::Kind::TypeArg, std::move(Span), std::move(Id)) {}
 
   static bool classof(const Decl *D) { return D->getKind() == Kind::TypeArg; }
@@ -122,7 +133,7 @@ protected:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  ItemDecl(Kind K, SrcSpan Span, Visibility Vis, std::string Id,
+  ItemDecl(Kind K, SrcSpan Span, Visibility Vis, Identifier Id,
            std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs)
       : NamedDecl(K, Span, std::move(Id)), TheVisibility(Vis),
         TypeArgs(std::move(TypeArgs)) {}
@@ -137,6 +148,21 @@ public:
   [[nodiscard]] Visibility getVisibility() const { return TheVisibility; }
   void setVisibility(Visibility Vis) { TheVisibility = Vis; }
 
+  /// Whether the item's body is needed by the program. Items start out
+  /// reachable; the reachability pass clears this for the ones it is not.
+  [[nodiscard]] bool isReachable() const { return Reachable; }
+  void setReachable(bool R) { Reachable = R; }
+
+  [[nodiscard]] auto &getAttrs() const { return Attrs; }
+  void setAttrs(std::vector<Attribute> A) { Attrs = std::move(A); }
+  [[nodiscard]] const Attribute *getAttr(std::string_view Name) const {
+    for (const auto &A : Attrs) {
+      if (A.Name == Name)
+        return &A;
+    }
+    return nullptr;
+  }
+
   //===--------------------------------------------------------------------===//
   // LLVM-style RTTI
   //===--------------------------------------------------------------------===//
@@ -155,6 +181,8 @@ public:
 private:
   Visibility TheVisibility;
   std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs;
+  std::vector<Attribute> Attrs;
+  bool Reachable = true;
 };
 
 //===----------------------------------------------------------------------===//
@@ -166,7 +194,7 @@ protected:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  LocalDecl(Kind K, SrcSpan Span, std::string Id, TypeRef Type)
+  LocalDecl(Kind K, SrcSpan Span, Identifier Id, TypeRef Type)
       : NamedDecl(K, Span, std::move(Id)), Type(Type) {}
 
 public:
@@ -194,7 +222,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  ParamDecl(SrcSpan Span, Mutability TheMutability, std::string Id,
+  ParamDecl(SrcSpan Span, Mutability TheMutability, Identifier Id,
             TypeRef Type);
 
   //===--------------------------------------------------------------------===//
@@ -217,7 +245,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  VarDecl(SrcSpan Span, Mutability TheMutability, std::string Id,
+  VarDecl(SrcSpan Span, Mutability TheMutability, Identifier Id,
           std::optional<TypeRef> Type);
 
   //===--------------------------------------------------------------------===//
@@ -254,7 +282,7 @@ protected:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  MemberDecl(Kind K, SrcSpan Span, Visibility Vis, std::string Id)
+  MemberDecl(Kind K, SrcSpan Span, Visibility Vis, Identifier Id)
       : NamedDecl(K, Span, std::move(Id)), TheVisibility(Vis) {}
 
 public:
@@ -283,7 +311,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  FieldDecl(SrcSpan Span, uint32_t Index, Visibility Vis, std::string Id,
+  FieldDecl(SrcSpan Span, uint32_t Index, Visibility Vis, Identifier Id,
             TypeRef Type, std::unique_ptr<Expr> Init);
 
   //===--------------------------------------------------------------------===//
@@ -320,7 +348,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  MethodDecl(SrcSpan Span, Visibility Vis, std::string Id,
+  MethodDecl(SrcSpan Span, Visibility Vis, Identifier Id,
              std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
              std::vector<std::unique_ptr<ParamDecl>> Params, TypeRef ReturnType,
              std::unique_ptr<Block> Body);
@@ -367,7 +395,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  VariantDecl(SrcSpan Span, std::string Id, std::optional<TypeRef> PayloadType);
+  VariantDecl(SrcSpan Span, Identifier Id, std::optional<TypeRef> PayloadType);
 
   //===--------------------------------------------------------------------===//
   // Getters
@@ -398,14 +426,14 @@ protected:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  AdtDecl(Kind K, SrcSpan Span, Visibility Vis, std::string Id,
+  AdtDecl(Kind K, SrcSpan Span, Visibility Vis, Identifier Id,
           std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
           std::vector<std::unique_ptr<MethodDecl>> Methods)
       : ItemDecl(K, Span, Vis, Id, std::move(TypeArgs)),
-        Type(TypeCtx::getAdt(std::move(Id), this, Span)),
+        Type(TypeCtx::getAdt(Id, this, Span)),
         Methods(std::move(Methods)) {
     for (auto &M : this->Methods) {
-      MethodMap.emplace(M->getId(), M.get());
+      MethodMap.try_emplace(M->getIdentifier(), M.get());
       M->setParent(this);
     }
 
@@ -414,7 +442,8 @@ protected:
       TArgs.reserve(getTypeArgs().size());
       for (auto &Arg : getTypeArgs()) {
         TArgs.push_back(
-            TypeCtx::getGeneric(Arg->getId(), Arg.get(), Arg->getSpan()));
+            TypeCtx::getGeneric(Arg->getIdentifier(), Arg.get(),
+                                Arg->getSpan()));
       }
       Type = TypeCtx::getApplied(Type, TArgs, this->getSpan());
     }
@@ -426,7 +455,7 @@ public:
   //===--------------------------------------------------------------------===//
   [[nodiscard]] auto &getType() const { return Type; }
   [[nodiscard]] auto &getMethods() const { return Methods; }
-  [[nodiscard]] auto *getMethod(const std::string &Id) const {
+  [[nodiscard]] auto *getMethod(Identifier Id) const {
     auto It = MethodMap.find(Id);
     return It != MethodMap.end() ? It->second : nullptr;
   }
@@ -438,7 +467,7 @@ public:
 protected:
   TypeRef Type;
   std::vector<std::unique_ptr<MethodDecl>> Methods;
-  std::unordered_map<std::string, MethodDecl *> MethodMap;
+  llvm::DenseMap<Identifier, MethodDecl *> MethodMap;
 };
 
 //===----------------------------------------------------------------------===//
@@ -450,7 +479,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  StructDecl(SrcSpan Span, Visibility Vis, std::string Id,
+  StructDecl(SrcSpan Span, Visibility Vis, Identifier Id,
              std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
              std::vector<std::unique_ptr<FieldDecl>> Fields,
              std::vector<std::unique_ptr<MethodDecl>> Methods);
@@ -459,7 +488,7 @@ public:
   // Getters
   //===--------------------------------------------------------------------===//
   auto &getFields() const { return Fields; }
-  auto *getField(const std::string &Id) const {
+  auto *getField(Identifier Id) const {
     auto It = FieldMap.find(Id);
     return It == FieldMap.end() ? nullptr : It->second;
   }
@@ -476,7 +505,7 @@ public:
 
 private:
   std::vector<std::unique_ptr<FieldDecl>> Fields;
-  std::unordered_map<std::string, FieldDecl *> FieldMap;
+  llvm::DenseMap<Identifier, FieldDecl *> FieldMap;
 };
 
 //===----------------------------------------------------------------------===//
@@ -488,7 +517,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  EnumDecl(SrcSpan Span, Visibility Vis, std::string Id,
+  EnumDecl(SrcSpan Span, Visibility Vis, Identifier Id,
            std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
            std::vector<std::unique_ptr<VariantDecl>> Variants,
            std::vector<std::unique_ptr<MethodDecl>> Methods);
@@ -497,7 +526,7 @@ public:
   // Getters
   //===--------------------------------------------------------------------===//
   auto &getVariants() const { return Variants; }
-  auto *getVariant(const std::string &Id) const {
+  auto *getVariant(Identifier Id) const {
     auto It = VariantMap.find(Id);
     return It == VariantMap.end() ? nullptr : It->second;
   }
@@ -514,7 +543,7 @@ public:
 
 private:
   std::vector<std::unique_ptr<VariantDecl>> Variants;
-  std::unordered_map<std::string, VariantDecl *> VariantMap;
+  llvm::DenseMap<Identifier, VariantDecl *> VariantMap;
 };
 
 //===----------------------------------------------------------------------===//
@@ -526,7 +555,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  FunDecl(SrcSpan Span, Visibility Vis, std::string Id,
+  FunDecl(SrcSpan Span, Visibility Vis, Identifier Id,
           std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
           std::vector<std::unique_ptr<ParamDecl>> Params, TypeRef ReturnType,
           std::unique_ptr<Block> Body);
@@ -563,7 +592,7 @@ public:
   //===--------------------------------------------------------------------===//
   // Constructors
   //===--------------------------------------------------------------------===//
-  ModuleDecl(SrcSpan PathSpan, Visibility Vis, std::string Id,
+  ModuleDecl(SrcSpan PathSpan, Visibility Vis, Identifier Id,
              std::vector<std::string> Path,
              std::vector<std::unique_ptr<ItemDecl>> Items,
              std::vector<std::unique_ptr<ImportStmt>> Imports,
@@ -577,6 +606,9 @@ public:
   auto &getPublicItems() { return PublicItems; }
   auto &getImports() { return Imports; }
   auto &getUses() { return Uses; }
+  /// Generic instantiations used by this module's bodies, recorded during
+  /// type finalization
+  auto &getInstantiations() { return Instantiations; }
   auto contains(const ItemDecl *Query) {
     for (auto &Item : Items) {
       if (Query == Item.get()) {
@@ -612,11 +644,12 @@ private:
   std::vector<ItemDecl *> PublicItems;
   std::vector<ImportStmt> Imports;
   std::vector<UseStmt> Uses;
+  InstantiationSet Instantiations;
 };
 
 class TraitDecl : public ItemDecl {
 public:
-  TraitDecl(SrcSpan Span, Visibility Vis, std::string Id,
+  TraitDecl(SrcSpan Span, Visibility Vis, Identifier Id,
             std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
             std::vector<std::unique_ptr<MethodDecl>> Behaviors);
 
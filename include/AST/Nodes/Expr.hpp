@@ -39,27 +39,8 @@ class Expr {
 public:
   /// @brief Kind enumeration for LLVM RTTI
   enum class Kind : uint8_t {
-    IntLiteralKind,
-    FloatLiteralKind,
-    StrLiteralKind,
-    CharLiteralKind,
-    BoolLiteralKind,
-    RangeLiteralKind,
-    TupleLiteralKind,
-    ArrayLiteralKind,
-    DeclRefKind,
-    FunCallKind,
-    BinaryOpKind,
-    UnaryOpKind,
-    MemberInitKind,
-    FieldAccessKind,
-    MethodCallKind,
-    MatchExprKind,
-    AdtInitKind,
-    IntrinsicCallKind,
-    TupleIndexKind,
-    ArrayIndexKind,
-    CastKind,
+#define EXPR(CLASS, KIND) KIND,
+#include "AST/Nodes/ExprNodes.def"
   };
 
   //===--------------------------------------------------------------------===//
@@ -439,13 +420,14 @@ public:
   // Constructors & Destructors
   //===--------------------------------------------------------------------===//
 
-  DeclRefExpr(SrcLocation Location, std::string Id);
+  DeclRefExpr(SrcLocation Location, Identifier Id);
 
   //===--------------------------------------------------------------------===//
   // Getters
   //===--------------------------------------------------------------------===//
 
-  [[nodiscard]] std::string getId() { return Id; }
+  [[nodiscard]] const std::string &getId() const { return Id.str(); }
+  [[nodiscard]] Identifier getIdentifier() const { return Id; }
   [[nodiscard]] LocalDecl *getDecl() const { return DeclPtr; }
 
   //===--------------------------------------------------------------------===//
@@ -475,7 +457,7 @@ public:
   void emit(int Level) const override;
 
 private:
-  std::string Id;
+  Identifier Id;
   LocalDecl *DeclPtr = nullptr;
 };
 
@@ -648,7 +630,7 @@ public:
   // Constructors & Destructors
   //===-----------------------------------------------------------------------//
 
-  MemberInit(SrcLocation Location, std::string FieldId,
+  MemberInit(SrcLocation Location, Identifier FieldId,
              std::unique_ptr<Expr> Init);
   ~MemberInit() override;
 
@@ -656,7 +638,8 @@ public:
   // Getters
   //===-----------------------------------------------------------------------//
 
-  [[nodiscard]] const std::string &getId() const { return FieldId; }
+  [[nodiscard]] const std::string &getId() const { return FieldId.str(); }
+  [[nodiscard]] Identifier getIdentifier() const { return FieldId; }
   [[nodiscard]] FieldDecl *getDecl() const { return Decl; }
   [[nodiscard]] Expr *getInitValue() const { return InitValue.get(); }
 
@@ -687,7 +670,7 @@ public:
   void emit(int Level) const override;
 
 private:
-  std::string FieldId;
+  Identifier FieldId;
   std::unique_ptr<Expr> InitValue;
   FieldDecl *Decl = nullptr;
 };
@@ -699,7 +682,7 @@ private:
 
 class AdtInit final : public Expr {
 public:
-  AdtInit(SrcLocation Location, std::optional<std::string> TypeName,
+  AdtInit(SrcLocation Location, std::optional<Identifier> TypeName,
           std::vector<TypeRef> TypeArgs,
           std::vector<std::unique_ptr<MemberInit>> Inits);
   ~AdtInit() override;
@@ -708,7 +691,10 @@ public:
   // Getters
   //===--------------------------------------------------------------------===//
 
-  [[nodiscard]] const auto &getTypeName() const { return *TypeName; }
+  [[nodiscard]] const std::string &getTypeName() const {
+    return TypeName->str();
+  }
+  [[nodiscard]] Identifier getTypeIdentifier() const { return *TypeName; }
   [[nodiscard]] auto hasTypeArgs() const { return !TypeArgs.empty(); }
   [[nodiscard]] auto &getTypeArgs() { return TypeArgs; }
   [[nodiscard]] const auto &getInits() const { return Inits; }
@@ -774,7 +760,7 @@ public:
   void emit(int Level) const override;
 
 private:
-  std::optional<std::string> TypeName;
+  std::optional<Identifier> TypeName;
   std::vector<TypeRef> TypeArgs;
   std::vector<std::unique_ptr<MemberInit>> Inits;
 
@@ -795,7 +781,7 @@ public:
   //===-----------------------------------------------------------------------//
 
   FieldAccessExpr(SrcLocation Location, std::unique_ptr<Expr> Base,
-                  std::string MemberId);
+                  Identifier MemberId);
   ~FieldAccessExpr() override;
 
   //===--------------------------------------------------------------------===//
@@ -804,7 +790,8 @@ public:
 
   [[nodiscard]] const FieldDecl *getField() const { return Field; }
   [[nodiscard]] Expr *getBase() const { return Base.get(); }
-  [[nodiscard]] const std::string &getFieldId() const { return FieldId; }
+  [[nodiscard]] const std::string &getFieldId() const { return FieldId.str(); }
+  [[nodiscard]] Identifier getFieldIdentifier() const { return FieldId; }
 
   //===--------------------------------------------------------------------===//
   // Setters
@@ -834,7 +821,7 @@ public:
 
 private:
   std::unique_ptr<Expr> Base;
-  std::string FieldId;
+  Identifier FieldId;
   FieldDecl *Field = nullptr;
 };
 
@@ -1004,6 +991,7 @@ public:
 
   [[nodiscard]] Expr *getBase() const { return Base.get(); }
   [[nodiscard]] Expr *getIndex() const { return Index.get(); }
+  [[nodiscard]] std::unique_ptr<Expr> takeIndex() { return std::move(Index); }
 
   //===--------------------------------------------------------------------===//
   // Type Queries
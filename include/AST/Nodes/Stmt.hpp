@@ -22,18 +22,8 @@ class Stmt {
 public:
   /// @brief Kind enumeration for LLVM RTTI
   enum class Kind : uint8_t {
-    // Statements
-    ReturnStmtKind,
-    DeferStmtKind,
-    IfStmtKind,
-    WhileStmtKind,
-    ForStmtKind,
-    DeclStmtKind,
-    ContinueStmtKind,
-    BreakStmtKind,
-    ExprStmtKind,
-    ImportStmtKind,
-    UseStmtKind,
+#define STMT(CLASS, KIND) KIND,
+#include "AST/Nodes/StmtNodes.def"
   };
 
   //===--------------------------------------------------------------------===//
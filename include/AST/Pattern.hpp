@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AST/Identifier.hpp"
 #include "AST/Nodes/Stmt.hpp"
 #include "SrcManager/SrcLocation.hpp"
 
@@ -16,7 +17,7 @@ struct Literal {
 };
 
 struct Variant {
-  std::string VariantName;
+  phi::Identifier VariantName;
   std::vector<std::unique_ptr<phi::VarDecl>> Vars;
   phi::SrcLocation Location;
 };
@@ -2,11 +2,17 @@
 
 #include <cstdint>
 #include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <llvm/ADT/DenseMap.h>
+
+#include "AST/Identifier.hpp"
 #include "AST/TypeSystem/Type.hpp"
 #include "SrcManager/SrcSpan.hpp"
 
@@ -16,9 +22,9 @@ class TypeCtx {
 public:
   TypeCtx();
 
-  // factory methods
+  // factory methods; safe to call concurrently from multiple threads
   static TypeRef getBuiltin(BuiltinTy::Kind, SrcSpan Span);
-  static TypeRef getAdt(const std::string &Id, AdtDecl *D, SrcSpan Span);
+  static TypeRef getAdt(Identifier Id, AdtDecl *D, SrcSpan Span);
   static TypeRef getTuple(const std::vector<TypeRef> &Elements, SrcSpan Span);
   static TypeRef getFun(const std::vector<TypeRef> &Params,
                         const TypeRef &Return, SrcSpan Span);
@@ -26,11 +32,12 @@ public:
   static TypeRef getRef(const TypeRef &Pointee, SrcSpan Span);
   static TypeRef getVar(uint64_t N, VarTy::Domain Domain, SrcSpan Span);
   static TypeRef getVar(VarTy::Domain Domain, SrcSpan Span);
-  static TypeRef getGeneric(const std::string &Id, TypeArgDecl *D,
+  static TypeRef getGeneric(Identifier Id, TypeArgDecl *D,
                             SrcSpan Span);
   static TypeRef getApplied(TypeRef Base, std::vector<TypeRef> Args,
                             SrcSpan Span);
-  static TypeRef getArray(const TypeRef &ContainedTy, SrcSpan Span);
+  static TypeRef getArray(const TypeRef &ContainedTy, SrcSpan Span,
+                          std::optional<uint64_t> Length = std::nullopt);
   static TypeRef getErr(SrcSpan Span);
 
   static std::deque<std::unique_ptr<Type>> &getAll();
@@ -47,31 +54,33 @@ private:
   static TypeCtx &inst();
 
   BuiltinTy *builtin(BuiltinTy::Kind);
-  AdtTy *adt(const std::string &Id, AdtDecl *D = nullptr);
+  AdtTy *adt(Identifier Id, AdtDecl *D = nullptr);
   TupleTy *tuple(const std::vector<TypeRef> &Elements);
   FunTy *fun(const std::vector<TypeRef> &Params, const TypeRef &Ret);
   PtrTy *ptr(const TypeRef &Pointee);
   RefTy *ref(const TypeRef &Pointee);
   VarTy *var(uint64_t N, VarTy::Domain Domain);
   VarTy *var(VarTy::Domain Domain);
-  GenericTy *generic(const std::string &Id, TypeArgDecl *D);
+  GenericTy *generic(Identifier Id, TypeArgDecl *D);
   AppliedTy *applied(TypeRef Base, std::vector<TypeRef> Args);
-  ArrayTy *array(const TypeRef &ContainedTy);
+  ArrayTy *array(const TypeRef &ContainedTy, std::optional<uint64_t> Length);
   ErrTy *err();
 
   std::deque<std::unique_ptr<Type>> Arena;
+  std::mutex Mutex; // guards the arena and the interning maps below
 
   // maps
   std::unordered_map<BuiltinTy::Kind, BuiltinTy *> Builtins;
-  std::unordered_map<std::string, AdtTy *> Adts;
+  llvm::DenseMap<Identifier, AdtTy *> Adts;
   std::unordered_map<TupleKey, TupleTy *, TupleKeyHash> Tuples;
   std::unordered_map<FunKey, FunTy *, FunKeyHash> Funs;
   std::unordered_map<AppliedKey, AppliedTy *, AppliedKeyHash> Applieds;
   std::unordered_map<const Type *, PtrTy *> Ptrs;
   std::unordered_map<const Type *, RefTy *> Refs;
   std::unordered_map<const Type *, ArrayTy *> Arrays;
+  std::map<std::pair<const Type *, uint64_t>, ArrayTy *> FixedArrays;
   std::vector<VarTy *> Vars;
-  std::vector<GenericTy *> Generics;
+  llvm::DenseMap<const TypeArgDecl *, GenericTy *> Generics;
   ErrTy *Err;
 };
 
@@ -1,13 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <llvm/Support/Casting.h>
 
+#include "AST/Identifier.hpp"
 #include "SrcManager/SrcSpan.hpp"
 
 namespace phi {
@@ -128,23 +131,28 @@ private:
 
 class AdtTy final : public Type {
 public:
-  explicit AdtTy(std::string Id, class AdtDecl *D = nullptr)
-      : Type(TypeKind::Adt), Id(std::move(Id)), Decl(D) {}
+  explicit AdtTy(Identifier Id, class AdtDecl *D = nullptr)
+      : Type(TypeKind::Adt), Id(Id), Decl(D) {}
 
-  [[nodiscard]] const std::string &getId() const { return Id; }
-  [[nodiscard]] const AdtDecl *getDecl() const { return Decl; };
+  [[nodiscard]] const std::string &getId() const { return Id.str(); }
+  [[nodiscard]] Identifier getIdentifier() const { return Id; }
+  [[nodiscard]] const AdtDecl *getDecl() const {
+    return Decl.load(std::memory_order_relaxed);
+  };
   [[nodiscard]] std::string toString() const override;
 
+  /// ADT types are interned by name, so bodies resolved on different threads
+  /// may bind the same instance; they all store the same declaration.
   void setDecl(AdtDecl *D) const {
     assert(D != nullptr);
-    Decl = D;
+    Decl.store(D, std::memory_order_relaxed);
   }
 
   static bool classof(const Type *T) { return T->getKind() == TypeKind::Adt; }
 
 private:
-  const std::string Id;
-  mutable const AdtDecl *Decl;
+  const Identifier Id;
+  mutable std::atomic<const AdtDecl *> Decl;
 };
 
 class AppliedTy final : public Type {
@@ -170,7 +178,7 @@ public:
   explicit TupleTy(std::vector<TypeRef> E)
       : Type(TypeKind::Tuple), ElementTys(std::move(E)) {}
 
-  [[nodiscard]] auto getElementTys() const { return ElementTys; }
+  [[nodiscard]] const auto &getElementTys() const { return ElementTys; }
   [[nodiscard]] std::string toString() const override;
 
   static bool classof(const Type *T) { return T->getKind() == TypeKind::Tuple; }
@@ -186,7 +194,7 @@ public:
         ParamTys(std::move(Params)) {}
 
   [[nodiscard]] auto getReturnTy() const { return ReturnTy; }
-  [[nodiscard]] auto getParamTys() const { return ParamTys; }
+  [[nodiscard]] const auto &getParamTys() const { return ParamTys; }
   [[nodiscard]] std::string toString() const override;
 
   static bool classof(const Type *T) { return T->getKind() == TypeKind::Fun; }
@@ -252,10 +260,11 @@ private:
 
 class GenericTy final : public Type {
 public:
-  explicit GenericTy(std::string Id, class TypeArgDecl *D = nullptr)
-      : Type(TypeKind::Generic), Id(std::move(Id)), Decl(D) {}
+  explicit GenericTy(Identifier Id, class TypeArgDecl *D = nullptr)
+      : Type(TypeKind::Generic), Id(Id), Decl(D) {}
 
-  [[nodiscard]] const std::string &getId() const { return Id; }
+  [[nodiscard]] const std::string &getId() const { return Id.str(); }
+  [[nodiscard]] Identifier getIdentifier() const { return Id; }
   [[nodiscard]] const TypeArgDecl *getDecl() const { return Decl; };
   [[nodiscard]] std::string toString() const override;
 
@@ -270,7 +279,7 @@ public:
   }
 
 private:
-  const std::string Id;
+  const Identifier Id;
   mutable const TypeArgDecl *Decl;
 };
 
@@ -283,18 +292,24 @@ public:
   static bool classof(const Type *T) { return T->getKind() == TypeKind::Err; }
 };
 
+/// `[T]` is a slice of unknown length; `[T; N]` is a fixed-size array stored
+/// inline, which coerces to a slice
 class ArrayTy final : public Type {
 public:
-  explicit ArrayTy(TypeRef ContainedTy)
-      : Type(TypeKind::Array), ContainedTy(ContainedTy) {}
+  explicit ArrayTy(TypeRef ContainedTy,
+                   std::optional<uint64_t> Length = std::nullopt)
+      : Type(TypeKind::Array), ContainedTy(ContainedTy), Length(Length) {}
 
   [[nodiscard]] auto getContainedTy() const { return ContainedTy; }
+  [[nodiscard]] std::optional<uint64_t> getLength() const { return Length; }
+  [[nodiscard]] bool isFixed() const { return Length.has_value(); }
   [[nodiscard]] std::string toString() const override;
 
   static bool classof(const Type *T) { return T->getKind() == TypeKind::Array; }
 
 private:
   TypeRef ContainedTy;
+  std::optional<uint64_t> Length;
 };
 
 struct TupleKey {
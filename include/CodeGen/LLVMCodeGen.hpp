@@ -1,12 +1,19 @@
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
@@ -14,7 +21,12 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
+#include <llvm/Support/MemoryBufferRef.h>
+#include <llvm/Support/raw_ostream.h>
 
+#include "AST/ASTVisitor.hpp"
+#include "AST/Identifier.hpp"
+#include "AST/Instantiation.hpp"
 #include "AST/Nodes/Decl.hpp"
 #include "AST/Nodes/Expr.hpp"
 #include "AST/Nodes/Stmt.hpp"
@@ -23,38 +35,6 @@
 
 namespace phi {
 
-//===----------------------------------------------------------------------===//
-// TypeInstantiation - Represents a specific instantiation of a generic type
-//===----------------------------------------------------------------------===//
-
-struct TypeInstantiation {
-  const NamedDecl *GenericDecl;
-  std::vector<TypeRef> TypeArgs;
-
-  bool operator==(const TypeInstantiation &Other) const {
-    if (GenericDecl != Other.GenericDecl)
-      return false;
-    if (TypeArgs.size() != Other.TypeArgs.size())
-      return false;
-    for (size_t I = 0; I < TypeArgs.size(); ++I) {
-      if (TypeArgs[I].getPtr() != Other.TypeArgs[I].getPtr())
-        return false;
-    }
-    return true;
-  }
-};
-
-struct TypeInstantiationHash {
-  std::size_t operator()(const TypeInstantiation &TI) const noexcept {
-    std::size_t H = std::hash<const void *>()(TI.GenericDecl);
-    for (const auto &Arg : TI.TypeArgs) {
-      H ^= std::hash<const void *>()(Arg.getPtr()) + 0x9e3779b9 + (H << 6) +
-           (H >> 2);
-    }
-    return H;
-  }
-};
-
 //===----------------------------------------------------------------------===//
 // LLVMCodeGen - LLVM IR code generation with monomorphization
 //===----------------------------------------------------------------------===//
@@ -75,7 +55,14 @@ public:
   void outputIR(const std::string &Filename);
 
   /// Get the LLVM module (for testing/inspection)
-  llvm::Module &getModule() { return Module; }
+  llvm::Module &getModule() { return *Module; }
+
+  /// Lists every monomorphized instance and, for ADTs, the methods that were
+  /// generated for it
+  void printMonomorphizationReport(llvm::raw_ostream &OS) const;
+
+  /// Lists the size, alignment and padding of every struct and enum laid out
+  void printLayoutReport(llvm::raw_ostream &OS) const;
 
 private:
   //===--------------------------------------------------------------------===//
@@ -86,8 +73,9 @@ private:
   std::string SourcePath;
 
   llvm::LLVMContext Context;
-  llvm::IRBuilder<> Builder;
-  llvm::Module Module;
+  llvm::IRBuilder<llvm::ConstantFolder, llvm::IRBuilderCallbackInserter>
+      Builder;
+  std::unique_ptr<llvm::Module> Module;
 
   llvm::Function *CurrentFunction = nullptr;
   uint64_t TmpVarCounter = 0;
@@ -100,20 +88,40 @@ private:
   std::unordered_map<const Type *, llvm::Type *> TypeCache;
 
   /// Cache: Struct/Enum name -> LLVM StructType*
-  std::unordered_map<std::string, llvm::StructType *> StructTypes;
+  llvm::StringMap<llvm::StructType *> StructTypes;
 
-  /// Cache: Declaration -> LLVM Value (alloca for locals)
+  /// Cache: Declaration -> LLVM Value (alloca for locals, the global of a
+  /// constant table that is never written, or the pointer argument of an
+  /// aggregate passed through memory)
   std::unordered_map<const Decl *, llvm::Value *> NamedValues;
 
+  /// Cache: constant aggregate -> the read-only global holding it
+  llvm::DenseMap<llvm::Constant *, llvm::GlobalVariable *> ConstantGlobals;
+
+  /// Locals of the current body that are assigned to, whose address a
+  /// method call takes, or, for references, that are used for anything but
+  /// reading a field
+  std::unordered_set<const Decl *> WrittenLocals;
+
   /// Cache: FunDecl* -> LLVM Function*
   std::unordered_map<const FunDecl *, llvm::Function *> Functions;
 
   /// Cache: MethodDecl* -> LLVM Function* (methods compiled as functions)
   std::unordered_map<const MethodDecl *, llvm::Function *> Methods;
 
+  /// How a function passes the aggregates too large to travel as values
+  struct FunctionABI {
+    /// Returned through a leading `sret` pointer, or null
+    llvm::Type *SRetTy = nullptr;
+    /// Per source parameter: the aggregate passed behind a pointer, or null
+    std::vector<llvm::Type *> IndirectParams;
+  };
+
+  /// Cache: LLVM Function* -> its lowered signature
+  llvm::DenseMap<const llvm::Function *, FunctionABI> FunctionABIs;
+
   /// Cache: Struct name -> (field name -> field index)
-  std::unordered_map<std::string, std::unordered_map<std::string, unsigned>>
-      FieldIndices;
+  llvm::StringMap<llvm::DenseMap<Identifier, unsigned>> FieldIndices;
 
   /// Cache: Enum name -> (variant name -> discriminant value)
   std::unordered_map<std::string, std::unordered_map<std::string, unsigned>>
@@ -123,16 +131,70 @@ private:
   std::unordered_map<std::string, std::unordered_map<std::string, llvm::Type *>>
       VariantPayloadTypes;
 
+  /// Invalid values of a field inside some type, free to encode an enclosing
+  /// enum's discriminant: null for a pointer, 2-255 for a bool's byte, the
+  /// unused values of a nested enum's tag
+  struct Niche {
+    std::vector<unsigned> Path; ///< GEP indices from the type to the field
+    llvm::Type *Ty;             ///< How the field is loaded and stored
+    uint64_t Start;             ///< First invalid value
+    uint64_t Count;             ///< Number of invalid values from Start
+  };
+
+  /// Where an enum keeps its discriminant and its payload
+  struct EnumLayout {
+    /// Tag at field 0, or null when the enum has no tag of its own
+    llvm::IntegerType *TagTy = nullptr;
+    /// Field holding the payload
+    unsigned PayloadField = 1;
+    /// Untagged enums: the one variant with a payload, which is stored as-is
+    unsigned DataDiscriminant = 0;
+    /// Untagged enums: the niche holding the other variants, if there are any
+    std::optional<Niche> DiscNiche;
+    /// Untagged enums: discriminant -> niche value
+    std::unordered_map<unsigned, uint64_t> NicheValues;
+    /// Invalid values left over for an enclosing enum
+    std::optional<Niche> Spare;
+  };
+
+  /// Cache: Enum name -> layout
+  std::unordered_map<std::string, EnumLayout> EnumLayouts;
+
+  /// Cache: ADT name -> alignment beyond what its members give it, from
+  /// `#[align(N)]` or an over-aligned enum payload
+  llvm::StringMap<uint64_t> RequestedAligns;
+
+  /// Whether any struct was laid out `#[packed]`
+  bool HasPackedStructs = false;
+
+  /// One laid-out struct or enum, for --layout-report
+  struct LayoutReportEntry {
+    std::string Name;
+    uint64_t Size;
+    uint64_t Align;
+    uint64_t Padding;
+    /// Struct fields in memory order, if that differs from declaration order
+    std::vector<std::string> Reordered;
+  };
+
+  /// Every struct and enum in the order it was laid out
+  std::vector<LayoutReportEntry> LayoutReport;
+
   //===--------------------------------------------------------------------===//
   // Monomorphization Data Structures
   //===--------------------------------------------------------------------===//
 
-  /// Set of instantiations waiting to be processed
-  std::unordered_set<TypeInstantiation, TypeInstantiationHash> Instantiations;
+  /// Instantiations waiting to be processed, in order of first discovery, so
+  /// the emitted IR does not depend on pointer hashes
+  std::deque<TypeInstantiation> Worklist;
+
+  /// Mangled names of every instantiation ever queued. Type arguments that
+  /// lower alike share a name, so the name, not the arguments, is what
+  /// identifies an instance.
+  llvm::StringSet<> QueuedInstances;
 
-  /// Map: TypeInstantiation -> name of monomorphized declaration
-  std::unordered_map<TypeInstantiation, std::string, TypeInstantiationHash>
-      MonomorphizedNames;
+  /// Mangled names of the functions and ADTs already monomorphized
+  llvm::StringSet<> MonomorphizedInstances;
 
   /// Substitution map: TypeArgDecl* -> concrete TypeRef
   using SubstitutionMap = std::unordered_map<const TypeArgDecl *, TypeRef>;
@@ -155,6 +217,36 @@ private:
   std::vector<MonomorphizedMethod> MonomorphizedMethodQueue;
   std::unordered_set<std::string> GeneratedMonomorphizedBodies;
 
+  /// Every method instance declared so far, in order. Methods are also
+  /// instantiated while bodies are lowered; a worker hands the ones it
+  /// declared back, for the main module to declare too.
+  std::vector<TypeInstantiation> DeclaredMethods;
+
+  /// A monomorphized body handed to a worker, which looks up its own
+  /// declaration of the function by name
+  struct BodyJob {
+    const NamedDecl *Decl; // FunDecl or MethodDecl
+    std::vector<TypeRef> Args;
+    std::string Name;
+  };
+
+  /// Set on the CodeGen a worker lowers its bodies with. What it declares
+  /// is declared by the main module too, and must not be counted twice.
+  bool IsWorker = false;
+
+  /// A monomorphized function or ADT, with the methods instantiated for it.
+  /// Holds no AST pointers, so it can be printed after the AST is gone.
+  struct MonoReportEntry {
+    std::string Name;
+    bool IsAdt;
+    size_t NumMethods; // Methods the generic ADT declares
+    std::vector<std::string> Methods;
+  };
+
+  /// Instances in the order they were monomorphized
+  std::vector<MonoReportEntry> MonoReport;
+  llvm::StringMap<size_t> MonoReportIndex;
+
   //===--------------------------------------------------------------------===//
   // Loop Context (for break/continue)
   //===--------------------------------------------------------------------===//
@@ -162,24 +254,27 @@ private:
   struct LoopContext {
     llvm::BasicBlock *CondBB;  // For continue
     llvm::BasicBlock *AfterBB; // For break
+    size_t DeferDepth;         // Blocks open outside the loop body
 
-    LoopContext(llvm::BasicBlock *Cond, llvm::BasicBlock *After)
-        : CondBB(Cond), AfterBB(After) {}
+    LoopContext(llvm::BasicBlock *Cond, llvm::BasicBlock *After,
+                size_t DeferDepth)
+        : CondBB(Cond), AfterBB(After), DeferDepth(DeferDepth) {}
   };
   std::vector<LoopContext> LoopStack;
 
+  /// Deferred expressions of each open block, innermost last
+  std::vector<std::vector<Expr *>> DeferStack;
+
+  /// Emits the deferred expressions of every block above \p Depth,
+  /// innermost first
+  void emitDeferred(size_t Depth);
+
   //===--------------------------------------------------------------------===//
   // Phase 1: Discovery - Find generic instantiations
   //===--------------------------------------------------------------------===//
 
+  /// Seeds the worklist with the instantiations recorded by type finalization
   void discoverInstantiations();
-  void discoverInModule(ModuleDecl *M);
-  void discoverInFunction(FunDecl *F);
-  void discoverInMethod(MethodDecl *M);
-  void discoverInBlock(Block *B);
-  void discoverInStmt(Stmt *S);
-  void discoverInExpr(Expr *E);
-  void discoverInType(TypeRef T);
 
   /// Record a new instantiation to be processed
   void recordInstantiation(const NamedDecl *Decl,
@@ -197,8 +292,15 @@ private:
                         const std::vector<TypeRef> &TypeArgs);
   void monomorphizeFunction(const FunDecl *F,
                             const std::vector<TypeRef> &TypeArgs);
-  void monomorphizeMethod(const MethodDecl *M,
-                          const std::vector<TypeRef> &TypeArgs);
+  llvm::Function *monomorphizeMethod(const MethodDecl *M,
+                                     const std::vector<TypeRef> &TypeArgs);
+
+  /// Returns the instance of \p M for its parent applied to \p TypeArgs,
+  /// instantiating the parent and the method on first use
+  llvm::Function *getOrMonomorphizeMethod(const MethodDecl *M,
+                                          const std::vector<TypeRef> &TypeArgs);
+
+  void noteMonomorphized(const ItemDecl *Generic, const std::string &MonoName);
 
   /// Substitute type parameters with concrete types
   TypeRef substituteType(TypeRef T, const SubstitutionMap &Subs);
@@ -211,21 +313,13 @@ private:
   SubstitutionMap buildSubstitutionMap(const AdtDecl *Decl,
                                        const std::vector<TypeRef> &TypeArgs);
 
-  /// Generate unique name for monomorphized declaration
+  /// Generate the name of an instance. Type arguments that lower to the same
+  /// layout, such as any two pointers, give the same name and so one instance.
   std::string generateMonomorphizedName(const std::string &BaseName,
                                         const std::vector<TypeRef> &TypeArgs);
 
-  //===--------------------------------------------------------------------===//
-  // Phase 3: Desugaring - Transform method calls
-  //===--------------------------------------------------------------------===//
-
-  void desugar();
-  void desugarModule(ModuleDecl *M);
-  void desugarFunction(FunDecl *F);
-  void desugarMethod(MethodDecl *M);
-  void desugarBlock(Block *B);
-  void desugarStmt(Stmt *S);
-  void desugarExpr(Expr *E);
+  /// Mangled name of the declaration \p TI produces
+  std::string getMonomorphizedName(const TypeInstantiation &TI);
 
   //===--------------------------------------------------------------------===//
   // Phase 4: LLVM IR Generation - Type Conversion
@@ -239,20 +333,47 @@ private:
 
   /// Get or create LLVM struct type for a struct declaration
   llvm::StructType *getOrCreateStructType(const StructDecl *S);
+
+  /// Lay out struct \p Name, an instance of \p S, and register its field
+  /// indices. Fields are ordered by decreasing alignment unless \p S is
+  /// `#[repr(C)]` or `#[packed]`.
   llvm::StructType *
-  getOrCreateStructType(const std::string &Name,
-                        const std::vector<TypeRef> &FieldTypes);
+  layOutStruct(const std::string &Name, const StructDecl *S,
+               const std::vector<std::pair<Identifier, llvm::Type *>> &Fields);
 
   /// Get or create LLVM struct type for an enum declaration
-  /// Enum layout: { i32 discriminant, [largest_payload_size x i8] }
   llvm::StructType *getOrCreateEnumType(const EnumDecl *E);
-  llvm::StructType *
-  getOrCreateEnumType(const std::string &Name,
-                      const std::vector<VariantDecl *> &Variants);
+
+  /// Lay out enum \p Name from its variants and their payload types (null
+  /// for unit variants). See LLVMCodeGenLayout.cpp for the layouts chosen.
+  llvm::StructType *layOutEnum(
+      const std::string &Name, const EnumDecl *E,
+      const std::vector<std::pair<std::string, llvm::Type *>> &Variants);
+
+  /// Pad \p Members, which end at \p Offset, so that a member of type \p Ty
+  /// appended next sits at a multiple of \p Align
+  void padToMemberAlign(std::vector<llvm::Type *> &Members, uint64_t &Offset,
+                        llvm::Type *Ty, uint64_t Align);
+
+  /// Pad \p Members of ADT \p Name, \p Size bytes so far, out to the
+  /// alignment \p D requests, at least \p MinAlign
+  void padToRequestedAlign(const std::string &Name, const AdtDecl *D,
+                           std::vector<llvm::Type *> &Members, uint64_t Size,
+                           bool Packed, uint64_t MinAlign = 1);
+
+  /// Find a niche in a value of type \p T
+  std::optional<Niche> findNiche(llvm::Type *T);
+
+  /// Address of the niche an untagged enum keeps its discriminant in
+  llvm::Value *getNichePtr(llvm::StructType *EnumTy, llvm::Value *Ptr,
+                           const Niche &N);
 
   /// Get the size of a type in bytes
   uint64_t getTypeSize(llvm::Type *T);
 
+  /// Get the ABI alignment of a type in bytes
+  uint64_t getTypeAlign(llvm::Type *T);
+
   //===--------------------------------------------------------------------===//
   // Phase 4: LLVM IR Generation - Declarations
   //===--------------------------------------------------------------------===//
@@ -274,6 +395,30 @@ private:
   /// Generate monomorphized function bodies
   void generateMonomorphizedBodies();
 
+  /// Lowers the body of one instance of \p Decl into \p Fn
+  void generateMonomorphizedBody(const NamedDecl *Decl,
+                                 const std::vector<TypeRef> &Args,
+                                 llvm::Function *Fn);
+
+  /// Every function of the module, as external declarations, in bitcode
+  llvm::SmallVector<char, 0> writeDeclarations() const;
+
+  /// The CodeGen a worker lowers bodies with, in a context of its own. Its
+  /// module is parsed from \p Decls, written by writeDeclarations, and the
+  /// types and layouts of \p Parent are carried over by name.
+  CodeGen(const CodeGen &Parent, llvm::MemoryBufferRef Decls);
+
+  /// Lowers \p Jobs against the declarations \p Decls and returns the
+  /// module as bitcode. Method instances first declared on the way are
+  /// stored in \p Found.
+  llvm::SmallVector<char, 0>
+  generateBodiesInWorker(llvm::MemoryBufferRef Decls,
+                         llvm::ArrayRef<BodyJob> Jobs,
+                         std::vector<TypeInstantiation> &Found) const;
+
+  /// Links this module and the modules of every worker into a new one
+  void linkWorkerModules(llvm::ArrayRef<llvm::SmallVector<char, 0>> Bitcode);
+
   /// Create function declaration
   llvm::Function *codegenFunctionDecl(FunDecl *F);
   llvm::Function *codegenMethodDecl(MethodDecl *M,
@@ -290,14 +435,17 @@ private:
   void codegenBlock(Block *B);
   void codegenStmt(Stmt *S);
 
-  void codegenDeclStmt(DeclStmt *S);
-  void codegenReturnStmt(ReturnStmt *S);
-  void codegenIfStmt(IfStmt *S);
-  void codegenWhileStmt(WhileStmt *S);
-  void codegenForStmt(ForStmt *S);
-  void codegenBreakStmt(BreakStmt *S);
-  void codegenContinueStmt(ContinueStmt *S);
-  void codegenExprStmt(ExprStmt *S);
+  void codegen(DeclStmt *S);
+  void codegen(ReturnStmt *S);
+  void codegen(DeferStmt *S);
+  void codegen(IfStmt *S);
+  void codegen(WhileStmt *S);
+  void codegen(ForStmt *S);
+  void codegen(BreakStmt *S);
+  void codegen(ContinueStmt *S);
+  void codegen(ExprStmt *S);
+  void codegen(ImportStmt *S);
+  void codegen(UseStmt *S);
 
   //===--------------------------------------------------------------------===//
   // Phase 4: LLVM IR Generation - Expressions
@@ -306,64 +454,153 @@ private:
   llvm::Value *codegenExpr(Expr *E);
 
   // Literals
-  llvm::Value *codegenIntLiteral(IntLiteral *E);
-  llvm::Value *codegenFloatLiteral(FloatLiteral *E);
-  llvm::Value *codegenBoolLiteral(BoolLiteral *E);
-  llvm::Value *codegenStrLiteral(StrLiteral *E);
-  llvm::Value *codegenCharLiteral(CharLiteral *E);
-  llvm::Value *codegenTupleLiteral(TupleLiteral *E);
-  llvm::Value *codegenArrayLiteral(ArrayLiteral *E);
+  llvm::Value *codegen(IntLiteral *E);
+  llvm::Value *codegen(FloatLiteral *E);
+  llvm::Value *codegen(BoolLiteral *E);
+  llvm::Value *codegen(StrLiteral *E);
+  llvm::Value *codegen(CharLiteral *E);
+  llvm::Value *codegen(TupleLiteral *E);
+  llvm::Value *codegen(ArrayLiteral *E);
+  llvm::Value *codegen(RangeLiteral *E);
 
   // References and Calls
-  llvm::Value *codegenDeclRef(DeclRefExpr *E);
-  llvm::Value *codegenFunCall(FunCallExpr *E);
-  llvm::Value *codegenMethodCall(MethodCallExpr *E);
+  llvm::Value *codegen(DeclRefExpr *E);
+  llvm::Value *codegen(FunCallExpr *E);
+  llvm::Value *codegen(MethodCallExpr *E);
 
   // Operators
-  llvm::Value *codegenBinaryOp(BinaryOp *E);
-  llvm::Value *codegenUnaryOp(UnaryOp *E);
+  llvm::Value *codegen(BinaryOp *E);
+  llvm::Value *codegen(UnaryOp *E);
 
   // Struct/Enum
-  llvm::Value *codegenAdtInit(AdtInit *E);
+  llvm::Value *codegen(AdtInit *E);
+  llvm::Value *codegen(MemberInit *E);
   llvm::Value *codegenStructInit(AdtInit *E, const StructDecl *S);
   llvm::Value *codegenEnumInit(AdtInit *E, const EnumDecl *En);
-  llvm::Value *codegenFieldAccess(FieldAccessExpr *E);
-  llvm::Value *codegenTupleIndex(TupleIndex *E);
-  llvm::Value *codegenArrayIndex(ArrayIndex *E);
+  llvm::Value *codegen(FieldAccessExpr *E);
+  llvm::Value *codegen(TupleIndex *E);
+  llvm::Value *codegen(ArrayIndex *E);
+  llvm::Value *getArrayElementPtr(ArrayIndex *E);
 
   // Casts
-  llvm::Value *codegenCastExpr(CastExpr *E);
+  llvm::Value *codegen(CastExpr *E);
   llvm::Value *codegenCastToString(llvm::Value *Val, BuiltinTy::Kind FromKind);
 
   // Match
-  llvm::Value *codegenMatchExpr(MatchExpr *E);
-  llvm::Value *codegenIntrinsicCall(IntrinsicCall *E);
+  llvm::Value *codegen(MatchExpr *E);
+  llvm::Value *codegen(IntrinsicCall *E);
+
+  //===--------------------------------------------------------------------===//
+  // Phase 4: Constant Aggregates
+  //===--------------------------------------------------------------------===//
+
+  /// Records in WrittenLocals every local that \p Body may write to
+  void collectWrittenLocals(Block &Body);
+
+  /// True if \p V is a constant aggregate worth keeping in a global rather
+  /// than rebuilding it with stores
+  bool isConstantTable(llvm::Value *V);
+
+  /// Returns the `private unnamed_addr constant` global holding \p C
+  llvm::GlobalVariable *getConstantGlobal(llvm::Constant *C);
+
+  //===--------------------------------------------------------------------===//
+  // Phase 4: Calling Convention
+  //===--------------------------------------------------------------------===//
+
+  /// True if a value of type \p T is passed and returned through memory
+  bool isPassedIndirectly(llvm::Type *T);
+
+  /// Create function \p Name taking \p Params and returning \p RetTy, with
+  /// large aggregates lowered to pointers. Types are read under CurrentSubs.
+  llvm::Function *
+  createLoweredFunction(const std::string &Name,
+                        llvm::ArrayRef<std::unique_ptr<ParamDecl>> Params,
+                        TypeRef RetTy, bool Exported);
+
+  /// Bind the parameters of the body being generated to their storage
+  void bindParams(llvm::ArrayRef<std::unique_ptr<ParamDecl>> Params,
+                  llvm::Function *Fn);
+
+  /// Return \p V from the current function, through its sret pointer if it
+  /// has one
+  void emitReturn(llvm::Value *V);
+
+  /// Evaluate \p E as argument \p Idx of \p Fn, as that parameter is passed
+  llvm::Value *codegenArg(Expr *E, llvm::Function *Fn, unsigned Idx);
+
+  /// Call \p Fn with \p Args, lowered by codegenArg, and yield its result
+  llvm::Value *emitCall(llvm::Function *Fn, std::vector<llvm::Value *> Args);
+
+  //===--------------------------------------------------------------------===//
+  // Phase 4: Linkage and Attributes
+  //===--------------------------------------------------------------------===//
+
+  /// Whether code outside the module may call \p F or \p M
+  bool isExported(const FunDecl *F);
+  bool isExported(const MethodDecl *M);
+
+  /// Give \p Fn its linkage, calling convention and the attributes its
+  /// signature implies
+  void addFunctionAttributes(llvm::Function *Fn,
+                             llvm::ArrayRef<std::unique_ptr<ParamDecl>> Params,
+                             bool Exported);
 
   //===--------------------------------------------------------------------===//
   // Phase 4: Pattern Matching Codegen
   //===--------------------------------------------------------------------===//
 
-  /// Generate code for a match arm, returns the result value
-  llvm::Value *codegenMatchArm(const MatchExpr::Arm &Arm,
-                               llvm::Value *Scrutinee,
-                               llvm::BasicBlock *NextArmBB,
-                               llvm::BasicBlock *MergeBB,
-                               llvm::PHINode *ResultPHI);
+  /// Generate an arm's body and feed its trailing expression to \p ResultPHI
+  void codegenMatchBody(const MatchExpr::Arm &Arm, llvm::BasicBlock *MergeBB,
+                        llvm::PHINode *ResultPHI);
+
+  /// Compare the tested scrutinee value against one pattern constant
+  llvm::Value *codegenMatchTest(llvm::Value *Tested, llvm::Constant *Key);
+
+  /// Dispatch a string scrutinee to the block of the literal it equals
+  void codegenStringSwitch(
+      llvm::Value *Str,
+      const std::vector<std::pair<std::string, llvm::BasicBlock *>> &Cases,
+      llvm::BasicBlock *DefaultBB);
+
+  /// Dispatch an untagged enum on its niche to the block of each variant
+  void codegenNicheSwitch(
+      llvm::Value *Scrutinee, llvm::StructType *EnumTy,
+      const std::vector<std::pair<unsigned, llvm::BasicBlock *>> &Cases,
+      llvm::BasicBlock *DefaultBB);
+
+  /// Bind a variant pattern's variable to the scrutinee's payload
+  void bindVariantPayload(const PatternAtomics::Variant &Var,
+                          llvm::Value *Scrutinee, llvm::StructType *EnumTy);
+
+  //===--------------------------------------------------------------------===//
+  // Layout Alignment
+  //===--------------------------------------------------------------------===//
+
+  /// Give an alloca, load or store the alignment its layout attributes call
+  /// for; called by Builder on every instruction it inserts
+  void alignMemoryAccess(llvm::Instruction *I);
 
-  /// Generate pattern matching code, branches to SuccessBB or FailBB
-  void matchPattern(const Pattern &Pat, llvm::Value *Scrutinee,
-                    llvm::BasicBlock *SuccessBB, llvm::BasicBlock *FailBB);
+  /// Whether a value of type \p T contains an `#[align(N)]` ADT
+  bool hasRequestedAlign(llvm::Type *T);
 
-  /// Match wildcard pattern (always succeeds)
-  void matchWildcard(llvm::BasicBlock *SuccessBB);
+  /// Whether \p Ptr addresses a field inside a packed struct
+  bool isPackedMember(llvm::Value *Ptr);
 
-  /// Match literal pattern
-  void matchLiteral(const PatternAtomics::Literal &Lit, llvm::Value *Scrutinee,
-                    llvm::BasicBlock *SuccessBB, llvm::BasicBlock *FailBB);
+  //===--------------------------------------------------------------------===//
+  // Phase 5: Identical Function Merging
+  //===--------------------------------------------------------------------===//
 
-  /// Match enum variant pattern
-  void matchVariant(const PatternAtomics::Variant &Var, llvm::Value *Scrutinee,
-                    llvm::BasicBlock *SuccessBB, llvm::BasicBlock *FailBB);
+  /// Folds functions that lowered to the same code, such as instances for
+  /// `i32` and `u32`, into one with LLVM's MergeFunctions pass
+  void mergeIdenticalFunctions();
+
+  //===--------------------------------------------------------------------===//
+  // Phase 5: Function Attribute Inference
+  //===--------------------------------------------------------------------===//
+
+  /// Runs LLVM's function attribute inference over the finished module
+  void inferFunctionAttributes();
 
   //===--------------------------------------------------------------------===//
   // Helpers
@@ -389,6 +626,14 @@ private:
   /// Store a value to a pointer
   void storeValue(llvm::Value *Val, llvm::Value *Ptr);
 
+  /// Convert \p V to \p DestTy where the type system allows it implicitly,
+  /// which is a fixed-size array flowing into a slice
+  llvm::Value *coerceValue(llvm::Value *V, llvm::Type *DestTy);
+
+  /// Like the above, but also converts nested arrays element by element,
+  /// which needs the destination's element type
+  llvm::Value *coerceValue(llvm::Value *V, TypeRef DestTy);
+
   //===--------------------------------------------------------------------===//
   // Built-in Functions
   //===--------------------------------------------------------------------===//
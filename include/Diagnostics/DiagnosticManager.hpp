@@ -79,6 +79,26 @@ public:
   void emitAll(const std::vector<Diagnostic> &Diags,
                std::ostream &Out = std::cerr) const;
 
+  /**
+   * @brief Redirects diagnostics emitted on the current thread into a buffer
+   *
+   * While a capture is alive, emit() on this thread appends to the buffer
+   * instead of rendering and counting. Passes running on worker threads use
+   * this to hand their diagnostics back, which the caller then replays with
+   * emitAll() in a deterministic order.
+   */
+  class ThreadCapture {
+  public:
+    explicit ThreadCapture(std::vector<Diagnostic> &Buffer);
+    ~ThreadCapture();
+
+    ThreadCapture(const ThreadCapture &) = delete;
+    ThreadCapture &operator=(const ThreadCapture &) = delete;
+
+  private:
+    std::vector<Diagnostic> *Previous; ///< Capture this one shadows, if any
+  };
+
   //===--------------------------------------------------------------------===//
   // Status & Statistics
   //===--------------------------------------------------------------------===//
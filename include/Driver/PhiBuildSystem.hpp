@@ -26,6 +26,15 @@ enum class BuildMode {
   Project,    // phi build
 };
 
+//===----------------------------------------------------------------------===//
+// Statistics Format
+//===----------------------------------------------------------------------===//
+
+enum class StatsFormat {
+  Text, // --stats
+  Json, // --stats=json
+};
+
 //===----------------------------------------------------------------------===//
 // Compiler Options
 //===----------------------------------------------------------------------===//
@@ -36,6 +45,10 @@ struct CompilerOptions {
   bool Verbose = false;
   bool DumpTokens = false;
   bool DumpAST = false;
+  bool CheckAll = false; // Type check items unreachable from main too
+  std::optional<StatsFormat> Stats;
+  bool MonoReport = false; // List monomorphized instances after codegen
+  bool LayoutReport = false; // List struct and enum layouts after codegen
 
   // Single file mode
   std::optional<fs::path> InputFile;
@@ -72,12 +85,16 @@ public:
 private:
   // Compilation helpers
   static bool compileFile(const fs::path &SourceFile,
-                          const fs::path &OutputFile, bool IsRelease,
-                          DiagnosticManager &Diags);
+                          const fs::path &OutputFile,
+                          const CompilerOptions &Opts, DiagnosticManager &Diags);
 
   static void compileUnit(CompilationUnit &Unit, DiagnosticManager &Diags);
   static void linkObjects(PhiProject &Project);
 
+  // Statistics helpers
+  static void enableStats(const CompilerOptions &Opts);
+  static void printStats(const CompilerOptions &Opts);
+
   // Project config helpers
   static std::optional<fs::path> findPhiToml(const fs::path &StartDir);
   static std::string getProjectName(const fs::path &PhiTomlPath);
@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "AST/Identifier.hpp"
 #include "Lexer/TokenKind.hpp"
 #include "SrcManager/SrcLocation.hpp"
 #include "SrcManager/SrcSpan.hpp"
@@ -18,6 +19,7 @@ namespace phi {
  * Immutable container holding token metadata including:
  * - Token type classification
  * - Original source text (lexeme)
+ * - Interned identifier, for identifier tokens
  * - Precise source location (start and end positions)
  */
 class Token {
@@ -27,12 +29,13 @@ public:
   //===--------------------------------------------------------------------===//
 
   Token(SrcSpan Span, const TokenKind Kind, std::string Lexeme)
-      : Span((std::move(Span))), Kind(Kind), Lexeme(std::move(Lexeme)) {}
+      : Span((std::move(Span))), Kind(Kind), Lexeme(std::move(Lexeme)),
+        Ident(internIfIdentifier()) {}
 
   Token(SrcLocation Start, SrcLocation End, const TokenKind::Kind Kind,
         std::string Lexeme)
       : Span(SrcSpan(std::move(Start), std::move(End))), Kind(Kind),
-        Lexeme(std::move(Lexeme)) {}
+        Lexeme(std::move(Lexeme)), Ident(internIfIdentifier()) {}
 
   //===--------------------------------------------------------------------===//
   // Getters
@@ -44,6 +47,7 @@ public:
   [[nodiscard]] TokenKind getKind() const { return Kind; }
   [[nodiscard]] std::string getName() const { return Kind.toString(); }
   [[nodiscard]] std::string getLexeme() const { return Lexeme; }
+  [[nodiscard]] Identifier getIdentifier() const { return Ident; }
 
   //===--------------------------------------------------------------------===//
   // Utility Methods
@@ -65,6 +69,12 @@ private:
   SrcSpan Span;       ///< Span of the Token
   TokenKind Kind;     ///< Token classification type
   std::string Lexeme; ///< Original source text content
+  Identifier Ident;   ///< Interned lexeme, empty unless an identifier
+
+  [[nodiscard]] Identifier internIfIdentifier() const {
+    return Kind.Value == TokenKind::Identifier ? Identifier(Lexeme)
+                                               : Identifier();
+  }
 };
 
 } // namespace phi
@@ -77,6 +77,7 @@ struct TokenKind {
     FatArrow,     ///< `=>` as in the match stmt
     Comma,        ///< `,` separator
     Semicolon,    ///< `;` statement terminator
+    Hash,         ///< `#` as in `#[repr(C)]`
 
     // OPERATORS
     Plus,    ///< `+` addition
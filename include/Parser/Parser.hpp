@@ -111,6 +111,7 @@ private:
   };
   std::optional<ModulePathInfo> parseModulePath();
   std::optional<Visibility> parseItemVisibility();
+  std::vector<Attribute> parseAttributes();
   std::optional<Mutability> parseMutability();
   std::optional<Visibility> parseAdtMemberVisibility();
 
@@ -210,7 +211,7 @@ private:
 
   struct TypedBinding {
     SrcSpan Span;
-    std::vector<std::string> Names;
+    std::vector<Identifier> Names;
     std::vector<std::optional<TypeRef>> Type;
     std::unique_ptr<Expr> Init;
   };
@@ -8,6 +8,7 @@
 #include <variant>
 #include <vector>
 
+#include "AST/ASTVisitor.hpp"
 #include "AST/Nodes/Decl.hpp"
 #include "AST/Nodes/Expr.hpp"
 #include "AST/Nodes/Stmt.hpp"
@@ -23,7 +24,7 @@ namespace phi {
 // NameResolver - Name resolution and symbol binding for Phi AST
 //===----------------------------------------------------------------------===//
 
-class NameResolver {
+class NameResolver : public ASTVisitor<NameResolver, bool, bool> {
 public:
   //===--------------------------------------------------------------------===//
   // Constructors & Destructors
@@ -32,12 +33,28 @@ public:
   NameResolver(std::vector<ModuleDecl *> Modules, DiagnosticManager *Diags)
       : Modules(std::move(Modules)), Diags(std::move(Diags)) {}
 
+  /// Creates a resolver whose scopes are layered over \p Enclosing
+  NameResolver(const SymbolTable &Enclosing, DiagnosticManager *Diags)
+      : SymbolTab(&Enclosing), Diags(Diags) {}
+
   //===--------------------------------------------------------------------===//
   // Main Entry Point
   //===--------------------------------------------------------------------===//
 
+  /**
+   * @brief Resolves every module in two phases
+   *
+   * Imports, item headers and uses are resolved serially, module by module,
+   * each into its own module scope. Those scopes are then frozen and every
+   * item body is resolved on a worker thread with a private scope stack
+   * layered over its module's scope. Diagnostics from the bodies are
+   * replayed in declaration order.
+   */
   std::vector<ModuleDecl *> resolve();
-  ModuleDecl *resolveSingleMod(ModuleDecl *Module);
+
+  /// Resolves the imports, item headers and uses of \p Module into this
+  /// resolver's scope
+  void resolveModuleScope(ModuleDecl &Module);
 
   //===--------------------------------------------------------------------===//
   // Type Visitor Method -> return bool (success/failure)
@@ -65,13 +82,14 @@ public:
   bool resolveHeader(AdtDecl &D);
   bool resolveHeader(FunDecl &D);
   bool resolveHeader(MethodDecl &D);
+  bool checkAttributes(ItemDecl &D);
   bool resolveBodies(ItemDecl &D);
 
   //===--------------------------------------------------------------------===//
   // Expression Visitor Methods -> return bool (success/failure)
   //===--------------------------------------------------------------------===//
 
-  bool visit(Expr &E);
+  using ASTVisitor::visit;
   bool visit(IntLiteral &E);
   bool visit(FloatLiteral &E);
   bool visit(StrLiteral &E);
@@ -108,7 +126,6 @@ public:
   // Statement Visitor Methods -> return bool (success/failure)
   //===--------------------------------------------------------------------===//
 
-  bool visit(Stmt &S);
   bool visit(ReturnStmt &S);
   bool visit(DeferStmt &S);
   bool visit(IfStmt &S);
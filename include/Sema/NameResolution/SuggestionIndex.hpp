@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <llvm/ADT/StringRef.h>
+
+#include "AST/Nodes/Decl.hpp"
+
+namespace phi {
+
+/**
+ * @brief Candidate names for "did you mean" suggestions
+ *
+ * Candidates are bucketed by length. A query only scores buckets whose
+ * length is within the distance bound, and each candidate is scored with a
+ * bit-parallel edit distance kernel that stops as soon as the bound can no
+ * longer be met. The bound shrinks to the best distance found so far, and
+ * buckets are visited nearest length first so that it shrinks early.
+ *
+ * Distances count insertions, deletions, substitutions and transpositions
+ * of adjacent characters (optimal string alignment). Ties go to the
+ * candidate that was added first.
+ */
+class SuggestionIndex {
+public:
+  struct Match {
+    llvm::StringRef Name;
+    Decl *D;
+    std::size_t Distance;
+  };
+
+  void add(llvm::StringRef Name, Decl *D);
+
+  /// Returns the candidate closest to \p Query, if any is within
+  /// \p MaxDistance edits of it
+  [[nodiscard]] std::optional<Match> findClosest(llvm::StringRef Query,
+                                                 std::size_t MaxDistance) const;
+
+  [[nodiscard]] bool empty() const { return Size == 0; }
+
+private:
+  struct Candidate {
+    std::string Name;
+    Decl *D;
+    uint32_t Order; ///< Insertion order, for tie-breaking
+  };
+
+  /// Name length -> candidates of that length
+  std::vector<std::vector<Candidate>> ByLength;
+  uint32_t Size = 0;
+};
+
+} // namespace phi
@@ -1,12 +1,22 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+
+#include "AST/Identifier.hpp"
 #include "AST/Nodes/Decl.hpp"
 #include "AST/Nodes/Expr.hpp"
+#include "Sema/NameResolution/SuggestionIndex.hpp"
 
 namespace phi {
 
@@ -17,14 +27,32 @@ namespace phi {
 /**
  * @brief Symbol table implementation for semantic analysis
  *
- * Manages nested scopes and declaration lookups during compilation. The symbol
- * table is implemented as a stack of scopes, where each scope is a mapping
- * from identifiers to their corresponding declarations. Provides RAII-based
- * scope management through the ScopeGuard helper class to ensure proper
- * scope entry and exit even in the presence of exceptions.
+ * Manages nested scopes and declaration lookups during compilation. Every
+ * visible declaration lives in one flat hash table keyed by its namespace and
+ * Identifier, so a lookup is a single probe regardless of nesting depth.
+ * Inserts are appended to an undo log; entering a scope only records the
+ * log's length, and exiting it unbinds everything appended since. Phi
+ * does not allow a name to shadow one from an enclosing scope, so an unbind
+ * never has an older binding to restore. Provides RAII-based scope management
+ * through the ScopeGuard helper class to ensure proper scope entry and exit
+ * even in the presence of exceptions.
+ *
+ * A table may be layered over an enclosing one, which it reads but never
+ * modifies. Several tables can share the same enclosing table concurrently as
+ * long as nothing inserts into it meanwhile.
  */
 class SymbolTable {
 public:
+  //===--------------------------------------------------------------------===//
+  // Constructors
+  //===--------------------------------------------------------------------===//
+
+  SymbolTable() = default;
+
+  /// Creates an empty table whose lookups fall back to \p Enclosing, which
+  /// must outlive it
+  explicit SymbolTable(const SymbolTable *Enclosing) : Parent(Enclosing) {}
+
   //===--------------------------------------------------------------------===//
   // ScopeGuard - RAII scope management helper
   //===--------------------------------------------------------------------===//
@@ -57,19 +85,6 @@ public:
     SymbolTable &SymbolTab; ///< Reference to the parent symbol table
   };
 
-  //===--------------------------------------------------------------------===//
-  // Scope Structure Definition
-  //===--------------------------------------------------------------------===//
-
-  struct Scope {
-    std::unordered_map<std::string, LocalDecl *> Vars;
-    std::unordered_map<std::string, FunDecl *> Funs;
-    std::unordered_map<std::string, MethodDecl *> Statics;
-    std::unordered_map<std::string, AdtDecl *> Adts;
-    std::unordered_map<std::string, MemberDecl *> Mems;
-    std::unordered_map<std::string, TypeArgDecl *> TypeArgs;
-  };
-
   //===--------------------------------------------------------------------===//
   // Declaration Insertion Methods
   //===--------------------------------------------------------------------===//
@@ -78,12 +93,18 @@ public:
   bool insert(LocalDecl *Var);
   bool insert(MemberDecl *Field);
   bool insert(TypeArgDecl *TypeArg);
-  bool insertAs(ItemDecl *Item, const std::string &Alias);
+  bool insertAs(ItemDecl *Item, Identifier Alias);
 
   bool insertAsImportable(ModuleDecl *Mod);
   bool insertAsImportable(ItemDecl *Item, ModuleDecl *ParentMod);
 
-  bool insertWithQual(ItemDecl *Item, const std::string &Quals);
+  /**
+   * @brief Makes the public items of \p Mod reachable as `Alias::Item`
+   *
+   * Only the alias is bound; qualified lookups go through the module's
+   * export table, so the cost does not depend on how many items it exports.
+   */
+  bool insertModuleAlias(ModuleDecl *Mod, Identifier Alias);
 
   //===--------------------------------------------------------------------===//
   // Symbol Lookup Methods
@@ -91,15 +112,15 @@ public:
 
   FunDecl *lookup(FunCallExpr &Fun);
   LocalDecl *lookup(DeclRefExpr &Var);
-  AdtDecl *lookup(const std::string &Id);
+  AdtDecl *lookup(Identifier Id);
 
   ItemDecl *lookup(ItemDecl &Item);
   LocalDecl *lookup(LocalDecl &Local);
   MemberDecl *lookup(MemberDecl &Member);
 
-  TypeArgDecl *lookupTypeArg(const std::string &Id);
+  TypeArgDecl *lookupTypeArg(Identifier Id);
   ItemDecl *lookupImport(const std::string &Id);
-  ItemDecl *lookupAll(const std::string &Id);
+  ItemDecl *lookupAll(Identifier Id);
 
   //===--------------------------------------------------------------------===//
   // Error Recovery & Suggestion Methods
@@ -116,10 +137,71 @@ private:
   // Member Variables
   //===--------------------------------------------------------------------===//
 
-  /// Stack of scopes, with the back being the innermost current scope
-  std::vector<Scope> Scopes;
+  /// Separate namespaces a declaration can be bound in
+  enum class Namespace : uint8_t { Var, Fun, Adt, Member, TypeArg, Module };
+  static constexpr std::size_t NumNamespaces = 6;
+
+  /// One entry of the undo log
+  struct Binding {
+    Namespace NS;
+    Identifier Name;
+    Decl *D; ///< The declaration made visible
+  };
+
+  /// Enclosing table consulted when a name is not bound in this one
+  const SymbolTable *Parent = nullptr;
+
+  /// (namespace, identifier) -> visible declaration
+  llvm::DenseMap<uint64_t, Decl *> Visible;
+
+  /// Every live binding in insertion order, innermost scope last
+  std::vector<Binding> Bindings;
+
+  /// Length of Bindings at each enterScope()
+  std::vector<uint32_t> ScopeMarks;
+
   std::map<std::string, ItemDecl *> ImportableItems;
 
+  /// Public functions and ADTs of one module. Built once when the module is
+  /// made importable and never modified, so every import shares it.
+  class ExportTable {
+  public:
+    explicit ExportTable(ModuleDecl &Mod);
+
+    [[nodiscard]] Decl *lookup(Namespace NS, Identifier Id) const {
+      auto It = Items.find(key(NS, Id));
+      return It != Items.end() ? It->second : nullptr;
+    }
+
+    template <typename F> void forEach(Namespace NS, F &&Fn) const {
+      for (auto &Item : Order) {
+        if (namespaceOf(*Item) == NS) {
+          Fn(Item->getIdentifier(), Item);
+        }
+      }
+    }
+
+  private:
+    llvm::DenseMap<uint64_t, Decl *> Items;
+    std::vector<ItemDecl *> Order; ///< For deterministic suggestions
+  };
+
+  /// Export table of every importable module; only kept by the outermost table
+  std::unordered_map<const ModuleDecl *, ExportTable> Exports;
+
+  /// Suggestion index over the names bound in this table itself, built on
+  /// the first failed lookup and dropped when a binding in its namespace
+  /// changes. Enclosing tables are frozen while this one exists, so their
+  /// indexes are reused as they are and only the local one is rebuilt.
+  mutable std::array<std::optional<SuggestionIndex>, NumNamespaces> Suggestions;
+
+  /// Guards Suggestions, since workers share their enclosing table's indexes
+  mutable std::mutex SuggestionMutex;
+
+  /// Whether any of Suggestions is built, so that binding a name in a table
+  /// nobody has asked for suggestions takes no lock
+  mutable std::atomic<bool> HasSuggestions{false};
+
   //===--------------------------------------------------------------------===//
   // Scope Management Methods
   //===--------------------------------------------------------------------===//
@@ -127,20 +209,65 @@ private:
   /**
    * @brief Enters a new scope
    *
-   * Pushes a new empty scope onto the scope stack. This should be called
-   * when entering any block that introduces a new lexical scope (function
-   * bodies, control structures, etc.).
+   * Marks the current end of the undo log. This should be called when
+   * entering any block that introduces a new lexical scope (function bodies,
+   * control structures, etc.).
    */
   void enterScope();
 
   /**
    * @brief Exits the current innermost scope
    *
-   * Pops the current scope from the scope stack, effectively ending the
-   * current lexical scope. All declarations in this scope become
-   * inaccessible.
+   * Rolls the undo log back to the matching enterScope() mark. All
+   * declarations in this scope become inaccessible.
    */
   void exitScope();
+
+  //===--------------------------------------------------------------------===//
+  // Binding Helpers
+  //===--------------------------------------------------------------------===//
+
+  /// Identifier entries are at least 8-byte aligned, leaving the low bits of
+  /// their address free for the namespace
+  static uint64_t key(Namespace NS, Identifier Name) {
+    return reinterpret_cast<uintptr_t>(Name.getOpaqueValue()) |
+           static_cast<uint8_t>(NS);
+  }
+
+  [[nodiscard]] static Namespace namespaceOf(const ItemDecl &Item);
+  [[nodiscard]] const SymbolTable &root() const {
+    return Parent ? Parent->root() : *this;
+  }
+
+  [[nodiscard]] Decl *find(Namespace NS, Identifier Id) const;
+  [[nodiscard]] Decl *findVisible(Namespace NS, Identifier Id) const;
+  [[nodiscard]] Decl *findBound(Namespace NS, Identifier Id) const;
+  [[nodiscard]] Decl *findExported(Namespace NS, Identifier Id) const;
+  bool bind(Namespace NS, Identifier Id, Decl *D);
+
+  [[nodiscard]] const SuggestionIndex &localSuggestions(Namespace NS) const;
+  [[nodiscard]] std::optional<SuggestionIndex::Match>
+  findClosest(Namespace NS, llvm::StringRef Query,
+              std::size_t MaxDistance) const;
+  void invalidateSuggestions(Namespace NS);
+
+  template <typename F>
+  void forEachLocalBinding(Namespace NS, F &&Fn) const {
+    for (auto It = Bindings.rbegin(); It != Bindings.rend(); ++It) {
+      if (It->NS == NS) {
+        Fn(llvm::StringRef(It->Name.str()), It->D);
+        continue;
+      }
+
+      // Items reachable through a module alias are suggested qualified
+      if (It->NS == Namespace::Module) {
+        const auto &Table = root().Exports.at(static_cast<ModuleDecl *>(It->D));
+        Table.forEach(NS, [&](Identifier Name, Decl *D) {
+          Fn(llvm::StringRef(It->Name.str() + "::" + Name.str()), D);
+        });
+      }
+    }
+  }
 };
 
 } // namespace phi
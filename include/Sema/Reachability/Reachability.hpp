@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include "AST/ASTVisitor.hpp"
+#include "AST/Nodes/Decl.hpp"
+#include "AST/Nodes/Expr.hpp"
+#include "AST/Nodes/Stmt.hpp"
+#include "AST/TypeSystem/Type.hpp"
+
+namespace phi {
+
+//===----------------------------------------------------------------------===//
+// Reachability - Finds the items a program actually uses
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Marks the items whose bodies are needed by the program
+ *
+ * Runs after name resolution. Starting from `main`, or from every public item
+ * when no module defines one (a library), it follows resolved calls, ADT
+ * initializers and every ADT named in a signature, annotation, cast or type
+ * argument. Methods are resolved only during inference, so an ADT is taken as
+ * a whole: reaching it reaches all of its methods.
+ *
+ * Items that are not reached keep their signatures, which later passes still
+ * check, but their bodies are neither inferred nor lowered.
+ */
+class Reachability : public RecursiveASTVisitor<Reachability> {
+public:
+  explicit Reachability(std::vector<ModuleDecl *> Modules)
+      : Modules(std::move(Modules)) {}
+
+  /// Sets the reachable flag of every item in every module
+  void run();
+
+  using RecursiveASTVisitor::visit;
+
+  void visit(FunCallExpr &E);
+  void visit(AdtInit &E);
+  void visitType(TypeRef T);
+
+private:
+  std::vector<ModuleDecl *> Modules;
+
+  llvm::SmallPtrSet<const ItemDecl *, 32> Reached;
+  llvm::SmallVector<ItemDecl *, 32> Worklist;
+
+  void collectRoots();
+  void reach(ItemDecl *Item);
+
+  void visitItem(ItemDecl &Item);
+};
+
+} // namespace phi
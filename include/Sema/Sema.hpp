@@ -1,14 +1,18 @@
 #include "AST/Nodes/Decl.hpp"
 #include "Diagnostics/DiagnosticManager.hpp"
 #include "Sema/NameResolution/NameResolver.hpp"
+#include "Sema/Reachability/Reachability.hpp"
 #include "Sema/TypeInference/Inferencer.hpp"
 
 namespace phi {
 
 class Sema {
 public:
-  Sema(std::vector<ModuleDecl *> Mods, DiagnosticManager *Diags)
-      : Mods(std::move(Mods)), Diags(Diags) {}
+  /// Unless \p CheckAll is set, only the bodies of items reachable from the
+  /// entry points are type checked
+  Sema(std::vector<ModuleDecl *> Mods, DiagnosticManager *Diags,
+       bool CheckAll = false)
+      : Mods(std::move(Mods)), Diags(Diags), CheckAll(CheckAll) {}
 
   bool analyze() {
     auto Resolved = NameResolver(Mods, Diags).resolve();
@@ -16,6 +20,10 @@ public:
       return false;
     }
 
+    if (!CheckAll) {
+      Reachability(Resolved).run();
+    }
+
     auto Checked = TypeInferencer(Resolved, Diags).infer();
     if (Diags->hasError()) {
       return false;
@@ -30,6 +38,7 @@ public:
 private:
   std::vector<ModuleDecl *> Mods;
   DiagnosticManager *Diags;
+  bool CheckAll;
 };
 
 } // namespace phi
@@ -5,14 +5,18 @@
 #include <variant>
 #include <vector>
 
+#include <llvm/ADT/DenseMap.h>
+
+#include "AST/ASTVisitor.hpp"
 #include "AST/Nodes/Decl.hpp"
 #include "AST/Nodes/Expr.hpp"
 #include "Diagnostics/DiagnosticManager.hpp"
+#include "Sema/TypeInference/TypeScheme.hpp"
 #include "Sema/TypeInference/Unifier.hpp"
 
 namespace phi {
 
-class TypeInferencer {
+class TypeInferencer : public ASTVisitor<TypeInferencer, TypeRef, void> {
 public:
   //===--------------------------------------------------------------------===//
   // Constructors & Destructors
@@ -42,16 +46,13 @@ public:
   void visit(VariantDecl &D);
   void visit(ModuleDecl &D);
   TypeRef instantiate(Decl *D);
-  std::unordered_map<const TypeArgDecl *, TypeRef> buildGenericSubstMap(
-      const std::vector<std::unique_ptr<TypeArgDecl>> &TypeArgs);
-  TypeRef substituteGenerics(
-      TypeRef Ty, const std::unordered_map<const TypeArgDecl *, TypeRef> &Map);
 
   //===--------------------------------------------------------------------===//
   // Statement Visitor Methods
   //===--------------------------------------------------------------------===//
 
-  void visit(Stmt &S);
+  using ASTVisitor::visit;
+
   void visit(ReturnStmt &S);
   void visit(DeferStmt &S);
   void visit(ForStmt &S);
@@ -67,7 +68,6 @@ public:
   // Expression Visitor Methods
   //===--------------------------------------------------------------------===//
 
-  TypeRef visit(Expr &E);
   TypeRef visit(IntLiteral &E);
   TypeRef visit(FloatLiteral &E);
   TypeRef visit(BoolLiteral &E);
@@ -100,6 +100,47 @@ private:
 
   TypeUnifier Unifier;
 
+  // Compiled once per function, method and ADT before any body is inferred,
+  // then shared read-only with the body workers
+  using SchemeTable = llvm::DenseMap<const Decl *, TypeScheme>;
+  std::shared_ptr<SchemeTable> Schemes = std::make_shared<SchemeTable>();
+
+  const TypeScheme &getScheme(const Decl &D) const;
+
+  /// A function or method body and the module it belongs to
+  struct Body {
+    ModuleDecl *Module;
+    Decl *D;
+  };
+
+  /// Checks module-level constraints, compiles the type schemes of \p D and
+  /// collects every function and method body so they can be inferred
+  /// independently
+  void collectBodies(ModuleDecl &D, std::vector<Body> &Bodies);
+
+  /// Infers a single function or method body with a fresh unifier, returning
+  /// the generic instantiations it uses
+  InstantiationSet inferBody(Decl &D);
+
+  //===--------------------------------------------------------------------===//
+  // Instantiation Recording
+  //===--------------------------------------------------------------------===//
+
+  /// Instantiations seen while finalizing the current body
+  InstantiationSet Instantiations;
+
+  /// Records \p D applied to \p TypeArgs, if \p D is generic and every
+  /// argument is concrete
+  void recordInstantiation(const NamedDecl *D,
+                           const std::vector<TypeRef> &TypeArgs);
+
+  /// Records every ADT applied to type arguments inside \p T
+  void recordInstantiations(TypeRef T);
+
+  /// Records the method \p E calls. A method of a generic ADT is keyed by the
+  /// receiver's type arguments, so only methods that are called get bodies.
+  void recordInstantiation(const MethodCallExpr &E);
+
   //===--------------------------------------------------------------------===//
   // Declaration Finalize Methods
   //===--------------------------------------------------------------------===//
@@ -126,6 +167,8 @@ private:
   void finalize(BreakStmt &S);
   void finalize(ContinueStmt &S);
   void finalize(ExprStmt &S);
+  void finalize(ImportStmt &S);
+  void finalize(UseStmt &S);
   void finalize(Block &B);
 
   //===--------------------------------------------------------------------===//
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include "AST/Nodes/Decl.hpp"
+#include "AST/TypeSystem/Type.hpp"
+
+namespace phi {
+
+/**
+ * @brief A declaration's signature compiled against its type parameters
+ *
+ * Every type parameter in scope of the declaration is given an index, and
+ * each member type (parameter, return, field or variant payload) is compiled
+ * once into a postfix program in which those parameters are indexed slots and
+ * every subtree that does not mention them is a single precomputed type.
+ * Instantiating a member is then one pass over its program with an array of
+ * type arguments, in the order given by getTypeParams().
+ */
+class TypeScheme {
+public:
+  //===--------------------------------------------------------------------===//
+  // Constructors
+  //===--------------------------------------------------------------------===//
+
+  /// Compiles the parameter, return and signature types of \p D
+  explicit TypeScheme(const FunDecl &D);
+
+  /// Compiles \p D with the parent ADT's type parameters first, followed by
+  /// the method's own
+  explicit TypeScheme(const MethodDecl &D);
+
+  /// Compiles the field types of a struct or the payload types of an enum
+  explicit TypeScheme(const AdtDecl &D);
+
+  //===--------------------------------------------------------------------===//
+  // Instantiation
+  //===--------------------------------------------------------------------===//
+
+  [[nodiscard]] llvm::ArrayRef<TypeArgDecl *> getTypeParams() const {
+    return TypeParams;
+  }
+
+  /// Returns \p Known followed by one fresh type variable per remaining type
+  /// parameter
+  [[nodiscard]] llvm::SmallVector<TypeRef, 4>
+  freshArgs(llvm::ArrayRef<TypeRef> Known = {}) const;
+
+  /// Instantiates the type of a ParamDecl, FieldDecl or VariantDecl payload
+  [[nodiscard]] TypeRef instantiate(const Decl &Member,
+                                    llvm::ArrayRef<TypeRef> Args) const;
+
+  /// Instantiates the return type of a function or method
+  [[nodiscard]] TypeRef instantiateReturn(llvm::ArrayRef<TypeRef> Args) const {
+    return run(Return, Args);
+  }
+
+  /// Instantiates the full function type of a function or method
+  [[nodiscard]] TypeRef
+  instantiateSignature(llvm::ArrayRef<TypeRef> Args) const {
+    return run(Signature, Args);
+  }
+
+private:
+  struct Op {
+    enum Kind : uint8_t { Fixed, Param, Applied, Tuple, Fun, Array, Ptr, Ref };
+
+    Kind K;
+    uint32_t N; // slot index for Param, operand count for composites
+    TypeRef T;  // the type itself; composites use only its span and length
+  };
+
+  // Range of Ops holding one compiled type
+  struct Program {
+    uint32_t Begin = 0;
+    uint32_t Size = 0;
+  };
+
+  llvm::SmallVector<TypeArgDecl *, 4> TypeParams;
+  std::vector<Op> Ops;
+  llvm::DenseMap<const Decl *, Program> Members;
+  Program Return;
+  Program Signature;
+
+  void addTypeParams(const std::vector<std::unique_ptr<TypeArgDecl>> &Args);
+  void compileFunction(const std::vector<std::unique_ptr<ParamDecl>> &Params,
+                       TypeRef ReturnTy, const SrcSpan &Span);
+
+  Program compile(TypeRef T);
+  bool emit(TypeRef T);
+  TypeRef run(Program P, llvm::ArrayRef<TypeRef> Args) const;
+};
+
+} // namespace phi
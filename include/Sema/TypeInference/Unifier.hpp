@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
 
 #include "AST/TypeSystem/Context.hpp"
 #include "AST/TypeSystem/Type.hpp"
@@ -8,78 +12,64 @@
 namespace phi {
 
 class TypeUnifier {
-  struct Node {
-    Type *TheType;
-    Type *Parent;
-    uint32_t Size{1};
-    std::optional<VarTy::Domain> Domain; // Only meaningful for Var roots
+  // One slot per type variable this unifier has seen, numbered in order of
+  // first use so a unifier only pays for the variables of the code it checks.
+  // Variables are shared between the unifiers of different bodies, so the
+  // numbering lives here rather than on the variable.
+  // Non-root slots point at their parent; a root slot may additionally be
+  // bound to the concrete type its whole equivalence class resolves to.
+  struct Slot {
+    uint64_t Parent;
+    uint8_t Rank{0};
+    VarTy *Var;
+    Type *Bound{nullptr}; // only meaningful for roots
+  };
+
+  // Memoized result of fully resolving a composite type, together with the
+  // root slots of the variables still free in it. The entry stays valid as
+  // long as each of those slots is an unbound root; binding or merging an
+  // unrelated variable leaves it alone. A ground entry has no free slots and
+  // never changes.
+  struct ZonkEntry {
+    Type *Result;
+    llvm::SmallVector<uint32_t, 2> Free;
   };
 
-  llvm::DenseMap<Type *, Node> Nodes;
+  std::vector<Slot> Slots;
+  llvm::DenseMap<const VarTy *, uint32_t> SlotOf;
+  llvm::DenseMap<const Type *, ZonkEntry> ZonkCache;
+  unsigned NumCacheHits = 0;
 
 public:
-  TypeUnifier() {
-    for (auto &T : TypeCtx::getAll()) {
-      getNode(T.get());
-    }
-  }
-
-  TypeRef resolve(TypeRef T) {
-    getNode(T);
-
-    auto *Resolved = find(T.getPtr());
-    if (auto App = llvm::dyn_cast<AppliedTy>(Resolved)) {
-      std::vector<TypeRef> InferredArgs;
-      for (auto &Arg : App->getArgs()) {
-        InferredArgs.push_back(resolve(Arg));
-      }
-      auto Res = TypeCtx::getApplied(resolve(App->getBase()), InferredArgs,
-                                     T.getSpan());
-      getNode(Res);
-      return Res;
-    }
-
-    if (auto Fun = llvm::dyn_cast<FunTy>(Resolved)) {
-      std::vector<TypeRef> InferredParams;
-      for (auto &Arg : Fun->getParamTys()) {
-        InferredParams.push_back(resolve(Arg));
-      }
-      auto Res = TypeCtx::getFun(InferredParams, resolve(Fun->getReturnTy()),
-                                 T.getSpan());
-      getNode(Res);
-      return Res;
-    }
-
-    if (auto Tup = llvm::dyn_cast<TupleTy>(Resolved)) {
-      std::vector<TypeRef> InferredElems;
-      for (auto &Arg : Tup->getElementTys()) {
-        InferredElems.push_back(resolve(Arg));
-      }
-
-      auto Res = TypeCtx::getTuple(InferredElems, T.getSpan());
-      getNode(Res);
-      return Res;
-    }
-
-    if (auto Arr = llvm::dyn_cast<ArrayTy>(Resolved)) {
-      TypeRef InferredTy = resolve(Arr->getContainedTy());
-      auto Res = TypeCtx::getArray(InferredTy, T.getSpan());
-      getNode(Res);
-      return Res;
-    }
-
-    return TypeRef(find(T.getPtr()), T.getSpan());
-  }
+  TypeUnifier() = default;
+  TypeUnifier(const TypeUnifier &) = delete;
+  TypeUnifier &operator=(const TypeUnifier &) = delete;
+
+  /// Fully resolves `T`, substituting every bound variable inside it.
+  TypeRef resolve(TypeRef T);
+
+  /// Resolves only the outermost layer of `T` to its representative.
+  TypeRef shallow(TypeRef T) { return {find(T.getPtr()), T.getSpan()}; }
 
   bool unify(TypeRef A, TypeRef B);
+
+  /// Unifies the type of a value with the type it is used as. Unlike unify
+  /// this is one-way: a fixed-size array may become a slice of the same
+  /// element type, but a slice never becomes an array.
+  bool coerce(TypeRef From, TypeRef To);
   void emit() const;
 
+  /// Number of resolutions this unifier answered from its cache.
+  [[nodiscard]] unsigned getNumCacheHits() const { return NumCacheHits; }
+
 private:
-  Type *find(TypeRef T);
   Type *find(Type *T);
+  Type *zonk(Type *T, llvm::SmallVectorImpl<uint32_t> &Free);
+  bool isStillValid(const ZonkEntry &Entry) const;
+  bool occurs(uint64_t Root, Type *T);
 
-  Node &getNode(TypeRef T);
-  Node &getNode(Type *T);
+  uint64_t getSlot(VarTy *Var);
+  uint64_t findRoot(uint64_t N);
 
   bool unifyVars(TypeRef A, TypeRef B);
   bool unifyConcretes(TypeRef A, TypeRef B);
@@ -3,13 +3,28 @@
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <llvm/ADT/Statistic.h>
+
 #include "AST/Nodes/Decl.hpp"
 #include "AST/TypeSystem/Type.hpp"
 
+#define DEBUG_TYPE "typectx"
+
+STATISTIC(NumAdtTypes, "Number of ADT types interned");
+STATISTIC(NumTupleTypes, "Number of tuple types interned");
+STATISTIC(NumFunTypes, "Number of function types interned");
+STATISTIC(NumPtrTypes, "Number of pointer types interned");
+STATISTIC(NumRefTypes, "Number of reference types interned");
+STATISTIC(NumTypeVars, "Number of type variables created");
+STATISTIC(NumGenericTypes, "Number of generic types interned");
+STATISTIC(NumAppliedTypes, "Number of applied types interned");
+STATISTIC(NumArrayTypes, "Number of array types interned");
+
 namespace phi {
 
 TypeCtx::TypeCtx() {
@@ -36,12 +51,13 @@ BuiltinTy *TypeCtx::builtin(BuiltinTy::Kind K) {
   return It->second;
 }
 
-AdtTy *TypeCtx::adt(const std::string &Id, AdtDecl *D) {
+AdtTy *TypeCtx::adt(Identifier Id, AdtDecl *D) {
   auto It = Adts.find(Id);
   if (It != Adts.end()) {
     return It->second;
   }
 
+  ++NumAdtTypes;
   auto *NewInst = Allocate<AdtTy>(Id, D);
   Adts[Id] = NewInst;
   return NewInst;
@@ -54,6 +70,7 @@ TupleTy *TypeCtx::tuple(const std::vector<TypeRef> &Elements) {
     return It->second;
   }
 
+  ++NumTupleTypes;
   auto *NewInst = Allocate<TupleTy>(Elements);
   Tuples.emplace(std::move(Key), NewInst);
   return NewInst;
@@ -66,6 +83,7 @@ FunTy *TypeCtx::fun(const std::vector<TypeRef> &Params, const TypeRef &Ret) {
     return It->second;
   }
 
+  ++NumFunTypes;
   auto *NewInst = Allocate<FunTy>(Params, Ret);
   Funs.emplace(std::move(Key), NewInst);
   return NewInst;
@@ -77,6 +95,7 @@ PtrTy *TypeCtx::ptr(const TypeRef &Pointee) {
     return It->second;
   }
 
+  ++NumPtrTypes;
   auto *NewInst = Allocate<PtrTy>(Pointee);
   Ptrs[Pointee.getPtr()] = NewInst;
   return NewInst;
@@ -88,6 +107,7 @@ RefTy *TypeCtx::ref(const TypeRef &Pointee) {
     return It->second;
   }
 
+  ++NumRefTypes;
   auto *NewInst = Allocate<RefTy>(Pointee);
   Refs[Pointee.getPtr()] = NewInst;
   return NewInst;
@@ -102,15 +122,26 @@ VarTy *TypeCtx::var(uint64_t N, VarTy::Domain /*Constraints*/) {
 }
 
 VarTy *TypeCtx::var(VarTy::Domain Domain) {
+  ++NumTypeVars;
   auto *NewInst = Allocate<VarTy>(Vars.size(), Domain);
   Vars.push_back(NewInst);
   return NewInst;
 }
 
-GenericTy *TypeCtx::generic(const std::string &Id, TypeArgDecl *D) {
-  auto *NewInst = Allocate<GenericTy>(Id, D);
-  Generics.push_back(NewInst);
-  return NewInst;
+GenericTy *TypeCtx::generic(Identifier Id, TypeArgDecl *D) {
+  // A parameter without a declaration yet gets one later through setDecl,
+  // so only declared parameters can be shared
+  if (!D) {
+    ++NumGenericTypes;
+    return Allocate<GenericTy>(Id, D);
+  }
+
+  auto &Slot = Generics[D];
+  if (!Slot) {
+    ++NumGenericTypes;
+    Slot = Allocate<GenericTy>(Id, D);
+  }
+  return Slot;
 }
 
 AppliedTy *TypeCtx::applied(TypeRef Base, std::vector<TypeRef> Args) {
@@ -120,17 +151,29 @@ AppliedTy *TypeCtx::applied(TypeRef Base, std::vector<TypeRef> Args) {
     return It->second;
   }
 
+  ++NumAppliedTypes;
   auto *NewInst = Allocate<AppliedTy>(Base, Args);
   Applieds.emplace(std::move(Key), NewInst);
   return NewInst;
 }
 
-ArrayTy *TypeCtx::array(const TypeRef &ContainedTy) {
+ArrayTy *TypeCtx::array(const TypeRef &ContainedTy,
+                        std::optional<uint64_t> Length) {
+  if (Length) {
+    auto &Slot = FixedArrays[{ContainedTy.getPtr(), *Length}];
+    if (!Slot) {
+      ++NumArrayTypes;
+      Slot = Allocate<ArrayTy>(ContainedTy, Length);
+    }
+    return Slot;
+  }
+
   auto It = Arrays.find(ContainedTy.getPtr());
   if (It != Arrays.end()) {
     return It->second;
   }
 
+  ++NumArrayTypes;
   auto *NewInst = Allocate<ArrayTy>(ContainedTy);
   Arrays[ContainedTy.getPtr()] = NewInst;
   return NewInst;
@@ -139,60 +182,82 @@ ArrayTy *TypeCtx::array(const TypeRef &ContainedTy) {
 ErrTy *TypeCtx::err() { return Err; }
 
 TypeRef TypeCtx::getBuiltin(BuiltinTy::Kind K, SrcSpan Span) {
+  // Builtins are allocated up front and never change, so no lock is needed
   auto *T = inst().builtin(K);
   return {T, std::move(Span)};
 }
 
-TypeRef TypeCtx::getAdt(const std::string &Id, AdtDecl *D, SrcSpan Span) {
-  auto *T = inst().adt(Id, D);
+TypeRef TypeCtx::getAdt(Identifier Id, AdtDecl *D, SrcSpan Span) {
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.adt(Id, D);
   return {T, std::move(Span)};
 }
 
 TypeRef TypeCtx::getTuple(const std::vector<TypeRef> &Elements, SrcSpan Span) {
-  auto *T = inst().tuple(Elements);
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.tuple(Elements);
   return {T, std::move(Span)};
 }
 
 TypeRef TypeCtx::getFun(const std::vector<TypeRef> &Params, const TypeRef &Ret,
                         SrcSpan Span) {
-  auto *T = inst().fun(Params, Ret);
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.fun(Params, Ret);
   return {T, std::move(Span)};
 }
 
 TypeRef TypeCtx::getPtr(const TypeRef &Pointee, SrcSpan Span) {
-  auto *T = inst().ptr(Pointee);
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.ptr(Pointee);
   return {T, std::move(Span)};
 }
 
 TypeRef TypeCtx::getRef(const TypeRef &Pointee, SrcSpan Span) {
-  auto *T = inst().ref(Pointee);
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.ref(Pointee);
   return {T, std::move(Span)};
 }
 
 TypeRef TypeCtx::getVar(uint64_t N, VarTy::Domain Domain, SrcSpan Span) {
-  auto *T = inst().var(N, Domain);
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.var(N, Domain);
   return {T, std::move(Span)};
 }
 
 TypeRef TypeCtx::getVar(VarTy::Domain Domain, SrcSpan Span) {
-  auto *T = inst().var(Domain);
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.var(Domain);
   return {T, std::move(Span)};
 }
 
-TypeRef TypeCtx::getGeneric(const std::string &Id, TypeArgDecl *D,
+TypeRef TypeCtx::getGeneric(Identifier Id, TypeArgDecl *D,
                             SrcSpan Span) {
-  auto *T = inst().generic(Id, D);
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.generic(Id, D);
   return {T, std::move(Span)};
 }
 
 TypeRef TypeCtx::getApplied(TypeRef Base, std::vector<TypeRef> Args,
                             SrcSpan Span) {
-  auto *T = inst().applied(Base, Args);
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.applied(Base, Args);
   return {T, std::move(Span)};
 }
 
-TypeRef TypeCtx::getArray(const TypeRef &ContainedTy, SrcSpan Span) {
-  auto *T = inst().array(ContainedTy);
+TypeRef TypeCtx::getArray(const TypeRef &ContainedTy, SrcSpan Span,
+                          std::optional<uint64_t> Length) {
+  auto &Ctx = inst();
+  std::scoped_lock Lock(Ctx.Mutex);
+  auto *T = Ctx.array(ContainedTy, Length);
   return {T, std::move(Span)};
 }
 
@@ -204,3 +269,5 @@ TypeRef TypeCtx::getErr(SrcSpan Span) {
 std::deque<std::unique_ptr<Type>> &TypeCtx::getAll() { return inst().Arena; }
 
 } // namespace phi
+
+#undef DEBUG_TYPE
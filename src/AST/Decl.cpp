@@ -40,7 +40,7 @@ void TypeArgDecl::emit(int Level) const {
 // ParamDecl Implementation
 //===----------------------------------------------------------------------===//
 
-ParamDecl::ParamDecl(SrcSpan Span, Mutability M, std::string Id, TypeRef Type)
+ParamDecl::ParamDecl(SrcSpan Span, Mutability M, Identifier Id, TypeRef Type)
     : LocalDecl(Kind::Param, Span, std::move(Id), Type) {
   TheMutability = M;
 }
@@ -54,7 +54,7 @@ void ParamDecl::emit(int Level) const {
 // VarDecl Implementation
 //===----------------------------------------------------------------------===//
 
-VarDecl::VarDecl(SrcSpan Span, Mutability M, std::string Id,
+VarDecl::VarDecl(SrcSpan Span, Mutability M, Identifier Id,
                  std::optional<TypeRef> DeclType)
     : LocalDecl(Kind::Var, Span, std::move(Id),
                 DeclType.value_or(TypeCtx::getVar(VarTy::Any, Span))) {
@@ -71,7 +71,7 @@ void VarDecl::emit(int Level) const {
 //===----------------------------------------------------------------------===//
 
 FieldDecl::FieldDecl(SrcSpan Span, uint32_t Index, Visibility Vis,
-                     std::string Id, TypeRef Type, std::unique_ptr<Expr> Init)
+                     Identifier Id, TypeRef Type, std::unique_ptr<Expr> Init)
     : MemberDecl(Kind::Field, Span, Vis, std::move(Id)), Index(Index),
       Type(Type), Init(std::move(Init)) {}
 
@@ -89,7 +89,7 @@ void FieldDecl::emit(int Level) const {
 // MethodDecl Implementation
 //===----------------------------------------------------------------------===//
 
-MethodDecl::MethodDecl(SrcSpan Span, Visibility Vis, std::string Id,
+MethodDecl::MethodDecl(SrcSpan Span, Visibility Vis, Identifier Id,
                        std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
                        std::vector<std::unique_ptr<ParamDecl>> Params,
                        TypeRef ReturnType, std::unique_ptr<Block> Body)
@@ -123,7 +123,7 @@ void MethodDecl::emit(int Level) const {
 // VariantDecl Implementation
 //===----------------------------------------------------------------------===//
 
-VariantDecl::VariantDecl(SrcSpan Span, std::string Id,
+VariantDecl::VariantDecl(SrcSpan Span, Identifier Id,
                          std::optional<TypeRef> PayloadType)
     : MemberDecl(Kind::Variant, Span, Visibility::Public, std::move(Id)),
       PayloadType(std::move(PayloadType)) {}
@@ -141,7 +141,7 @@ void VariantDecl::emit(int Level) const {
 // StructDecl Implementation
 //===----------------------------------------------------------------------===//
 
-StructDecl::StructDecl(SrcSpan Span, Visibility Vis, std::string Id,
+StructDecl::StructDecl(SrcSpan Span, Visibility Vis, Identifier Id,
                        std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
                        std::vector<std::unique_ptr<FieldDecl>> Fields,
                        std::vector<std::unique_ptr<MethodDecl>> Methods)
@@ -150,7 +150,7 @@ StructDecl::StructDecl(SrcSpan Span, Visibility Vis, std::string Id,
       Fields(std::move(Fields)) {
 
   for (auto &F : this->Fields) {
-    FieldMap.emplace(F->getId(), F.get());
+    FieldMap.try_emplace(F->getIdentifier(), F.get());
     F->setParent(this);
   }
 }
@@ -183,7 +183,7 @@ void StructDecl::emit(int Level) const {
 // EnumDecl Implementation
 //===----------------------------------------------------------------------===//
 
-EnumDecl::EnumDecl(SrcSpan Span, Visibility Vis, std::string Id,
+EnumDecl::EnumDecl(SrcSpan Span, Visibility Vis, Identifier Id,
                    std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
                    std::vector<std::unique_ptr<VariantDecl>> Variants,
                    std::vector<std::unique_ptr<MethodDecl>> Methods)
@@ -192,7 +192,7 @@ EnumDecl::EnumDecl(SrcSpan Span, Visibility Vis, std::string Id,
       Variants(std::move(Variants)) {
 
   for (auto &V : this->Variants) {
-    VariantMap.emplace(V->getId(), V.get());
+    VariantMap.try_emplace(V->getIdentifier(), V.get());
     V->setParent(this);
   }
 }
@@ -225,7 +225,7 @@ void EnumDecl::emit(int Level) const {
 // FunDecl Implementation
 //===----------------------------------------------------------------------===//
 
-FunDecl::FunDecl(SrcSpan Span, Visibility Vis, std::string Id,
+FunDecl::FunDecl(SrcSpan Span, Visibility Vis, Identifier Id,
                  std::vector<std::unique_ptr<TypeArgDecl>> TypeArgs,
                  std::vector<std::unique_ptr<ParamDecl>> Params,
                  TypeRef ReturnType, std::unique_ptr<Block> Body)
@@ -259,7 +259,7 @@ void FunDecl::emit(int Level) const {
 // ModuleDecl Implementation
 //===----------------------------------------------------------------------===//
 
-ModuleDecl::ModuleDecl(SrcSpan PathSpan, Visibility Vis, std::string Id,
+ModuleDecl::ModuleDecl(SrcSpan PathSpan, Visibility Vis, Identifier Id,
                        std::vector<std::string> Path,
                        std::vector<std::unique_ptr<ItemDecl>> Items,
                        std::vector<std::unique_ptr<ImportStmt>> Imports,
@@ -37,7 +37,7 @@ void emitSingularPattern(const Pattern &Pat, int Level) {
           std::println("{}Literal:", indent(Level));
           Pat.Value->emit(Level + 1);
         } else if constexpr (std::is_same_v<T, PatternAtomics::Variant>) {
-          std::println("{}Variant: {}", indent(Level), Pat.VariantName);
+          std::println("{}Variant: {}", indent(Level), Pat.VariantName.str());
           if (!Pat.Vars.empty()) {
             std::println("{}Variables:", indent(Level + 1));
             for (const auto &Var : Pat.Vars) {
@@ -196,17 +196,17 @@ void ArrayLiteral::emit(int Level) const {
 // DeclRefExpr Implementation
 //===----------------------------------------------------------------------===//
 
-DeclRefExpr::DeclRefExpr(SrcLocation Location, std::string Id)
-    : Expr(Expr::Kind::DeclRefKind, std::move(Location)), Id(std::move(Id)) {}
+DeclRefExpr::DeclRefExpr(SrcLocation Location, Identifier Id)
+    : Expr(Expr::Kind::DeclRefKind, std::move(Location)), Id(Id) {}
 
 void DeclRefExpr::emit(int Level) const {
   if (DeclPtr == nullptr) {
-    std::println("{}DeclRefExpr: {} ", indent(Level), Id);
+    std::println("{}DeclRefExpr: {} ", indent(Level), getId());
     std::println("{}Type: {} ", indent(Level + 1), Type.toString());
   } else {
     std::string TypeStr = DeclPtr->getType().toString();
     std::println("{}DeclRefExpr: {}; referring to: {} of type {}",
-                 indent(Level), Id, DeclPtr->getId(), TypeStr);
+                 indent(Level), getId(), DeclPtr->getId(), TypeStr);
   }
 }
 
@@ -292,18 +292,18 @@ void UnaryOp::emit(int Level) const {
 // MemberInit Implementation
 //===----------------------------------------------------------------------===//
 
-MemberInit::MemberInit(SrcLocation Location, std::string MemberId,
+MemberInit::MemberInit(SrcLocation Location, Identifier MemberId,
                        std::unique_ptr<Expr> Init)
     : Expr(Expr::Kind::MemberInitKind, Location,
            TypeCtx::getBuiltin(BuiltinTy::Null, SrcSpan(Location))),
-      FieldId(std::move(MemberId)), InitValue(std::move(Init)) {}
+      FieldId(MemberId), InitValue(std::move(Init)) {}
 
 MemberInit::~MemberInit() = default;
 
 void MemberInit::emit(int Level) const {
   std::println("{}MemberInit:", indent(Level));
   std::println("{}Type: {} ", indent(Level + 1), Type.toString());
-  std::println("{}Member: {}", indent(Level + 1), FieldId);
+  std::println("{}Member: {}", indent(Level + 1), getId());
   if (InitValue) {
     std::println("{}Value:", indent(Level + 1));
     InitValue->emit(Level + 2);
@@ -314,7 +314,7 @@ void MemberInit::emit(int Level) const {
 // AdtInit Implementation
 //===----------------------------------------------------------------------===//
 
-AdtInit::AdtInit(SrcLocation Location, std::optional<std::string> TypeName,
+AdtInit::AdtInit(SrcLocation Location, std::optional<Identifier> TypeName,
                  std::vector<TypeRef> TypeArgs,
                  std::vector<std::unique_ptr<MemberInit>> Inits)
     : Expr(Expr::Kind::AdtInitKind, Location,
@@ -329,7 +329,7 @@ AdtInit::~AdtInit() = default;
 void AdtInit::emit(int Level) const {
   std::println("{}AdtInit:", indent(Level));
   std::println("{}For name: {}", indent(Level + 1),
-               TypeName.value_or("No name"));
+               TypeName ? TypeName->str() : "No name");
   if (Decl)
     std::println("{}Referring to: {}", indent(Level + 1), Decl->getId());
   std::println("{}Type: {} ", indent(Level + 1), Type.toString());
@@ -353,9 +353,9 @@ void AdtInit::emit(int Level) const {
 
 FieldAccessExpr::FieldAccessExpr(SrcLocation Location,
                                  std::unique_ptr<Expr> Base,
-                                 std::string MemberId)
+                                 Identifier MemberId)
     : Expr(Expr::Kind::FieldAccessKind, std::move(Location)),
-      Base(std::move(Base)), FieldId(std::move(MemberId)) {}
+      Base(std::move(Base)), FieldId(MemberId) {}
 
 FieldAccessExpr::~FieldAccessExpr() = default;
 
@@ -365,7 +365,7 @@ void FieldAccessExpr::emit(int Level) const {
   std::println("{}Type: {} ", indent(Level + 1), Type.toString());
   std::println("{}Base:", indent(Level + 1));
   Base->emit(Level + 2);
-  std::println("{}Member: {}", indent(Level + 1), FieldId);
+  std::println("{}Member: {}", indent(Level + 1), getFieldId());
 }
 
 //===----------------------------------------------------------------------===//
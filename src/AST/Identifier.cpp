@@ -0,0 +1,73 @@
+#include "AST/Identifier.hpp"
+
+#include <deque>
+#include <mutex>
+
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/Statistic.h>
+#include <llvm/ADT/StringMap.h>
+
+#define DEBUG_TYPE "identifier"
+
+STATISTIC(NumIdentifiers, "Number of distinct identifiers interned");
+
+namespace phi {
+
+namespace {
+
+/// Process-wide identifier table. Entries live in a deque so that handles
+/// stay valid as the table grows.
+struct IdentifierTable {
+  std::mutex Mutex;
+  std::deque<Identifier::Entry> Entries;
+  llvm::StringMap<const Identifier::Entry *> Index;
+
+  static IdentifierTable &inst() {
+    static IdentifierTable Table;
+    return Table;
+  }
+};
+
+} // namespace
+
+Identifier::Identifier() {
+  static const Entry Empty{.Str = "", .Hash = 0};
+  E = &Empty;
+}
+
+Identifier::Identifier(llvm::StringRef Str) {
+  if (Str.empty()) {
+    *this = Identifier();
+    return;
+  }
+
+  auto &Table = IdentifierTable::inst();
+  std::scoped_lock Lock(Table.Mutex);
+  auto [It, Inserted] = Table.Index.try_emplace(Str, nullptr);
+  if (Inserted) {
+    ++NumIdentifiers;
+    It->second = &Table.Entries.emplace_back(Entry{
+        .Str = Str.str(),
+        .Hash = static_cast<unsigned>(llvm::hash_value(Str)),
+    });
+  }
+  E = It->second;
+}
+
+std::optional<Identifier> Identifier::find(llvm::StringRef Str) {
+  if (Str.empty()) {
+    return Identifier();
+  }
+
+  auto &Table = IdentifierTable::inst();
+  std::scoped_lock Lock(Table.Mutex);
+  auto It = Table.Index.find(Str);
+  if (It == Table.Index.end()) {
+    return std::nullopt;
+  }
+  return Identifier(It->second);
+}
+
+} // namespace phi
+
+#undef DEBUG_TYPE
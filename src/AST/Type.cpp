@@ -133,11 +133,14 @@ std::string RefTy::toString() const { return "&" + Pointee.toString(); }
 
 std::string VarTy::toString() const { return "T" + std::to_string(N); }
 
-std::string GenericTy::toString() const { return "Generic: " + Id; };
+std::string GenericTy::toString() const { return "Generic: " + getId(); };
 
 std::string ErrTy::toString() const { return "Error"; }
 
 std::string ArrayTy::toString() const {
+  if (Length) {
+    return "[" + ContainedTy.toString() + "; " + std::to_string(*Length) + "]";
+  }
   return "[" + ContainedTy.toString() + "]";
 }
 
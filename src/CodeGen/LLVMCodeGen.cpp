@@ -4,8 +4,14 @@
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
 #include <llvm/TargetParser/Host.h>
 
+#include <memory>
+#include <stdexcept>
 #include <system_error>
 
 using namespace phi;
@@ -16,10 +22,29 @@ using namespace phi;
 // Constructor & Main Entry Points
 //===----------------------------------------------------------------------===//
 
+/// The data layout the backend for \p Triple sizes and aligns types by
+static llvm::DataLayout getTargetDataLayout(const std::string &Triple) {
+  static const bool NoNativeTarget = llvm::InitializeNativeTarget();
+  (void)NoNativeTarget;
+
+  std::string Error;
+  const auto *Target = llvm::TargetRegistry::lookupTarget(Triple, Error);
+  if (!Target)
+    throw std::runtime_error("Unsupported target " + Triple + ": " + Error);
+  std::unique_ptr<llvm::TargetMachine> TM(Target->createTargetMachine(
+      Triple, "generic", "", llvm::TargetOptions(), {}));
+  return TM->createDataLayout();
+}
+
 CodeGen::CodeGen(std::vector<ModuleDecl *> Mods, std::string_view SourcePath)
-    : Ast(std::move(Mods)), SourcePath(SourcePath), Context(), Builder(Context),
-      Module(std::string(SourcePath), Context) {
-  Module.setTargetTriple(llvm::sys::getDefaultTargetTriple());
+    : Ast(std::move(Mods)), SourcePath(SourcePath), Context(),
+      Builder(Context, llvm::ConstantFolder(),
+              llvm::IRBuilderCallbackInserter(
+                  [this](llvm::Instruction *I) { alignMemoryAccess(I); })),
+      Module(std::make_unique<llvm::Module>(SourcePath, Context)) {
+  std::string Triple = llvm::sys::getDefaultTargetTriple();
+  Module->setTargetTriple(Triple);
+  Module->setDataLayout(getTargetDataLayout(Triple));
 }
 
 void CodeGen::generate() {
@@ -29,16 +54,18 @@ void CodeGen::generate() {
   // Phase 2: Monomorphize generic types and functions
   monomorphize();
 
-  // Phase 3: Desugar
-  desugar();
-
   // Phase 4: IR Generation
   for (auto *M : Ast) {
     codegenModule(M);
   }
 
-  // Final Phase: Generate bodies for monomorphized functions
+  // Generate bodies for monomorphized functions
   generateMonomorphizedBodies();
+
+  // Phase 5: Share bodies between instances that lowered identically, then
+  // infer what attributes the source left unsaid
+  mergeIdenticalFunctions();
+  inferFunctionAttributes();
 }
 
 void CodeGen::outputIR(const std::string &Filename) {
@@ -46,7 +73,7 @@ void CodeGen::outputIR(const std::string &Filename) {
   llvm::raw_fd_ostream File(Filename, EC);
   if (EC)
     throw std::runtime_error("Could not open file: " + EC.message());
-  Module.print(File, nullptr);
+  Module->print(File, nullptr);
 }
 
 //===----------------------------------------------------------------------===//
@@ -96,7 +123,12 @@ llvm::Type *CodeGen::getLLVMType(const Type *T) {
     }
   }
 
+  // A generic ADT named without arguments, like the type of `this` in its
+  // methods, lowers to the instance the current substitution picks
   bool IsGenericDependent = hasGenericType(T);
+  if (auto *AT = llvm::dyn_cast_or_null<AdtTy>(T)) {
+    IsGenericDependent |= AT->getDecl() && AT->getDecl()->hasTypeArgs();
+  }
 
   // Check cache first (only if strict concrete type)
   if (!IsGenericDependent) {
@@ -159,10 +191,14 @@ llvm::Type *CodeGen::getLLVMType(const Type *T) {
     }
     Result = llvm::StructType::get(Context, ElemTypes);
   } else if (auto *AT = llvm::dyn_cast<ArrayTy>(T)) {
-    // Array as slice: { T*, i64 }
+    // Fixed-size arrays are stored inline, slices as { T*, i64 }
     llvm::Type *ElemTy = getLLVMType(AT->getContainedTy());
-    Result = llvm::StructType::get(
-        Context, {ElemTy->getPointerTo(), Builder.getInt64Ty()});
+    if (auto Length = AT->getLength()) {
+      Result = llvm::ArrayType::get(ElemTy, *Length);
+    } else {
+      Result = llvm::StructType::get(
+          Context, {ElemTy->getPointerTo(), Builder.getInt64Ty()});
+    }
   } else if (llvm::isa<PtrTy>(T)) {
     Result = Builder.getPtrTy();
   } else if (llvm::isa<RefTy>(T)) {
@@ -267,45 +303,11 @@ llvm::StructType *CodeGen::getOrCreateStructType(const StructDecl *S) {
   if (It != StructTypes.end() && !It->second->isOpaque())
     return It->second;
 
-  std::vector<llvm::Type *> FieldTypes;
-  unsigned Idx = 0;
+  std::vector<std::pair<Identifier, llvm::Type *>> Fields;
   for (const auto &F : S->getFields()) {
-    FieldTypes.push_back(getLLVMType(F->getType()));
-    FieldIndices[Name][F->getId()] = Idx++;
+    Fields.push_back({F->getIdentifier(), getLLVMType(F->getType())});
   }
-
-  llvm::StructType *ST;
-  if (It != StructTypes.end()) {
-    ST = It->second;
-    ST->setBody(FieldTypes);
-  } else {
-    ST = llvm::StructType::create(Context, FieldTypes, Name);
-    StructTypes[Name] = ST;
-  }
-  return ST;
-}
-
-llvm::StructType *
-CodeGen::getOrCreateStructType(const std::string &Name,
-                               const std::vector<TypeRef> &FieldTypes) {
-  auto It = StructTypes.find(Name);
-  if (It != StructTypes.end() && !It->second->isOpaque())
-    return It->second;
-
-  std::vector<llvm::Type *> LLVMTypes;
-  for (const auto &T : FieldTypes) {
-    LLVMTypes.push_back(getLLVMType(T));
-  }
-
-  llvm::StructType *ST;
-  if (It != StructTypes.end()) {
-    ST = It->second;
-    ST->setBody(LLVMTypes);
-  } else {
-    ST = llvm::StructType::create(Context, LLVMTypes, Name);
-    StructTypes[Name] = ST;
-  }
-  return ST;
+  return layOutStruct(Name, S, Fields);
 }
 
 llvm::StructType *CodeGen::getOrCreateEnumType(const EnumDecl *E) {
@@ -314,93 +316,13 @@ llvm::StructType *CodeGen::getOrCreateEnumType(const EnumDecl *E) {
   if (It != StructTypes.end() && !It->second->isOpaque())
     return It->second;
 
-  // Find largest payload size
-  uint64_t MaxPayloadSize = 0;
-  unsigned Discriminant = 0;
+  std::vector<std::pair<std::string, llvm::Type *>> Variants;
   for (const auto &V : E->getVariants()) {
-    VariantDiscriminants[Name][V->getId()] = Discriminant++;
-    if (V->hasPayload()) {
-      llvm::Type *PayloadTy = getLLVMType(V->getPayloadType());
-      VariantPayloadTypes[Name][V->getId()] = PayloadTy;
-      uint64_t Size = getTypeSize(PayloadTy);
-      MaxPayloadSize = std::max(MaxPayloadSize, Size);
-    }
+    llvm::Type *PayloadTy =
+        V->hasPayload() ? getLLVMType(V->getPayloadType()) : nullptr;
+    Variants.push_back({V->getId(), PayloadTy});
   }
-
-  // Enum layout: { i32 discriminant, [max_size x i8] }
-  std::vector<llvm::Type *> Members = {Builder.getInt32Ty()};
-  if (MaxPayloadSize > 0) {
-    Members.push_back(
-        llvm::ArrayType::get(Builder.getInt8Ty(), MaxPayloadSize));
-  }
-
-  llvm::StructType *ST;
-  if (It != StructTypes.end()) {
-    ST = It->second;
-    ST->setBody(Members);
-  } else {
-    ST = llvm::StructType::create(Context, Members, Name);
-    StructTypes[Name] = ST;
-  }
-  return ST;
-}
-
-llvm::StructType *
-CodeGen::getOrCreateEnumType(const std::string &Name,
-                             const std::vector<VariantDecl *> &Variants) {
-  auto It = StructTypes.find(Name);
-  if (It != StructTypes.end() && !It->second->isOpaque())
-    return It->second;
-
-  uint64_t MaxPayloadSize = 0;
-  unsigned Discriminant = 0;
-  for (const auto *V : Variants) {
-    VariantDiscriminants[Name][V->getId()] = Discriminant++;
-    if (V->hasPayload()) {
-      llvm::Type *PayloadTy = getLLVMType(V->getPayloadType());
-      VariantPayloadTypes[Name][V->getId()] = PayloadTy;
-      uint64_t Size = getTypeSize(PayloadTy);
-      MaxPayloadSize = std::max(MaxPayloadSize, Size);
-    }
-  }
-
-  std::vector<llvm::Type *> Members = {Builder.getInt32Ty()};
-  if (MaxPayloadSize > 0) {
-    Members.push_back(
-        llvm::ArrayType::get(Builder.getInt8Ty(), MaxPayloadSize));
-  }
-
-  llvm::StructType *ST;
-  if (It != StructTypes.end()) {
-    ST = It->second;
-    ST->setBody(Members);
-  } else {
-    ST = llvm::StructType::create(Context, Members, Name);
-    StructTypes[Name] = ST;
-  }
-  return ST;
-}
-
-uint64_t CodeGen::getTypeSize(llvm::Type *T) {
-  if (T->isIntegerTy())
-    return T->getIntegerBitWidth() / 8;
-  if (T->isFloatTy())
-    return 4;
-  if (T->isDoubleTy())
-    return 8;
-  if (T->isPointerTy())
-    return 8;
-  if (auto *ST = llvm::dyn_cast<llvm::StructType>(T)) {
-    uint64_t Size = 0;
-    for (unsigned I = 0; I < ST->getNumElements(); ++I) {
-      Size += getTypeSize(ST->getElementType(I));
-    }
-    return Size;
-  }
-  if (auto *AT = llvm::dyn_cast<llvm::ArrayType>(T)) {
-    return AT->getNumElements() * getTypeSize(AT->getElementType());
-  }
-  return 8; // Default
+  return layOutEnum(Name, E, Variants);
 }
 
 //===----------------------------------------------------------------------===//
@@ -412,7 +334,9 @@ llvm::AllocaInst *CodeGen::createEntryBlockAlloca(llvm::Function *Fn,
                                                   llvm::Type *Ty) {
   llvm::IRBuilder<> TmpBuilder(&Fn->getEntryBlock(),
                                Fn->getEntryBlock().begin());
-  return TmpBuilder.CreateAlloca(Ty, nullptr, Name);
+  auto *Alloca = TmpBuilder.CreateAlloca(Ty, nullptr, Name);
+  alignMemoryAccess(Alloca);
+  return Alloca;
 }
 
 std::string CodeGen::generateTempVar() {
@@ -428,15 +352,68 @@ llvm::Value *CodeGen::loadValue(llvm::Value *Ptr, llvm::Type *Ty) {
 }
 
 void CodeGen::storeValue(llvm::Value *Val, llvm::Value *Ptr) {
+  // A constant table is copied from its global rather than stored element
+  // by element
+  if (isConstantTable(Val)) {
+    llvm::Type *Ty = Val->getType();
+    llvm::Align Align(getTypeAlign(Ty));
+    llvm::Align DestAlign = isPackedMember(Ptr) ? llvm::Align(1) : Align;
+    Builder.CreateMemCpy(Ptr, DestAlign,
+                         getConstantGlobal(llvm::cast<llvm::Constant>(Val)),
+                         Align, getTypeSize(Ty));
+    return;
+  }
   Builder.CreateStore(Val, Ptr);
 }
 
+llvm::Value *CodeGen::coerceValue(llvm::Value *V, llvm::Type *DestTy) {
+  llvm::Type *SrcTy = V->getType();
+  if (SrcTy == DestTy) {
+    return V;
+  }
+
+  // An array borrowed as a slice lives in a stack slot of its own
+  auto *ArrTy = llvm::dyn_cast<llvm::ArrayType>(SrcTy);
+  auto *SliceTy = llvm::dyn_cast<llvm::StructType>(DestTy);
+  if (ArrTy && SliceTy) {
+    auto *Slot = createEntryBlockAlloca(CurrentFunction, "array.tmp", ArrTy);
+    storeValue(V, Slot);
+    llvm::Value *Slice = llvm::UndefValue::get(SliceTy);
+    Slice = Builder.CreateInsertValue(
+        Slice, Builder.CreateConstInBoundsGEP2_32(ArrTy, Slot, 0, 0), 0);
+    return Builder.CreateInsertValue(
+        Slice, Builder.getInt64(ArrTy->getNumElements()), 1);
+  }
+
+  return V;
+}
+
+llvm::Value *CodeGen::coerceValue(llvm::Value *V, TypeRef DestTy) {
+  auto *Arr = llvm::dyn_cast<ArrayTy>(DestTy.getPtr());
+  auto *SrcTy = llvm::dyn_cast<llvm::ArrayType>(V->getType());
+  if (Arr && SrcTy) {
+    llvm::Type *ElemTy = getLLVMType(Arr->getContainedTy());
+    if (SrcTy->getElementType() != ElemTy) {
+      uint64_t N = SrcTy->getNumElements();
+      llvm::Value *Elems =
+          llvm::UndefValue::get(llvm::ArrayType::get(ElemTy, N));
+      for (uint64_t I = 0; I < N; ++I) {
+        llvm::Value *Elem = Builder.CreateExtractValue(V, I);
+        Elem = coerceValue(Elem, Arr->getContainedTy());
+        Elems = Builder.CreateInsertValue(Elems, Elem, I);
+      }
+      V = Elems;
+    }
+  }
+  return coerceValue(V, getLLVMType(DestTy));
+}
+
 void CodeGen::declarePrintln() {
   // Declare printf for println support
   auto *PrintfTy =
       llvm::FunctionType::get(Builder.getInt32Ty(), {Builder.getPtrTy()}, true);
   llvm::FunctionCallee PrintfCallee =
-      Module.getOrInsertFunction("printf", PrintfTy);
+      Module->getOrInsertFunction("printf", PrintfTy);
   if (auto *F = llvm::dyn_cast<llvm::Function>(PrintfCallee.getCallee())) {
     PrintFn = F;
   }
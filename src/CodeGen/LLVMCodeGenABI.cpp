@@ -0,0 +1,204 @@
+#include "CodeGen/LLVMCodeGen.hpp"
+
+#include <llvm/ADT/Statistic.h>
+#include <llvm/IR/Attributes.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+
+#define DEBUG_TYPE "codegen"
+
+STATISTIC(NumSRetFunctions, "Number of functions returning through sret");
+STATISTIC(NumIndirectParams, "Number of parameters passed through memory");
+
+using namespace phi;
+
+//===----------------------------------------------------------------------===//
+// Phase 4: Calling Convention
+//===----------------------------------------------------------------------===//
+
+// Aggregates travel as LLVM values only while they are small. Anything over
+// 16 bytes is returned through a caller-allocated `sret` pointer, and a `var`
+// parameter is passed `byval`. A `const` parameter cannot be written by the
+// callee, so it goes by a `readonly noalias` pointer to the caller's own
+// storage instead and is not copied at all.
+//
+// This is Phi's own convention between Phi functions. It borrows the size
+// cut-off of the SysV x86-64 MEMORY class, but smaller aggregates are not
+// classified into registers the way a C compiler would, so a Phi signature
+// taking or returning a struct does not match the C one.
+
+bool CodeGen::isPassedIndirectly(llvm::Type *T) {
+  if (!T->isStructTy() && !T->isArrayTy()) {
+    return false;
+  }
+  return getTypeSize(T) > 16;
+}
+
+llvm::Function *CodeGen::createLoweredFunction(
+    const std::string &Name, llvm::ArrayRef<std::unique_ptr<ParamDecl>> Params,
+    TypeRef RetTy, bool Exported) {
+  FunctionABI ABI;
+  std::vector<llvm::Type *> ParamTypes;
+
+  llvm::Type *LoweredRetTy = getLLVMType(RetTy);
+  if (isPassedIndirectly(LoweredRetTy)) {
+    ABI.SRetTy = LoweredRetTy;
+    LoweredRetTy = Builder.getVoidTy();
+    ParamTypes.push_back(Builder.getPtrTy());
+  }
+
+  for (const auto &P : Params) {
+    llvm::Type *Ty = getLLVMType(P->getType());
+    bool Indirect = isPassedIndirectly(Ty);
+    ABI.IndirectParams.push_back(Indirect ? Ty : nullptr);
+    ParamTypes.push_back(Indirect ? Builder.getPtrTy() : Ty);
+  }
+
+  auto *FnTy = llvm::FunctionType::get(LoweredRetTy, ParamTypes, false);
+  auto *Fn = llvm::Function::Create(FnTy, llvm::Function::ExternalLinkage,
+                                    Name, *Module);
+
+  unsigned Offset = 0;
+  if (ABI.SRetTy) {
+    Fn->getArg(0)->setName("agg.result");
+    Fn->addParamAttr(
+        0, llvm::Attribute::getWithStructRetType(Context, ABI.SRetTy));
+    Fn->addParamAttr(0, llvm::Attribute::NoAlias);
+    Fn->addParamAttr(0, llvm::Attribute::getWithAlignment(
+                            Context, llvm::Align(getTypeAlign(ABI.SRetTy))));
+    Offset = 1;
+    if (!IsWorker) {
+      ++NumSRetFunctions;
+    }
+  }
+
+  for (unsigned I = 0; I < Params.size(); ++I) {
+    Fn->getArg(I + Offset)->setName(Params[I]->getId());
+    llvm::Type *Ty = ABI.IndirectParams[I];
+    if (!Ty) {
+      continue;
+    }
+
+    unsigned ArgNo = I + Offset;
+    if (Params[I]->isConst()) {
+      Fn->addParamAttr(ArgNo, llvm::Attribute::NoAlias);
+      Fn->addParamAttr(ArgNo, llvm::Attribute::NoCapture);
+      Fn->addParamAttr(ArgNo, llvm::Attribute::ReadOnly);
+      Fn->addParamAttr(ArgNo, llvm::Attribute::getWithDereferenceableBytes(
+                                  Context, getTypeSize(Ty)));
+    } else {
+      Fn->addParamAttr(ArgNo, llvm::Attribute::getWithByValType(Context, Ty));
+    }
+    Fn->addParamAttr(ArgNo, llvm::Attribute::getWithAlignment(
+                                Context, llvm::Align(getTypeAlign(Ty))));
+    if (!IsWorker) {
+      ++NumIndirectParams;
+    }
+  }
+
+  FunctionABIs[Fn] = std::move(ABI);
+  addFunctionAttributes(Fn, Params, Exported);
+  return Fn;
+}
+
+void CodeGen::bindParams(llvm::ArrayRef<std::unique_ptr<ParamDecl>> Params,
+                         llvm::Function *Fn) {
+  const FunctionABI &ABI = FunctionABIs[Fn];
+  unsigned Offset = ABI.SRetTy ? 1 : 0;
+
+  for (unsigned I = 0; I < Params.size(); ++I) {
+    ParamDecl *P = Params[I].get();
+    llvm::Argument *Arg = Fn->getArg(I + Offset);
+    llvm::Type *Ty = I < ABI.IndirectParams.size() ? ABI.IndirectParams[I]
+                                                   : nullptr;
+
+    if (!Ty) {
+      // A const reference the body only reads fields through
+      if (P->isConst() && llvm::isa<RefTy>(P->getType().getPtr()) &&
+          !WrittenLocals.count(P)) {
+        Arg->addAttr(llvm::Attribute::NoCapture);
+        Arg->addAttr(llvm::Attribute::ReadOnly);
+      }
+      auto *Alloca = createEntryBlockAlloca(Fn, P->getId(), Arg->getType());
+      Builder.CreateStore(Arg, Alloca);
+      NamedValues[P] = Alloca;
+      continue;
+    }
+
+    // A byval copy belongs to the callee. The caller's storage behind a
+    // const parameter is only copied if the body writes to it anyway,
+    // which the type checker does not rule out yet.
+    if (!P->isConst() || !WrittenLocals.count(P)) {
+      NamedValues[P] = Arg;
+      continue;
+    }
+    auto *Alloca = createEntryBlockAlloca(Fn, P->getId(), Ty);
+    llvm::Align Align(getTypeAlign(Ty));
+    Builder.CreateMemCpy(Alloca, Align, Arg, Align, getTypeSize(Ty));
+    NamedValues[P] = Alloca;
+  }
+}
+
+void CodeGen::emitReturn(llvm::Value *V) {
+  if (llvm::Type *SRetTy = FunctionABIs[CurrentFunction].SRetTy) {
+    storeValue(coerceValue(V, SRetTy), CurrentFunction->getArg(0));
+    Builder.CreateRetVoid();
+    return;
+  }
+  Builder.CreateRet(coerceValue(V, CurrentFunction->getReturnType()));
+}
+
+llvm::Value *CodeGen::codegenArg(Expr *E, llvm::Function *Fn, unsigned Idx) {
+  const FunctionABI &ABI = FunctionABIs[Fn];
+  unsigned ArgNo = Idx + (ABI.SRetTy ? 1 : 0);
+  llvm::Type *Ty =
+      Idx < ABI.IndirectParams.size() ? ABI.IndirectParams[Idx] : nullptr;
+
+  if (!Ty) {
+    llvm::Value *Val = codegenExpr(E);
+    if (ArgNo < Fn->arg_size()) {
+      Val = coerceValue(Val, Fn->getArg(ArgNo)->getType());
+    }
+    return Val;
+  }
+
+  // A local is passed where it lives when the callee copies it, or when
+  // nothing writes it for the duration of the call
+  if (auto *DR = llvm::dyn_cast<DeclRefExpr>(E)) {
+    auto It = NamedValues.find(DR->getDecl());
+    bool Stable = Fn->getArg(ArgNo)->hasByValAttr() ||
+                  !WrittenLocals.count(DR->getDecl());
+    if (It != NamedValues.end() && Stable && getLLVMType(E->getType()) == Ty) {
+      return It->second;
+    }
+  }
+
+  llvm::Value *Val = coerceValue(codegenExpr(E), Ty);
+  if (isConstantTable(Val)) {
+    return getConstantGlobal(llvm::cast<llvm::Constant>(Val));
+  }
+  auto *Temp = createEntryBlockAlloca(CurrentFunction, "arg.tmp", Ty);
+  Builder.CreateStore(Val, Temp);
+  return Temp;
+}
+
+llvm::Value *CodeGen::emitCall(llvm::Function *Fn,
+                               std::vector<llvm::Value *> Args) {
+  llvm::Type *SRetTy = FunctionABIs[Fn].SRetTy;
+  llvm::AllocaInst *Result = nullptr;
+  if (SRetTy) {
+    Result = createEntryBlockAlloca(CurrentFunction, "sret.tmp", SRetTy);
+    Args.insert(Args.begin(), Result);
+  }
+
+  // The backend reads byval and sret from the call site
+  auto *Call = Builder.CreateCall(Fn, Args);
+  Call->setAttributes(Fn->getAttributes());
+  Call->setCallingConv(Fn->getCallingConv());
+  if (!Result) {
+    return Call;
+  }
+  return Builder.CreateLoad(SRetTy, Result);
+}
+
+#undef DEBUG_TYPE
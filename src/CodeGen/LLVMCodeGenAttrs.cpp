@@ -0,0 +1,96 @@
+#include "CodeGen/LLVMCodeGen.hpp"
+
+#include <llvm/ADT/Statistic.h>
+#include <llvm/Analysis/CGSCCPassManager.h>
+#include <llvm/Analysis/LoopAnalysisManager.h>
+#include <llvm/IR/Attributes.h>
+#include <llvm/IR/CallingConv.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Transforms/IPO/FunctionAttrs.h>
+
+#define DEBUG_TYPE "codegen"
+
+STATISTIC(NumInternalFunctions,
+          "Number of functions given internal linkage and fastcc");
+
+using namespace phi;
+
+//===----------------------------------------------------------------------===//
+// Phase 4: Linkage and Attributes
+//===----------------------------------------------------------------------===//
+
+// Only `public` items, and `main`, which the C runtime calls, are visible
+// outside the module. Everything else is internal, so it may use the fast
+// calling convention and is free to be inlined or dropped once unused. Phi
+// has no unwinding, so no function ever throws.
+
+bool CodeGen::isExported(const FunDecl *F) {
+  return F->getVisibility() == Visibility::Public || F->getId() == "main";
+}
+
+bool CodeGen::isExported(const MethodDecl *M) {
+  return M->getVisibility() == Visibility::Public &&
+         M->getParent()->getVisibility() == Visibility::Public;
+}
+
+void CodeGen::addFunctionAttributes(
+    llvm::Function *Fn, llvm::ArrayRef<std::unique_ptr<ParamDecl>> Params,
+    bool Exported) {
+  Fn->addFnAttr(llvm::Attribute::NoUnwind);
+  if (!Exported) {
+    Fn->setLinkage(llvm::Function::InternalLinkage);
+    Fn->setCallingConv(llvm::CallingConv::Fast);
+    if (!IsWorker) {
+      ++NumInternalFunctions;
+    }
+  }
+
+  // A reference always points at a live value of its pointee type
+  unsigned Offset = FunctionABIs[Fn].SRetTy ? 1 : 0;
+  for (unsigned I = 0; I < Params.size(); ++I) {
+    auto *Ref = llvm::dyn_cast<RefTy>(Params[I]->getType().getPtr());
+    if (!Ref) {
+      continue;
+    }
+    llvm::Type *Pointee = getLLVMType(Ref->getPointee());
+    if (!Pointee->isSized() || getTypeSize(Pointee) == 0) {
+      continue;
+    }
+    unsigned ArgNo = I + Offset;
+    Fn->addParamAttr(ArgNo, llvm::Attribute::NonNull);
+    Fn->addParamAttr(ArgNo, llvm::Attribute::getWithDereferenceableBytes(
+                                Context, getTypeSize(Pointee)));
+    Fn->addParamAttr(ArgNo, llvm::Attribute::getWithAlignment(
+                                Context, llvm::Align(getTypeAlign(Pointee))));
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Phase 5: Function Attribute Inference
+//===----------------------------------------------------------------------===//
+
+// With every body generated, LLVM's own analysis works out what the source
+// does not say: which functions never recurse, free or synchronize, what
+// memory they touch, and which pointer arguments they only read.
+void CodeGen::inferFunctionAttributes() {
+  llvm::LoopAnalysisManager LAM;
+  llvm::FunctionAnalysisManager FAM;
+  llvm::CGSCCAnalysisManager CGAM;
+  llvm::ModuleAnalysisManager MAM;
+
+  llvm::PassBuilder PB;
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  llvm::ModulePassManager MPM;
+  MPM.addPass(llvm::createModuleToPostOrderCGSCCPassAdaptor(
+      llvm::PostOrderFunctionAttrsPass()));
+  MPM.addPass(llvm::ReversePostOrderFunctionAttrsPass());
+  MPM.run(*Module, MAM);
+}
+
+#undef DEBUG_TYPE
@@ -0,0 +1,130 @@
+#include "CodeGen/LLVMCodeGen.hpp"
+
+#include <llvm/ADT/Statistic.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/GlobalVariable.h>
+
+#define DEBUG_TYPE "codegen"
+
+STATISTIC(NumConstantGlobals, "Number of constant aggregates made globals");
+
+using namespace phi;
+
+namespace {
+
+/// Collects the locals a body writes through, directly or through a field,
+/// tuple element or array element of theirs, and the references it lets
+/// escape
+class WrittenLocalsFinder : public RecursiveASTVisitor<WrittenLocalsFinder> {
+public:
+  explicit WrittenLocalsFinder(std::unordered_set<const Decl *> &Written)
+      : Written(Written) {}
+
+  using RecursiveASTVisitor::visit;
+
+  void visit(BinaryOp &E) {
+    switch (E.getOp()) {
+    case TokenKind::Equals:
+    case TokenKind::PlusEquals:
+    case TokenKind::SubEquals:
+    case TokenKind::MulEquals:
+    case TokenKind::DivEquals:
+    case TokenKind::ModEquals:
+      markRoot(&E.getLhs());
+      break;
+    default:
+      break;
+    }
+    RecursiveASTVisitor::visit(E);
+  }
+
+  void visit(UnaryOp &E) {
+    if (E.getOp() == TokenKind::DoublePlus ||
+        E.getOp() == TokenKind::DoubleMinus) {
+      markRoot(&E.getOperand());
+    }
+    RecursiveASTVisitor::visit(E);
+  }
+
+  // A method may take its receiver by reference and write through it
+  void visit(MethodCallExpr &E) {
+    markRoot(E.getBase());
+    RecursiveASTVisitor::visit(E);
+  }
+
+  // Reading a field through a reference leaves the referent alone. Any
+  // other use hands the reference on, and it may be written through there.
+  void visit(FieldAccessExpr &E) {
+    if (!llvm::isa<DeclRefExpr>(E.getBase())) {
+      RecursiveASTVisitor::visit(E);
+    }
+  }
+
+  void visit(DeclRefExpr &E) {
+    if (llvm::isa<RefTy, PtrTy>(E.getType().getPtr())) {
+      Written.insert(E.getDecl());
+    }
+  }
+
+private:
+  void markRoot(Expr *E) {
+    while (true) {
+      if (auto *FA = llvm::dyn_cast<FieldAccessExpr>(E)) {
+        E = FA->getBase();
+      } else if (auto *TI = llvm::dyn_cast<TupleIndex>(E)) {
+        E = TI->getBase();
+      } else if (auto *AI = llvm::dyn_cast<ArrayIndex>(E)) {
+        E = AI->getBase();
+      } else {
+        break;
+      }
+    }
+    if (auto *DR = llvm::dyn_cast<DeclRefExpr>(E)) {
+      Written.insert(DR->getDecl());
+    }
+  }
+
+  std::unordered_set<const Decl *> &Written;
+};
+
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// Phase 4: Constant Aggregates
+//===----------------------------------------------------------------------===//
+
+// Lookup tables and coefficient arrays are written as literals whose
+// elements are all constants. Such a literal is kept once in a read-only
+// global: a local that is never written refers to the global directly, and
+// one that is written starts as a memcpy of it. Small aggregates are cheaper
+// to store directly and are left alone.
+
+void CodeGen::collectWrittenLocals(Block &Body) {
+  WrittenLocals.clear();
+  WrittenLocalsFinder(WrittenLocals).visit(Body);
+}
+
+bool CodeGen::isConstantTable(llvm::Value *V) {
+  auto *C = llvm::dyn_cast<llvm::Constant>(V);
+  if (!C || !C->getType()->isAggregateType() ||
+      llvm::isa<llvm::UndefValue>(C) || C->isNullValue()) {
+    return false;
+  }
+  return getTypeSize(C->getType()) > 16;
+}
+
+llvm::GlobalVariable *CodeGen::getConstantGlobal(llvm::Constant *C) {
+  auto &GV = ConstantGlobals[C];
+  if (!GV) {
+    GV = new llvm::GlobalVariable(*Module, C->getType(), /*isConstant=*/true,
+                                  llvm::GlobalValue::PrivateLinkage, C,
+                                  "const");
+    GV->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    GV->setAlignment(llvm::Align(getTypeAlign(C->getType())));
+    ++NumConstantGlobals;
+  }
+  return GV;
+}
+
+#undef DEBUG_TYPE
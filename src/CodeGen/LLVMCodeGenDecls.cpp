@@ -24,6 +24,10 @@ void CodeGen::codegenModule(ModuleDecl *M) {
 
 void CodeGen::declareStructTypes(ModuleDecl *M) {
   for (auto &Item : M->getItems()) {
+    if (!Item->isReachable()) {
+      continue;
+    }
+
     if (auto *S = llvm::dyn_cast<StructDecl>(Item.get())) {
       if (!S->hasTypeArgs()) {
         getOrCreateStructType(S);
@@ -34,6 +38,10 @@ void CodeGen::declareStructTypes(ModuleDecl *M) {
 
 void CodeGen::declareEnumTypes(ModuleDecl *M) {
   for (auto &Item : M->getItems()) {
+    if (!Item->isReachable()) {
+      continue;
+    }
+
     if (auto *E = llvm::dyn_cast<EnumDecl>(Item.get())) {
       if (!E->hasTypeArgs()) {
         getOrCreateEnumType(E);
@@ -44,6 +52,10 @@ void CodeGen::declareEnumTypes(ModuleDecl *M) {
 
 void CodeGen::declareFunctions(ModuleDecl *M) {
   for (auto &Item : M->getItems()) {
+    if (!Item->isReachable()) {
+      continue;
+    }
+
     if (auto *F = llvm::dyn_cast<FunDecl>(Item.get())) {
       if (!F->hasTypeArgs()) {
         codegenFunctionDecl(F);
@@ -68,6 +80,10 @@ void CodeGen::declareFunctions(ModuleDecl *M) {
 
 void CodeGen::generateFunctionBodies(ModuleDecl *M) {
   for (auto &Item : M->getItems()) {
+    if (!Item->isReachable()) {
+      continue;
+    }
+
     if (auto *F = llvm::dyn_cast<FunDecl>(Item.get())) {
       if (!F->hasTypeArgs()) {
         auto It = Functions.find(F);
@@ -98,56 +114,17 @@ void CodeGen::generateFunctionBodies(ModuleDecl *M) {
 }
 
 llvm::Function *CodeGen::codegenFunctionDecl(FunDecl *F) {
-  // Build parameter types
-  std::vector<llvm::Type *> ParamTypes;
-  for (const auto &P : F->getParams()) {
-    ParamTypes.push_back(getLLVMType(P->getType()));
-  }
-
-  // Get return type
-  llvm::Type *RetTy = getLLVMType(F->getReturnType());
-
-  // Create function type
-  auto *FnTy = llvm::FunctionType::get(RetTy, ParamTypes, false);
-
-  // Create function
-  auto *Fn = llvm::Function::Create(FnTy, llvm::Function::ExternalLinkage,
-                                    F->getId(), Module);
-
-  // Name parameters
-  unsigned Idx = 0;
-  for (auto &Arg : Fn->args()) {
-    Arg.setName(F->getParams()[Idx++]->getId());
-  }
-
+  auto *Fn = createLoweredFunction(F->getId(), F->getParams(),
+                                   F->getReturnType(), isExported(F));
   Functions[F] = Fn;
   return Fn;
 }
 
 llvm::Function *CodeGen::codegenMethodDecl(MethodDecl *M,
                                            const std::string &MangledName) {
-  // Build parameter types (including 'this' as first param)
-  std::vector<llvm::Type *> ParamTypes;
-  for (const auto &P : M->getParams()) {
-    ParamTypes.push_back(getLLVMType(P->getType()));
-  }
-
-  // Get return type
-  llvm::Type *RetTy = getLLVMType(M->getReturnType());
-
-  // Create function type
-  auto *FnTy = llvm::FunctionType::get(RetTy, ParamTypes, false);
-
-  // Create function
-  auto *Fn = llvm::Function::Create(FnTy, llvm::Function::ExternalLinkage,
-                                    MangledName, Module);
-
-  // Name parameters
-  unsigned Idx = 0;
-  for (auto &Arg : Fn->args()) {
-    Arg.setName(M->getParams()[Idx++]->getId());
-  }
-
+  // 'this' is the first parameter
+  auto *Fn = createLoweredFunction(MangledName, M->getParams(),
+                                   M->getReturnType(), isExported(M));
   Methods[M] = Fn;
   return Fn;
 }
@@ -165,7 +142,7 @@ void CodeGen::codegenFunctionBody(FunDecl *F, llvm::Function *Fn) {
     llvm::FunctionType *PrintfTy = llvm::FunctionType::get(
         Builder.getInt32Ty(), {Builder.getPtrTy()}, true);
     llvm::FunctionCallee Printf =
-        Module.getOrInsertFunction("printf", PrintfTy);
+        Module->getOrInsertFunction("printf", PrintfTy);
 
     // Get argument
     llvm::Argument *Arg = Fn->getArg(0);
@@ -197,14 +174,8 @@ void CodeGen::codegenFunctionBody(FunDecl *F, llvm::Function *Fn) {
   NamedValues.clear();
 
   // Allocate and store parameters
-  unsigned Idx = 0;
-  for (auto &Arg : Fn->args()) {
-    auto *P = F->getParams()[Idx++].get();
-    llvm::Type *Ty = Arg.getType();
-    auto *Alloca = createEntryBlockAlloca(Fn, P->getId(), Ty);
-    Builder.CreateStore(&Arg, Alloca);
-    NamedValues[P] = Alloca;
-  }
+  collectWrittenLocals(F->getBody());
+  bindParams(F->getParams(), Fn);
 
   // Generate body
   codegenBlock(&F->getBody());
@@ -230,14 +201,8 @@ void CodeGen::codegenMethodBody(MethodDecl *M, llvm::Function *Fn) {
 
   NamedValues.clear();
 
-  unsigned Idx = 0;
-  for (auto &Arg : Fn->args()) {
-    auto *P = M->getParams()[Idx++].get();
-    llvm::Type *Ty = Arg.getType();
-    auto *Alloca = createEntryBlockAlloca(Fn, P->getId(), Ty);
-    Builder.CreateStore(&Arg, Alloca);
-    NamedValues[P] = Alloca;
-  }
+  collectWrittenLocals(M->getBody());
+  bindParams(M->getParams(), Fn);
 
   codegenBlock(&M->getBody());
 
@@ -16,50 +16,21 @@ llvm::Value *CodeGen::codegenExpr(Expr *E) {
   if (!E)
     return llvm::Constant::getNullValue(Builder.getInt32Ty());
 
-  if (auto *IL = llvm::dyn_cast<IntLiteral>(E))
-    return codegenIntLiteral(IL);
-  if (auto *FL = llvm::dyn_cast<FloatLiteral>(E))
-    return codegenFloatLiteral(FL);
-  if (auto *BL = llvm::dyn_cast<BoolLiteral>(E))
-    return codegenBoolLiteral(BL);
-  if (auto *SL = llvm::dyn_cast<StrLiteral>(E))
-    return codegenStrLiteral(SL);
-  if (auto *CL = llvm::dyn_cast<CharLiteral>(E))
-    return codegenCharLiteral(CL);
-  if (auto *TL = llvm::dyn_cast<TupleLiteral>(E))
-    return codegenTupleLiteral(TL);
-  if (auto *DR = llvm::dyn_cast<DeclRefExpr>(E))
-    return codegenDeclRef(DR);
-  if (auto *FC = llvm::dyn_cast<FunCallExpr>(E))
-    return codegenFunCall(FC);
-  if (auto *MC = llvm::dyn_cast<MethodCallExpr>(E))
-    return codegenMethodCall(MC);
-  if (auto *BO = llvm::dyn_cast<BinaryOp>(E))
-    return codegenBinaryOp(BO);
-  if (auto *UO = llvm::dyn_cast<UnaryOp>(E))
-    return codegenUnaryOp(UO);
-  if (auto *AI = llvm::dyn_cast<AdtInit>(E))
-    return codegenAdtInit(AI);
-  if (auto *FA = llvm::dyn_cast<FieldAccessExpr>(E))
-    return codegenFieldAccess(FA);
-  if (auto *IE = llvm::dyn_cast<TupleIndex>(E))
-    return codegenTupleIndex(IE);
-  if (auto *ME = llvm::dyn_cast<MatchExpr>(E))
-    return codegenMatchExpr(ME);
-  if (auto *IC = llvm::dyn_cast<IntrinsicCall>(E))
-    return codegenIntrinsicCall(IC);
-
-  if (auto *AE = llvm::dyn_cast<ArrayIndex>(E))
-    return codegenArrayIndex(AE);
-  if (auto *AL = llvm::dyn_cast<ArrayLiteral>(E))
-    return codegenArrayLiteral(AL);
-  if (auto *CE = llvm::dyn_cast<CastExpr>(E))
-    return codegenCastExpr(CE);
-
-  return llvm::Constant::getNullValue(Builder.getInt32Ty());
+  return dispatch(*E,
+                  [this](auto &X) -> llvm::Value * { return codegen(&X); });
 }
 
-llvm::Value *CodeGen::codegenIntLiteral(IntLiteral *E) {
+// Ranges and member initializers are lowered by the `for` or ADT initializer
+// that owns them, never on their own
+llvm::Value *CodeGen::codegen(RangeLiteral * /*E*/) {
+  llvm_unreachable("range lowered outside its for loop");
+}
+
+llvm::Value *CodeGen::codegen(MemberInit * /*E*/) {
+  llvm_unreachable("member initializer lowered outside its ADT initializer");
+}
+
+llvm::Value *CodeGen::codegen(IntLiteral *E) {
   int64_t Val = E->getValue();
   // Check type and return appropriate sized int
   if (E->getType().getPtr()) {
@@ -83,7 +54,7 @@ llvm::Value *CodeGen::codegenIntLiteral(IntLiteral *E) {
   return Builder.getInt64(Val);
 }
 
-llvm::Value *CodeGen::codegenFloatLiteral(FloatLiteral *E) {
+llvm::Value *CodeGen::codegen(FloatLiteral *E) {
   double Val = E->getValue();
   if (E->getType().getPtr()) {
     auto *BT = llvm::dyn_cast<BuiltinTy>(E->getType().getPtr());
@@ -94,19 +65,19 @@ llvm::Value *CodeGen::codegenFloatLiteral(FloatLiteral *E) {
   return llvm::ConstantFP::get(Builder.getDoubleTy(), Val);
 }
 
-llvm::Value *CodeGen::codegenBoolLiteral(BoolLiteral *E) {
+llvm::Value *CodeGen::codegen(BoolLiteral *E) {
   return Builder.getInt1(E->getValue());
 }
 
-llvm::Value *CodeGen::codegenStrLiteral(StrLiteral *E) {
+llvm::Value *CodeGen::codegen(StrLiteral *E) {
   return Builder.CreateGlobalStringPtr(E->getValue());
 }
 
-llvm::Value *CodeGen::codegenCharLiteral(CharLiteral *E) {
+llvm::Value *CodeGen::codegen(CharLiteral *E) {
   return Builder.getInt8(E->getValue());
 }
 
-llvm::Value *CodeGen::codegenTupleLiteral(TupleLiteral *E) {
+llvm::Value *CodeGen::codegen(TupleLiteral *E) {
   std::vector<llvm::Value *> Elements;
   std::vector<llvm::Type *> ElemTypes;
   for (auto &Elem : E->getElements()) {
@@ -123,7 +94,7 @@ llvm::Value *CodeGen::codegenTupleLiteral(TupleLiteral *E) {
   return Tuple;
 }
 
-llvm::Value *CodeGen::codegenDeclRef(DeclRefExpr *E) {
+llvm::Value *CodeGen::codegen(DeclRefExpr *E) {
   auto It = NamedValues.find(E->getDecl());
   if (It != NamedValues.end()) {
     llvm::Type *Ty = getLLVMType(E->getType());
@@ -132,7 +103,7 @@ llvm::Value *CodeGen::codegenDeclRef(DeclRefExpr *E) {
   return llvm::Constant::getNullValue(getLLVMType(E->getType()));
 }
 
-llvm::Value *CodeGen::codegenFunCall(FunCallExpr *E) {
+llvm::Value *CodeGen::codegen(FunCallExpr *E) {
   // Get function
   FunDecl *Callee = E->getDecl();
   if (!Callee)
@@ -149,7 +120,7 @@ llvm::Value *CodeGen::codegenFunCall(FunCallExpr *E) {
   if (E->hasTypeArgs()) {
     std::string MonoName =
         generateMonomorphizedName(Callee->getId(), E->getTypeArgs());
-    Fn = Module.getFunction(MonoName);
+    Fn = Module->getFunction(MonoName);
   } else if (!Callee->getTypeArgs().empty()) {
     // If it's a generic function but no args provided, it might have been
     // monomorphized already This happens with inferred types or when called
@@ -169,7 +140,7 @@ llvm::Value *CodeGen::codegenFunCall(FunCallExpr *E) {
 
   if (!Fn) {
     // Fallback: search by name
-    Fn = Module.getFunction(Callee->getId());
+    Fn = Module->getFunction(Callee->getId());
   }
 
   if (!Fn) {
@@ -179,13 +150,13 @@ llvm::Value *CodeGen::codegenFunCall(FunCallExpr *E) {
   // Generate arguments
   std::vector<llvm::Value *> Args;
   for (auto &Arg : E->getArgs()) {
-    Args.push_back(codegenExpr(Arg.get()));
+    Args.push_back(codegenArg(Arg.get(), Fn, Args.size()));
   }
 
-  return Builder.CreateCall(Fn, Args);
+  return emitCall(Fn, std::move(Args));
 }
 
-llvm::Value *CodeGen::codegenMethodCall(MethodCallExpr *E) {
+llvm::Value *CodeGen::codegen(MethodCallExpr *E) {
   // Transform: obj.method(args) -> method(obj, args)
   MethodDecl *Method = &E->getMethod();
 
@@ -197,29 +168,35 @@ llvm::Value *CodeGen::codegenMethodCall(MethodCallExpr *E) {
     if (E->hasTypeArgs()) {
       MonoName = generateMonomorphizedName(MonoName, E->getTypeArgs());
     }
-    Fn = Module.getFunction(MonoName);
+    Fn = Module->getFunction(MonoName);
   }
 
-  // Generic Struct Method Resolution
-  if (!Fn && E->getBase()) {
-    TypeRef BaseTy = E->getBase()->getType();
-    while (true) {
-      if (auto *RT = llvm::dyn_cast<RefTy>(BaseTy.getPtr()))
-        BaseTy = RT->getPointee();
-      else if (auto *PT = llvm::dyn_cast<PtrTy>(BaseTy.getPtr()))
-        BaseTy = PT->getPointee();
-      else
-        break;
-    }
+  // Generic ADT methods are instantiated for the receiver's type arguments on
+  // their first call. Inside a monomorphized body the receiver may still name
+  // the enclosing type parameters, so substitute them first.
+  if (!Fn && E->getBase() && Method->getParent()->hasTypeArgs()) {
+    std::vector<TypeRef> ParentArgs;
+    TypeRef BaseTy = E->getBase()->getType().removeIndir();
     if (auto *AppTy = llvm::dyn_cast<AppliedTy>(BaseTy.getPtr())) {
-      if (auto *Adt = llvm::dyn_cast<AdtTy>(AppTy->getBase().getPtr())) {
-        std::string ParentName = Adt->getId();
-        std::string MonoParent =
-            generateMonomorphizedName(ParentName, AppTy->getArgs());
-        std::string MonoMethod = MonoParent + "_" + Method->getId();
-        Fn = Module.getFunction(MonoMethod);
+      for (const auto &Arg : AppTy->getArgs()) {
+        ParentArgs.push_back(substituteType(Arg, CurrentSubs));
+      }
+    } else if (llvm::isa<AdtTy>(BaseTy.getPtr())) {
+      for (const auto &Param : Method->getParent()->getTypeArgs()) {
+        auto It = CurrentSubs.find(Param.get());
+        if (It == CurrentSubs.end()) {
+          ParentArgs.clear();
+          break;
+        }
+        ParentArgs.push_back(It->second);
       }
     }
+
+    bool Concrete = llvm::none_of(
+        ParentArgs, [this](TypeRef T) { return hasGenericType(T); });
+    if (!ParentArgs.empty() && Concrete) {
+      Fn = getOrMonomorphizeMethod(Method, ParentArgs);
+    }
   }
 
   if (!Fn) {
@@ -271,7 +248,7 @@ llvm::Value *CodeGen::codegenMethodCall(MethodCallExpr *E) {
       }
     }
   } else {
-    BaseVal = codegenExpr(E->getBase());
+    BaseVal = codegenArg(E->getBase(), Fn, 0);
   }
 
   if (BaseVal)
@@ -282,19 +259,20 @@ llvm::Value *CodeGen::codegenMethodCall(MethodCallExpr *E) {
 
   // Remaining arguments
   for (auto &Arg : E->getArgs()) {
-    Args.push_back(codegenExpr(Arg.get()));
+    Args.push_back(codegenArg(Arg.get(), Fn, Args.size()));
   }
 
-  return Builder.CreateCall(Fn, Args);
+  return emitCall(Fn, std::move(Args));
 }
 
-llvm::Value *CodeGen::codegenBinaryOp(BinaryOp *E) {
+llvm::Value *CodeGen::codegen(BinaryOp *E) {
   // Handle assignment specially
   if (E->getOp() == TokenKind::Equals) {
     llvm::Value *Rhs = codegenExpr(&E->getRhs());
     llvm::Value *LhsPtr = getLValuePtr(&E->getLhs());
+    Rhs = coerceValue(Rhs, E->getLhs().getType());
     if (LhsPtr) {
-      Builder.CreateStore(Rhs, LhsPtr);
+      storeValue(Rhs, LhsPtr);
       return Rhs;
     }
     return Rhs;
@@ -344,7 +322,7 @@ llvm::Value *CodeGen::codegenBinaryOp(BinaryOp *E) {
   }
 }
 
-llvm::Value *CodeGen::codegenUnaryOp(UnaryOp *E) {
+llvm::Value *CodeGen::codegen(UnaryOp *E) {
   llvm::Value *Operand = codegenExpr(&E->getOperand());
   switch (E->getOp()) {
   case TokenKind::Minus:
@@ -359,7 +337,7 @@ llvm::Value *CodeGen::codegenUnaryOp(UnaryOp *E) {
   }
 }
 
-llvm::Value *CodeGen::codegenAdtInit(AdtInit *E) {
+llvm::Value *CodeGen::codegen(AdtInit *E) {
   const AdtDecl *Decl = E->getDecl();
   if (!Decl) {
     if (auto *AT = llvm::dyn_cast<AdtTy>(E->getType().getPtr())) {
@@ -388,23 +366,42 @@ llvm::Value *CodeGen::codegenStructInit(AdtInit *E, const StructDecl *S) {
   if (!StructTy)
     return llvm::Constant::getNullValue(Builder.getInt32Ty());
 
-  // Create alloca for struct
-  auto *Alloca =
-      createEntryBlockAlloca(CurrentFunction, generateTempVar(), StructTy);
-
-  // Initialize fields
+  // Evaluate fields in source order
+  auto &Indices = FieldIndices[StructName];
+  std::vector<std::pair<unsigned, llvm::Value *>> Fields;
   for (auto &Init : E->getInits()) {
-    const std::string &FieldName = Init->getId();
-    auto FieldIt = FieldIndices[StructName].find(FieldName);
-    if (FieldIt != FieldIndices[StructName].end()) {
+    auto FieldIt = Indices.find(Init->getIdentifier());
+    if (FieldIt != Indices.end()) {
       unsigned FieldIdx = FieldIt->second;
-      llvm::Value *FieldPtr =
-          Builder.CreateStructGEP(StructTy, Alloca, FieldIdx);
       llvm::Value *Val = codegenExpr(Init->getInitValue());
-      Builder.CreateStore(Val, FieldPtr);
+      Fields.push_back(
+          {FieldIdx, coerceValue(Val, StructTy->getElementType(FieldIdx))});
     }
   }
 
+  // A literal made only of constants is a constant itself; padding members
+  // stay zero
+  bool AllConstant = Fields.size() == Indices.size() &&
+                     llvm::all_of(Fields, [](const auto &Field) {
+                       return llvm::isa<llvm::Constant>(Field.second);
+                     });
+  if (AllConstant) {
+    std::vector<llvm::Constant *> Members;
+    for (auto *Ty : StructTy->elements()) {
+      Members.push_back(llvm::Constant::getNullValue(Ty));
+    }
+    for (auto [FieldIdx, Val] : Fields) {
+      Members[FieldIdx] = llvm::cast<llvm::Constant>(Val);
+    }
+    return llvm::ConstantStruct::get(StructTy, Members);
+  }
+
+  auto *Alloca =
+      createEntryBlockAlloca(CurrentFunction, generateTempVar(), StructTy);
+  for (auto [FieldIdx, Val] : Fields) {
+    storeValue(Val, Builder.CreateStructGEP(StructTy, Alloca, FieldIdx));
+  }
+
   return Builder.CreateLoad(StructTy, Alloca);
 }
 
@@ -438,27 +435,46 @@ llvm::Value *CodeGen::codegenEnumInit(AdtInit *E, const EnumDecl *En) {
   auto *Alloca =
       createEntryBlockAlloca(CurrentFunction, generateTempVar(), EnumTy);
 
-  // Store discriminant
-  auto *DiscPtr = Builder.CreateStructGEP(EnumTy, Alloca, 0);
-  Builder.CreateStore(Builder.getInt32(Discriminant), DiscPtr);
+  // Store the discriminant, in the tag or in the payload's niche
+  const EnumLayout &Layout = EnumLayouts[EnumName];
+  if (Layout.TagTy) {
+    auto *DiscPtr = Builder.CreateStructGEP(EnumTy, Alloca, 0);
+    Builder.CreateStore(llvm::ConstantInt::get(Layout.TagTy, Discriminant),
+                        DiscPtr);
+  } else if (Discriminant != Layout.DataDiscriminant) {
+    const Niche &N = *Layout.DiscNiche;
+    llvm::Constant *NicheVal =
+        N.Ty->isPointerTy()
+            ? llvm::Constant::getNullValue(N.Ty)
+            : llvm::ConstantInt::get(N.Ty, Layout.NicheValues.at(Discriminant));
+    Builder.CreateStore(NicheVal, getNichePtr(EnumTy, Alloca, N));
+  }
 
   // Store payload if present
   auto PayloadIt = VariantPayloadTypes[EnumName].find(VariantName);
   if (PayloadIt != VariantPayloadTypes[EnumName].end() &&
       !E->getInits().empty()) {
     llvm::Type *PayloadTy = PayloadIt->second;
-    auto *PayloadPtr = Builder.CreateStructGEP(EnumTy, Alloca, 1);
+    auto *PayloadPtr =
+        Builder.CreateStructGEP(EnumTy, Alloca, Layout.PayloadField);
     auto *TypedPayloadPtr =
         Builder.CreateBitCast(PayloadPtr, PayloadTy->getPointerTo());
     llvm::Value *PayloadVal = codegenExpr(E->getInits()[0]->getInitValue());
-    Builder.CreateStore(PayloadVal, TypedPayloadPtr);
+    PayloadVal = coerceValue(PayloadVal, PayloadTy);
+    if (!Layout.TagTy && EnumTy->getElementType(0) != PayloadTy) {
+      PayloadVal = Builder.CreateZExt(PayloadVal, EnumTy->getElementType(0));
+    }
+    storeValue(PayloadVal, TypedPayloadPtr);
   }
 
   return Builder.CreateLoad(EnumTy, Alloca);
 }
 
-llvm::Value *CodeGen::codegenFieldAccess(FieldAccessExpr *E) {
-  llvm::Value *BasePtr = getLValuePtr(E->getBase());
+llvm::Value *CodeGen::codegen(FieldAccessExpr *E) {
+  // A reference, such as `this`, already holds the struct's address
+  bool ThroughRef = llvm::isa<RefTy>(E->getBase()->getType().getPtr());
+  llvm::Value *BasePtr = ThroughRef ? codegenExpr(E->getBase())
+                                    : getLValuePtr(E->getBase());
   if (!BasePtr) {
     // Base is not an lvalue, compute it
     BasePtr = codegenExpr(E->getBase());
@@ -483,7 +499,7 @@ llvm::Value *CodeGen::codegenFieldAccess(FieldAccessExpr *E) {
   const FieldDecl *Field = E->getField();
   auto It = FieldIndices.find(StructName);
   if (It != FieldIndices.end()) {
-    auto FieldIt = It->second.find(Field->getId());
+    auto FieldIt = It->second.find(Field->getIdentifier());
     if (FieldIt != It->second.end()) {
       llvm::Type *StructTy = StructTypes[StructName];
       auto *FieldPtr =
@@ -495,7 +511,7 @@ llvm::Value *CodeGen::codegenFieldAccess(FieldAccessExpr *E) {
   return llvm::Constant::getNullValue(getLLVMType(E->getType()));
 }
 
-llvm::Value *CodeGen::codegenTupleIndex(TupleIndex *E) {
+llvm::Value *CodeGen::codegen(TupleIndex *E) {
   llvm::Value *BasePtr = getLValuePtr(E->getBase());
   if (!BasePtr)
     return llvm::Constant::getNullValue(getLLVMType(E->getType()));
@@ -505,7 +521,7 @@ llvm::Value *CodeGen::codegenTupleIndex(TupleIndex *E) {
   return Builder.CreateLoad(getLLVMType(E->getType()), ElemPtr);
 }
 
-llvm::Value *CodeGen::codegenIntrinsicCall(IntrinsicCall *E) {
+llvm::Value *CodeGen::codegen(IntrinsicCall *E) {
   switch (E->getIntrinsicKind()) {
   case IntrinsicCall::IntrinsicKind::Panic: {
     // Evaluate message
@@ -519,7 +535,7 @@ llvm::Value *CodeGen::codegenIntrinsicCall(IntrinsicCall *E) {
       declarePrintln();
 
     // Declare abort
-    llvm::FunctionCallee AbortFn = Module.getOrInsertFunction(
+    llvm::FunctionCallee AbortFn = Module->getOrInsertFunction(
         "abort", llvm::FunctionType::get(Builder.getVoidTy(), false));
 
     // Print "Panic: "
@@ -576,7 +592,7 @@ llvm::Value *CodeGen::codegenIntrinsicCall(IntrinsicCall *E) {
     // Declare printf/abort
     if (!PrintFn)
       declarePrintln();
-    llvm::FunctionCallee AbortFn = Module.getOrInsertFunction(
+    llvm::FunctionCallee AbortFn = Module->getOrInsertFunction(
         "abort", llvm::FunctionType::get(Builder.getVoidTy(), false));
 
     llvm::Value *Msg = Builder.CreateGlobalStringPtr("Assertion failed\n");
@@ -617,7 +633,7 @@ llvm::Value *CodeGen::codegenCastToString(llvm::Value *Val,
       Builder.getInt32Ty(),
       {Builder.getPtrTy(), Builder.getInt64Ty(), Builder.getPtrTy()}, true);
   llvm::FunctionCallee SnprintfFn =
-      Module.getOrInsertFunction("snprintf", SnprintfTy);
+      Module->getOrInsertFunction("snprintf", SnprintfTy);
 
   // Allocate a buffer on the stack (64 bytes is enough for any primitive)
   auto *BufTy = llvm::ArrayType::get(Builder.getInt8Ty(), 64);
@@ -677,7 +693,7 @@ llvm::Value *CodeGen::codegenCastToString(llvm::Value *Val,
   return BufPtr;
 }
 
-llvm::Value *CodeGen::codegenCastExpr(CastExpr *E) {
+llvm::Value *CodeGen::codegen(CastExpr *E) {
   llvm::Value *Val = codegenExpr(E->getFrom());
 
   auto *FromBT =
@@ -778,464 +794,16 @@ llvm::Value *CodeGen::codegenCastExpr(CastExpr *E) {
   return Val;
 }
 
-//===----------------------------------------------------------------------===//
-// Phase 4: Match Expression Codegen
-//===----------------------------------------------------------------------===//
-
-llvm::Value *CodeGen::codegenMatchExpr(MatchExpr *E) {
-  llvm::Value *Scrutinee = codegenExpr(E->getScrutinee());
-  TypeRef ASTType = E->getScrutinee()->getType();
-  while (true) {
-    if (auto *RT = llvm::dyn_cast<RefTy>(ASTType.getPtr())) {
-      ASTType = RT->getPointee();
-    } else if (auto *PT = llvm::dyn_cast<PtrTy>(ASTType.getPtr())) {
-      ASTType = PT->getPointee();
-    } else {
-      break;
-    }
-  }
-  llvm::Type *ScrutineeTy = getLLVMType(ASTType);
-  llvm::Value *ScrutineeAlloca = Scrutinee;
-
-  // Handles pointer to struct (opaque)
-  if (Scrutinee->getType()->isPointerTy()) {
-    if (llvm::isa<llvm::StructType>(ScrutineeTy)) {
-      ScrutineeAlloca = Scrutinee;
-    } else {
-      ScrutineeAlloca =
-          createEntryBlockAlloca(CurrentFunction, "scrutinee", ScrutineeTy);
-      Builder.CreateStore(Scrutinee, ScrutineeAlloca);
-    }
-  } else {
-    ScrutineeAlloca =
-        createEntryBlockAlloca(CurrentFunction, "scrutinee", ScrutineeTy);
-    Builder.CreateStore(Scrutinee, ScrutineeAlloca);
-  }
-
-  auto *StartBB = Builder.GetInsertBlock();
-  auto *MergeBB =
-      llvm::BasicBlock::Create(Context, "match.end", CurrentFunction);
-  auto *FailBB =
-      llvm::BasicBlock::Create(Context, "match.fail", CurrentFunction);
-
-  // PHI for result
-  llvm::Type *ResultTy = getLLVMType(E->getType());
-  llvm::PHINode *ResultPHI = nullptr;
-  if (!ResultTy->isVoidTy()) {
-    Builder.SetInsertPoint(MergeBB);
-    ResultPHI =
-        Builder.CreatePHI(ResultTy, E->getArms().size() + 1, "match.result");
-  }
-
-  // --- Attempt Switch Optimization ---
-  bool CanUseSwitch = true;
-  bool HasWildcard = false;
-
-  // Check scrutinee type
-  bool IsEnum = false;
-  bool IsInteger = ScrutineeTy->isIntegerTy();
-  std::string EnumName;
-
-  if (auto *ST = llvm::dyn_cast<llvm::StructType>(ScrutineeTy)) {
-    if (ST->hasName()) {
-      EnumName = ST->getName().str();
-      if (VariantDiscriminants.count(EnumName)) {
-        IsEnum = true;
-      }
-    }
-  }
-
-  if (!IsEnum && !IsInteger)
-    CanUseSwitch = false;
-
-  // Check arms
-  for (size_t I = 0; I < E->getArms().size(); ++I) {
-    if (HasWildcard) {
-      // Wildcard must be last
-      CanUseSwitch = false;
-      break;
-    }
-
-    const auto &Arm = E->getArms()[I];
-    if (Arm.Patterns.empty()) {
-      HasWildcard = true; // Fallback "else"
-      continue;
-    }
-
-    for (const auto &Pat : Arm.Patterns) {
-      if (std::holds_alternative<PatternAtomics::Wildcard>(Pat)) {
-        HasWildcard = true;
-        // If mixed with other patterns or not last arm, abort switch
-        if (Arm.Patterns.size() > 1 || I != E->getArms().size() - 1) {
-          CanUseSwitch = false;
-        }
-        break;
-      }
-      if (std::holds_alternative<PatternAtomics::Literal>(Pat)) {
-        if (!IsInteger) {
-          CanUseSwitch = false;
-          break;
-        }
-      } else if (std::holds_alternative<PatternAtomics::Variant>(Pat)) {
-        if (!IsEnum) {
-          CanUseSwitch = false;
-          break;
-        }
-      } else {
-        CanUseSwitch = false;
-        break;
-      }
-    }
-    if (!CanUseSwitch)
-      break;
-  }
-
-  if (CanUseSwitch && (IsEnum || IsInteger)) {
-    Builder.SetInsertPoint(StartBB);
-
-    llvm::Value *SwitchVal = nullptr;
-    if (IsInteger) {
-      SwitchVal = Builder.CreateLoad(ScrutineeTy, ScrutineeAlloca);
-    } else {
-      // Load discriminant
-      auto *DiscPtr = Builder.CreateStructGEP(
-          llvm::cast<llvm::StructType>(ScrutineeTy), ScrutineeAlloca, 0);
-      SwitchVal = Builder.CreateLoad(Builder.getInt32Ty(), DiscPtr);
-    }
-
-    llvm::BasicBlock *DefaultBB = FailBB;
-
-    // We will create the switch inst at the end
-
-    // Generate bodies and Collect cases
-    std::vector<std::pair<llvm::ConstantInt *, llvm::BasicBlock *>> Cases;
-
-    for (const auto &Arm : E->getArms()) {
-      llvm::BasicBlock *ArmBB = llvm::BasicBlock::Create(
-          Context, "match.arm", CurrentFunction, FailBB);
-
-      bool IsWildcardArm = false;
-      // Add cases
-      if (Arm.Patterns.empty()) {
-        IsWildcardArm = true;
-      } else {
-        for (const auto &Pat : Arm.Patterns) {
-          if (std::holds_alternative<PatternAtomics::Wildcard>(Pat)) {
-            IsWildcardArm = true;
-            continue;
-          }
-
-          llvm::ConstantInt *CaseVal = nullptr;
-          std::string VariantName;
-
-          if (auto *P = std::get_if<PatternAtomics::Literal>(&Pat)) {
-            llvm::Value *V = codegenExpr(P->Value.get());
-            if (auto *CI = llvm::dyn_cast<llvm::ConstantInt>(V)) {
-              CaseVal = CI;
-            } else {
-              CanUseSwitch = false; // Should not happen for int literal
-            }
-          } else if (auto *P = std::get_if<PatternAtomics::Variant>(&Pat)) {
-            VariantName = P->VariantName;
-            unsigned Disc = VariantDiscriminants[EnumName][VariantName];
-            CaseVal = Builder.getInt32(Disc);
-          }
-
-          if (CaseVal) {
-            Cases.push_back({CaseVal, ArmBB});
-          }
-        }
-      }
-
-      if (IsWildcardArm) {
-        DefaultBB = ArmBB;
-      }
-
-      // Generate Body
-      Builder.SetInsertPoint(ArmBB);
-
-      // Pattern bindings extraction (for Enum Variants)
-      if (IsEnum && !Arm.Patterns.empty()) {
-        for (const auto &Pat : Arm.Patterns) {
-          if (auto *P = std::get_if<PatternAtomics::Variant>(&Pat)) {
-            if (!P->Vars.empty()) {
-              // Extract
-              auto PayloadIt =
-                  VariantPayloadTypes[EnumName].find(P->VariantName);
-              if (PayloadIt != VariantPayloadTypes[EnumName].end()) {
-                llvm::Type *PayloadTy = PayloadIt->second;
-                auto *PayloadPtr = Builder.CreateStructGEP(
-                    llvm::cast<llvm::StructType>(ScrutineeTy), ScrutineeAlloca,
-                    1);
-                auto *TypedPayloadPtr = Builder.CreateBitCast(
-                    PayloadPtr, PayloadTy->getPointerTo());
-                llvm::Value *PayloadVal =
-                    Builder.CreateLoad(PayloadTy, TypedPayloadPtr);
-
-                if (!P->Vars.empty()) {
-                  auto &BoundVar = P->Vars[0];
-                  llvm::Type *VarTy = getLLVMType(BoundVar->getType());
-                  auto *VarAlloca = createEntryBlockAlloca(
-                      CurrentFunction, BoundVar->getId(), VarTy);
-                  Builder.CreateStore(PayloadVal, VarAlloca);
-                  NamedValues[BoundVar.get()] = VarAlloca;
-                }
-              }
-            }
-            break;
-          }
-        }
-      }
-
-      // Manually generate body to capture last expression result
-      llvm::Value *BodyResult = nullptr;
-
-      for (size_t i = 0; i < Arm.Body->getStmts().size(); ++i) {
-        if (hasTerminator())
-          break;
-        auto &S = Arm.Body->getStmts()[i];
-        // Optimization: capture last expression result
-        if (ResultPHI && i == Arm.Body->getStmts().size() - 1) {
-          if (auto *ES = llvm::dyn_cast<ExprStmt>(S.get())) {
-            BodyResult = codegenExpr(&ES->getExpr());
-            continue;
-          }
-        }
-        codegenStmt(S.get());
-      }
-
-      if (!hasTerminator()) {
-        if (ResultPHI) {
-          llvm::Value *Result =
-              BodyResult ? BodyResult
-                         : llvm::Constant::getNullValue(ResultPHI->getType());
-          if (Result->getType() != ResultPHI->getType()) {
-            Result = llvm::UndefValue::get(ResultPHI->getType());
-          }
-          ResultPHI->addIncoming(Result, Builder.GetInsertBlock());
-        }
-        Builder.CreateBr(MergeBB);
-      }
-    }
-
-    // Emit Switch
-    Builder.SetInsertPoint(StartBB);
-    auto *SI = Builder.CreateSwitch(SwitchVal, DefaultBB, Cases.size());
-    for (auto &Pair : Cases) {
-      SI->addCase(Pair.first, Pair.second);
-    }
-
-    // Handle Failure (if DefaultBB is FailBB)
-    if (DefaultBB == FailBB) {
-      Builder.SetInsertPoint(FailBB);
-      if (ResultPHI)
-        ResultPHI->addIncoming(llvm::UndefValue::get(ResultTy), FailBB);
-      Builder.CreateBr(MergeBB);
-    }
-
-    Builder.SetInsertPoint(MergeBB);
-    if (ResultPHI)
-      return ResultPHI;
-    return llvm::Constant::getNullValue(Builder.getInt32Ty());
-  }
-
-  // --- End Switch Optimization (Fallback to linear check) ---
-
-  // Generate arm blocks first (to allow forward jumps)
-  auto &Arms = E->getArms();
-  std::vector<llvm::BasicBlock *> ArmBBs;
-  for (size_t I = 0; I < Arms.size(); ++I) {
-    ArmBBs.push_back(llvm::BasicBlock::Create(Context, "match.arm",
-                                              CurrentFunction, FailBB));
-  }
-
-  // Jump to first arm
-  Builder.SetInsertPoint(StartBB);
-  if (!ArmBBs.empty()) {
-    Builder.CreateBr(ArmBBs[0]);
-  } else {
-    Builder.CreateBr(FailBB);
-  }
-
-  // Generate code for each arm
-  for (size_t I = 0; I < Arms.size(); ++I) {
-    auto *NextArmBB = (I + 1 < Arms.size()) ? ArmBBs[I + 1] : FailBB;
-
-    Builder.SetInsertPoint(ArmBBs[I]);
-    codegenMatchArm(Arms[I], ScrutineeAlloca, NextArmBB, MergeBB, ResultPHI);
-  }
-
-  // Handle failure case (no pattern matched)
-  Builder.SetInsertPoint(FailBB);
-  if (ResultPHI) {
-    ResultPHI->addIncoming(llvm::UndefValue::get(ResultTy), FailBB);
-  }
-  Builder.CreateBr(MergeBB);
-
-  Builder.SetInsertPoint(MergeBB);
-  if (ResultPHI)
-    return static_cast<llvm::Value *>(ResultPHI);
-  return llvm::Constant::getNullValue(Builder.getInt32Ty());
-}
-
-llvm::Value *CodeGen::codegenMatchArm(const MatchExpr::Arm &Arm,
-                                      llvm::Value *Scrutinee,
-                                      llvm::BasicBlock *NextArmBB,
-                                      llvm::BasicBlock *MergeBB,
-                                      llvm::PHINode *ResultPHI) {
-  auto *MatchBB = llvm::BasicBlock::Create(Context, "match.body",
-                                           CurrentFunction, NextArmBB);
-
-  // Pattern match - use first pattern (pattern alternations not yet supported)
-  if (!Arm.Patterns.empty()) {
-    matchPattern(Arm.Patterns[0], Scrutinee, MatchBB, NextArmBB);
-  } else {
-    // No patterns, unconditionally branch to match body
-    Builder.CreateBr(MatchBB);
-  }
-
-  // Generate arm body
-  Builder.SetInsertPoint(MatchBB);
-  codegenBlock(Arm.Body.get());
-
-  // Add result to PHI if needed
-  if (ResultPHI && !hasTerminator()) {
-    // Get last expression value from block
-    llvm::Value *Result = llvm::Constant::getNullValue(ResultPHI->getType());
-    if (!Arm.Body->getStmts().empty()) {
-      auto &LastStmt = Arm.Body->getStmts().back();
-      if (auto *ES = llvm::dyn_cast<ExprStmt>(LastStmt.get())) {
-        Result = codegenExpr(&ES->getExpr());
-      }
-    }
-    if (Result->getType() != ResultPHI->getType()) {
-      Result = llvm::UndefValue::get(ResultPHI->getType());
-    }
-    ResultPHI->addIncoming(Result, Builder.GetInsertBlock());
-  }
-
-  if (!hasTerminator())
-    Builder.CreateBr(MergeBB);
-
-  return nullptr;
-}
-
-void CodeGen::matchPattern(const Pattern &Pat, llvm::Value *Scrutinee,
-                           llvm::BasicBlock *SuccessBB,
-                           llvm::BasicBlock *FailBB) {
-  std::visit(
-      [&](auto &&P) {
-        using T = std::decay_t<decltype(P)>;
-        if constexpr (std::is_same_v<T, PatternAtomics::Wildcard>) {
-          matchWildcard(SuccessBB);
-        } else if constexpr (std::is_same_v<T, PatternAtomics::Literal>) {
-          matchLiteral(P, Scrutinee, SuccessBB, FailBB);
-        } else if constexpr (std::is_same_v<T, PatternAtomics::Variant>) {
-          matchVariant(P, Scrutinee, SuccessBB, FailBB);
-        }
-      },
-      Pat);
-}
-
-void CodeGen::matchWildcard(llvm::BasicBlock *SuccessBB) {
-  Builder.CreateBr(SuccessBB);
-}
-
-void CodeGen::matchLiteral(const PatternAtomics::Literal &Lit,
-                           llvm::Value *Scrutinee, llvm::BasicBlock *SuccessBB,
-                           llvm::BasicBlock *FailBB) {
-  llvm::Value *PatVal = codegenExpr(Lit.Value.get());
-  llvm::Type *ScrutineeTy = nullptr;
-  if (auto *AllocaInst = llvm::dyn_cast<llvm::AllocaInst>(Scrutinee)) {
-    ScrutineeTy = AllocaInst->getAllocatedType();
-  } else {
-    ScrutineeTy = PatVal->getType();
-  }
-  llvm::Value *ScrutineeVal = Builder.CreateLoad(ScrutineeTy, Scrutinee);
-  llvm::Value *Cmp = Builder.CreateICmpEQ(ScrutineeVal, PatVal, "match.cmp");
-  Builder.CreateCondBr(Cmp, SuccessBB, FailBB);
-}
-
-void CodeGen::matchVariant(const PatternAtomics::Variant &Var,
-                           llvm::Value *Scrutinee, llvm::BasicBlock *SuccessBB,
-                           llvm::BasicBlock *FailBB) {
-  // Get scrutinee type to find enum name
-  llvm::Type *ScrutineeTy = nullptr;
-  if (auto *AllocaInst = llvm::dyn_cast<llvm::AllocaInst>(Scrutinee)) {
-    ScrutineeTy = AllocaInst->getAllocatedType();
-  }
-  if (!ScrutineeTy || !llvm::isa<llvm::StructType>(ScrutineeTy)) {
-    Builder.CreateBr(FailBB);
-    return;
-  }
-
-  auto *StructTy = llvm::cast<llvm::StructType>(ScrutineeTy);
-  std::string EnumName = StructTy->hasName() ? StructTy->getName().str() : "";
-
-  // Get discriminant for this variant
-  auto EnumIt = VariantDiscriminants.find(EnumName);
-  if (EnumIt == VariantDiscriminants.end()) {
-    Builder.CreateBr(FailBB);
-    return;
-  }
-
-  auto VarIt = EnumIt->second.find(Var.VariantName);
-  if (VarIt == EnumIt->second.end()) {
-    Builder.CreateBr(FailBB);
-    return;
-  }
-
-  unsigned ExpectedDisc = VarIt->second;
-
-  // Load discriminant from scrutinee
-  auto *DiscPtr = Builder.CreateStructGEP(StructTy, Scrutinee, 0);
-  auto *ActualDisc = Builder.CreateLoad(Builder.getInt32Ty(), DiscPtr);
-
-  // Compare
-  auto *Cmp = Builder.CreateICmpEQ(ActualDisc, Builder.getInt32(ExpectedDisc),
-                                   "variant.cmp");
-
-  // If pattern has bindings, extract payload
-  if (!Var.Vars.empty()) {
-    auto *ExtractBB = llvm::BasicBlock::Create(Context, "variant.extract",
-                                               CurrentFunction, SuccessBB);
-    Builder.CreateCondBr(Cmp, ExtractBB, FailBB);
-
-    Builder.SetInsertPoint(ExtractBB);
-
-    // Load and bind payload variables
-    auto PayloadIt = VariantPayloadTypes[EnumName].find(Var.VariantName);
-    if (PayloadIt != VariantPayloadTypes[EnumName].end()) {
-      llvm::Type *PayloadTy = PayloadIt->second;
-      auto *PayloadPtr = Builder.CreateStructGEP(StructTy, Scrutinee, 1);
-      auto *TypedPayloadPtr =
-          Builder.CreateBitCast(PayloadPtr, PayloadTy->getPointerTo());
-      llvm::Value *PayloadVal = Builder.CreateLoad(PayloadTy, TypedPayloadPtr);
-
-      // Bind to first variable
-      if (!Var.Vars.empty()) {
-        auto &BoundVar = Var.Vars[0];
-        llvm::Type *VarTy = getLLVMType(BoundVar->getType());
-        auto *VarAlloca =
-            createEntryBlockAlloca(CurrentFunction, BoundVar->getId(), VarTy);
-        Builder.CreateStore(PayloadVal, VarAlloca);
-        NamedValues[BoundVar.get()] = VarAlloca;
-      }
-    }
-
-    Builder.CreateBr(SuccessBB);
-  } else {
-    Builder.CreateCondBr(Cmp, SuccessBB, FailBB);
-  }
-}
-
 llvm::Value *CodeGen::getLValuePtr(Expr *E) {
   if (auto *DR = llvm::dyn_cast<DeclRefExpr>(E)) {
     auto It = NamedValues.find(DR->getDecl());
     if (It != NamedValues.end())
       return It->second;
   } else if (auto *FA = llvm::dyn_cast<FieldAccessExpr>(E)) {
-    llvm::Value *BasePtr = getLValuePtr(FA->getBase());
+    const Type *BaseTy = FA->getBase()->getType().getPtr();
+    auto *Ref = llvm::dyn_cast<RefTy>(BaseTy);
+    llvm::Value *BasePtr =
+        Ref ? codegenExpr(FA->getBase()) : getLValuePtr(FA->getBase());
     if (!BasePtr) {
       BasePtr = codegenExpr(FA->getBase());
       // If getting address of RValue, we might need a temp?
@@ -1247,13 +815,16 @@ llvm::Value *CodeGen::getLValuePtr(Expr *E) {
     if (BasePtr) {
       const FieldDecl *Field = FA->getField();
       std::string StructName;
-      if (auto *AT = llvm::dyn_cast<AdtTy>(FA->getBase()->getType().getPtr())) {
+      if (Ref) {
+        BaseTy = Ref->getPointee().getPtr();
+      }
+      if (auto *AT = llvm::dyn_cast<AdtTy>(BaseTy)) {
         StructName = AT->getId();
       }
 
       auto It = FieldIndices.find(StructName);
       if (It != FieldIndices.end()) {
-        auto FieldIt = It->second.find(Field->getId());
+        auto FieldIt = It->second.find(Field->getIdentifier());
         if (FieldIt != It->second.end()) {
           llvm::Type *StructTy = StructTypes[StructName];
           return Builder.CreateStructGEP(StructTy, BasePtr, FieldIt->second);
@@ -1268,17 +839,14 @@ llvm::Value *CodeGen::getLValuePtr(Expr *E) {
     return Builder.CreateStructGEP(BaseTy, BasePtr, IE->getIndexVal());
   }
   if (auto *AE = llvm::dyn_cast<ArrayIndex>(E)) {
-    llvm::Value *Base = codegenExpr(AE->getBase());
-    llvm::Value *DataPtr = Builder.CreateExtractValue(Base, 0);
-    llvm::Value *Idx = codegenExpr(AE->getIndex());
-
-    llvm::Type *ElemTy = getLLVMType(AE->getType());
-    return Builder.CreateGEP(ElemTy, DataPtr, Idx);
+    return getArrayElementPtr(AE);
   }
   return nullptr;
 }
 
-llvm::Value *CodeGen::codegenArrayLiteral(ArrayLiteral *E) {
+// A literal is a fixed-size array built up in registers. Where it is used as
+// a slice, coerceValue gives it a stack slot.
+llvm::Value *CodeGen::codegen(ArrayLiteral *E) {
   std::vector<llvm::Value *> ElementVals;
   llvm::Type *ElemTy = nullptr;
   for (auto &El : E->getElements()) {
@@ -1297,42 +865,41 @@ llvm::Value *CodeGen::codegenArrayLiteral(ArrayLiteral *E) {
     }
   }
 
-  uint64_t Count = ElementVals.size();
-
-  llvm::ArrayType *ArrayTy = llvm::ArrayType::get(ElemTy, Count);
-  llvm::Value *BackingArray =
-      createEntryBlockAlloca(CurrentFunction, "array_literal", ArrayTy);
-
-  for (uint64_t I = 0; I < Count; ++I) {
-    llvm::Value *Ptr =
-        Builder.CreateConstInBoundsGEP2_32(ArrayTy, BackingArray, 0, I);
-    Builder.CreateStore(ElementVals[I], Ptr);
+  llvm::ArrayType *ArrayTy = llvm::ArrayType::get(ElemTy, ElementVals.size());
+  llvm::Value *Array = llvm::UndefValue::get(ArrayTy);
+  for (auto [I, Val] : llvm::enumerate(ElementVals)) {
+    Array = Builder.CreateInsertValue(Array, Val, I);
   }
 
-  llvm::StructType *SliceTy =
-      llvm::cast<llvm::StructType>(getLLVMType(E->getType()));
-  llvm::Value *Slice = llvm::UndefValue::get(SliceTy);
+  return coerceValue(Array, getLLVMType(E->getType()));
+}
 
-  llvm::Value *DataPtr =
-      Builder.CreateConstInBoundsGEP2_32(ArrayTy, BackingArray, 0, 0);
+llvm::Value *CodeGen::codegen(ArrayIndex *E) {
+  llvm::Type *ElemTy = getLLVMType(E->getType());
+  return Builder.CreateLoad(ElemTy, getArrayElementPtr(E));
+}
 
-  Slice = Builder.CreateInsertValue(Slice, DataPtr, 0);
-  Slice = Builder.CreateInsertValue(Slice, Builder.getInt64(Count), 1);
+llvm::Value *CodeGen::getArrayElementPtr(ArrayIndex *E) {
+  llvm::Type *BaseTy = getLLVMType(E->getBase()->getType());
+  llvm::Type *ElemTy = getLLVMType(E->getType());
 
-  return Slice;
-}
+  // A fixed-size array is indexed in place, so its length stays visible
+  if (auto *ArrTy = llvm::dyn_cast<llvm::ArrayType>(BaseTy)) {
+    llvm::Value *BasePtr = getLValuePtr(E->getBase());
+    if (!BasePtr) {
+      llvm::Value *BaseVal = codegenExpr(E->getBase());
+      BasePtr = createEntryBlockAlloca(CurrentFunction, "array.tmp", ArrTy);
+      storeValue(BaseVal, BasePtr);
+    }
+    llvm::Value *IdxVal = codegenExpr(E->getIndex());
+    return Builder.CreateInBoundsGEP(ArrTy, BasePtr,
+                                     {Builder.getInt64(0), IdxVal});
+  }
 
-llvm::Value *CodeGen::codegenArrayIndex(ArrayIndex *E) {
   llvm::Value *BaseVal = codegenExpr(E->getBase());
   llvm::Value *IdxVal = codegenExpr(E->getIndex());
-
   llvm::Value *DataPtr = Builder.CreateExtractValue(BaseVal, 0);
-
-  llvm::Type *ElemTy = getLLVMType(E->getType());
-
-  llvm::Value *Ptr = Builder.CreateGEP(ElemTy, DataPtr, IdxVal);
-
-  return Builder.CreateLoad(ElemTy, Ptr);
+  return Builder.CreateGEP(ElemTy, DataPtr, IdxVal);
 }
 
 llvm::Value *CodeGen::generatePrintlnCall(FunCallExpr *Call) {
@@ -0,0 +1,438 @@
+#include "CodeGen/LLVMCodeGen.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include <llvm/ADT/Statistic.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Operator.h>
+#include <llvm/Support/MathExtras.h>
+
+#define DEBUG_TYPE "codegen"
+
+STATISTIC(NumNicheEnums, "Number of enums laid out without a tag");
+STATISTIC(NumReorderedStructs, "Number of structs whose fields were reordered");
+
+using namespace phi;
+
+//===----------------------------------------------------------------------===//
+// Phase 4: Struct Layout
+//===----------------------------------------------------------------------===//
+
+// Fields are stored from the strictest alignment down, so that no field
+// needs padding before it and only the tail can. Fields of equal alignment
+// keep their declaration order. FieldIndices maps each field to its place.
+// `#[repr(C)]` and `#[packed]` structs keep declaration order, and packed
+// ones have no padding at all.
+
+llvm::StructType *CodeGen::layOutStruct(
+    const std::string &Name, const StructDecl *S,
+    const std::vector<std::pair<Identifier, llvm::Type *>> &Fields) {
+  auto It = StructTypes.find(Name);
+  if (It != StructTypes.end() && !It->second->isOpaque())
+    return It->second;
+
+  const Attribute *Repr = S->getAttr("repr");
+  bool Packed = S->getAttr("packed") != nullptr;
+  bool KeepOrder =
+      Packed || (Repr && Repr->Args == std::vector<std::string>{"C"});
+  std::vector<size_t> Order(Fields.size());
+  std::iota(Order.begin(), Order.end(), 0);
+  if (!KeepOrder) {
+    std::stable_sort(Order.begin(), Order.end(), [&](size_t A, size_t B) {
+      return getTypeAlign(Fields[A].second) > getTypeAlign(Fields[B].second);
+    });
+  }
+
+  std::vector<llvm::Type *> Members;
+  uint64_t Offset = 0;
+  uint64_t FieldBytes = 0;
+  for (size_t I : Order) {
+    const auto &[Id, Ty] = Fields[I];
+    if (!Packed) {
+      padToMemberAlign(Members, Offset, Ty, getTypeAlign(Ty));
+    }
+    FieldIndices[Name][Id] = Members.size();
+    Members.push_back(Ty);
+    Offset += getTypeSize(Ty);
+    FieldBytes += getTypeSize(Ty);
+  }
+  if (Packed) {
+    HasPackedStructs = true;
+  }
+  padToRequestedAlign(Name, S, Members, Offset, Packed);
+
+  llvm::StructType *ST;
+  if (It != StructTypes.end()) {
+    ST = It->second;
+    ST->setBody(Members, Packed);
+  } else {
+    ST = llvm::StructType::create(Context, Members, Name, Packed);
+    StructTypes[Name] = ST;
+  }
+
+  LayoutReportEntry Entry{Name, getTypeSize(ST), getTypeAlign(ST),
+                          getTypeSize(ST) - FieldBytes, {}};
+  if (!std::is_sorted(Order.begin(), Order.end())) {
+    for (size_t I : Order) {
+      Entry.Reordered.push_back(Fields[I].first.str());
+    }
+    if (!IsWorker) {
+      ++NumReorderedStructs;
+    }
+  }
+  LayoutReport.push_back(std::move(Entry));
+  return ST;
+}
+
+void CodeGen::printLayoutReport(llvm::raw_ostream &OS) const {
+  OS << "Type layouts: " << LayoutReport.size() << "\n";
+  for (const auto &Entry : LayoutReport) {
+    OS << "  " << Entry.Name << ": size " << Entry.Size << ", align "
+       << Entry.Align << ", padding " << Entry.Padding;
+    if (!Entry.Reordered.empty()) {
+      OS << " (fields " << llvm::join(Entry.Reordered, ", ") << ")";
+    }
+    OS << "\n";
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Phase 4: Enum Layout
+//===----------------------------------------------------------------------===//
+
+// An enum with a single payload variant stores that payload as-is. Its other
+// variants, if any, are encoded as invalid values of some field inside the
+// payload (a niche), so `Option<&T>` is a pointer where null means `None`.
+// Every other enum is `{ tag, payload }`: the tag is the narrowest integer
+// that counts the variants, and the payload area is an array of the strictest
+// payload alignment, so each payload sits at its natural offset.
+
+llvm::StructType *CodeGen::layOutEnum(
+    const std::string &Name, const EnumDecl *E,
+    const std::vector<std::pair<std::string, llvm::Type *>> &Variants) {
+  auto It = StructTypes.find(Name);
+  if (It != StructTypes.end() && !It->second->isOpaque())
+    return It->second;
+
+  unsigned Discriminant = 0;
+  unsigned NumUnit = 0;
+  std::optional<unsigned> DataDisc;
+  uint64_t MaxPayloadSize = 0;
+  uint64_t MaxPayloadAlign = 1;
+  for (const auto &[VariantName, PayloadTy] : Variants) {
+    VariantDiscriminants[Name][VariantName] = Discriminant;
+    if (PayloadTy) {
+      VariantPayloadTypes[Name][VariantName] = PayloadTy;
+      MaxPayloadSize = std::max(MaxPayloadSize, getTypeSize(PayloadTy));
+      MaxPayloadAlign = std::max(MaxPayloadAlign, getTypeAlign(PayloadTy));
+      DataDisc = Discriminant;
+    } else {
+      ++NumUnit;
+    }
+    ++Discriminant;
+  }
+  unsigned NumPayload = Variants.size() - NumUnit;
+
+  // Untagged: the one payload, with the unit variants in its niche
+  EnumLayout Layout;
+  std::vector<llvm::Type *> Members;
+  if (NumPayload == 1) {
+    // A bool takes a whole byte but only uses 0 and 1. It is stored widened
+    // so that the other values survive being loaded and stored as a whole.
+    llvm::Type *PayloadTy = Variants[*DataDisc].second;
+    std::optional<Niche> PayloadNiche;
+    if (PayloadTy->isIntegerTy(1)) {
+      PayloadTy = Builder.getInt8Ty();
+      PayloadNiche = Niche{{}, PayloadTy, 2, 254};
+    } else {
+      PayloadNiche = findNiche(PayloadTy);
+    }
+    if (PayloadNiche) {
+      PayloadNiche->Path.insert(PayloadNiche->Path.begin(), 0);
+    }
+
+    if (NumUnit == 0 || (PayloadNiche && PayloadNiche->Count >= NumUnit)) {
+      Layout.PayloadField = 0;
+      Layout.DataDiscriminant = *DataDisc;
+      Layout.Spare = PayloadNiche;
+      if (NumUnit > 0) {
+        uint64_t Value = PayloadNiche->Start;
+        for (unsigned D = 0; D < Variants.size(); ++D) {
+          if (D != *DataDisc) {
+            Layout.NicheValues[D] = Value++;
+          }
+        }
+        Layout.DiscNiche = PayloadNiche;
+        Layout.Spare->Start += NumUnit;
+        Layout.Spare->Count -= NumUnit;
+        if (Layout.Spare->Count == 0) {
+          Layout.Spare.reset();
+        }
+      }
+      Members.push_back(PayloadTy);
+      if (!IsWorker) {
+        ++NumNicheEnums;
+      }
+    }
+  }
+
+  // Tagged: { iN tag, [size / align x i(align * 8)] }. Integers wider than
+  // 16 bytes are not used, and the data layout may align an integer below
+  // its size, so the payload is padded in front where that falls short.
+  uint64_t Offset = 0;
+  if (Members.empty()) {
+    unsigned TagBits = Variants.size() <= (1u << 8)    ? 8
+                       : Variants.size() <= (1u << 16) ? 16
+                                                       : 32;
+    Layout.TagTy = Builder.getIntNTy(TagBits);
+    Members.push_back(Layout.TagTy);
+    Offset = getTypeSize(Layout.TagTy);
+    if (MaxPayloadSize > 0) {
+      uint64_t ElemAlign = std::min<uint64_t>(MaxPayloadAlign, 16);
+      auto *PayloadTy =
+          llvm::ArrayType::get(Builder.getIntNTy(ElemAlign * 8),
+                               llvm::divideCeil(MaxPayloadSize, ElemAlign));
+      padToMemberAlign(Members, Offset, PayloadTy, MaxPayloadAlign);
+      Layout.PayloadField = Members.size();
+      Members.push_back(PayloadTy);
+      Offset += getTypeSize(PayloadTy);
+    }
+    uint64_t TagValues = uint64_t(1) << TagBits;
+    if (Variants.size() < TagValues) {
+      Layout.Spare = Niche{{0}, Layout.TagTy, Variants.size(),
+                           TagValues - Variants.size()};
+    }
+  }
+  uint64_t UsedBytes = Layout.TagTy
+                          ? getTypeSize(Layout.TagTy) + MaxPayloadSize
+                          : getTypeSize(Members[0]);
+  if (!Layout.TagTy) {
+    Offset = getTypeSize(Members[0]);
+  }
+  EnumLayouts[Name] = std::move(Layout);
+  padToRequestedAlign(Name, E, Members, Offset, false, MaxPayloadAlign);
+
+  llvm::StructType *ST;
+  if (It != StructTypes.end()) {
+    ST = It->second;
+    ST->setBody(Members);
+  } else {
+    ST = llvm::StructType::create(Context, Members, Name);
+    StructTypes[Name] = ST;
+  }
+
+  LayoutReport.push_back({Name, getTypeSize(ST), getTypeAlign(ST),
+                          getTypeSize(ST) - UsedBytes, {}});
+  return ST;
+}
+
+// LLVM places each member at the alignment the data layout gives its type,
+// which is getTypeAlign's except for types holding an `#[align(N)]` ADT and
+// for enum payload areas. Those get explicit `[k x i8]` padding in front, so
+// that the offsets in the IR are the ones getTypeSize assumes.
+void CodeGen::padToMemberAlign(std::vector<llvm::Type *> &Members,
+                               uint64_t &Offset, llvm::Type *Ty,
+                               uint64_t Align) {
+  if (Align == getTypeAlign(Ty) && !hasRequestedAlign(Ty)) {
+    return;
+  }
+  if (uint64_t Pad = llvm::alignTo(Offset, Align) - Offset) {
+    Members.push_back(llvm::ArrayType::get(Builder.getInt8Ty(), Pad));
+    Offset += Pad;
+  }
+}
+
+// LLVM struct types carry no alignment of their own. An ADT aligned beyond
+// its members, by `#[align(N)]` or an over-aligned enum payload, records N
+// and gets tail padding so that its size is a multiple of N, which keeps
+// array elements aligned. So does one holding such a type, whose natural
+// LLVM size would stop short of it.
+void CodeGen::padToRequestedAlign(const std::string &Name, const AdtDecl *D,
+                                  std::vector<llvm::Type *> &Members,
+                                  uint64_t Size, bool Packed,
+                                  uint64_t MinAlign) {
+  uint64_t Align = MinAlign;
+  if (const Attribute *Attr = D->getAttr("align")) {
+    Align = std::max<uint64_t>(Align, std::stoull(Attr->Args[0]));
+  }
+  auto *Natural = llvm::StructType::get(Context, Members, Packed);
+  if (Align > getTypeAlign(Natural)) {
+    RequestedAligns[Name] = Align;
+  } else if (hasRequestedAlign(Natural)) {
+    Align = getTypeAlign(Natural);
+  } else {
+    return;
+  }
+
+  if (uint64_t Pad = llvm::alignTo(Size, Align) - Size) {
+    Members.push_back(llvm::ArrayType::get(Builder.getInt8Ty(), Pad));
+  }
+}
+
+std::optional<CodeGen::Niche> CodeGen::findNiche(llvm::Type *T) {
+  if (T->isPointerTy()) {
+    return Niche{{}, T, 0, 1};
+  }
+  if (auto *ST = llvm::dyn_cast<llvm::StructType>(T)) {
+    if (ST->hasName()) {
+      auto It = EnumLayouts.find(ST->getName().str());
+      if (It != EnumLayouts.end()) {
+        return It->second.Spare;
+      }
+    }
+    for (unsigned I = 0; I < ST->getNumElements(); ++I) {
+      if (auto N = findNiche(ST->getElementType(I))) {
+        N->Path.insert(N->Path.begin(), I);
+        return N;
+      }
+    }
+    return std::nullopt;
+  }
+  if (auto *AT = llvm::dyn_cast<llvm::ArrayType>(T)) {
+    if (AT->getNumElements() == 0) {
+      return std::nullopt;
+    }
+    if (auto N = findNiche(AT->getElementType())) {
+      N->Path.insert(N->Path.begin(), 0);
+      return N;
+    }
+  }
+  return std::nullopt;
+}
+
+llvm::Value *CodeGen::getNichePtr(llvm::StructType *EnumTy, llvm::Value *Ptr,
+                                  const Niche &N) {
+  std::vector<llvm::Value *> Indices = {Builder.getInt32(0)};
+  for (unsigned I : N.Path) {
+    Indices.push_back(Builder.getInt32(I));
+  }
+  return Builder.CreateInBoundsGEP(EnumTy, Ptr, Indices, "niche");
+}
+
+//===----------------------------------------------------------------------===//
+// Type Sizes
+//===----------------------------------------------------------------------===//
+
+// Sizes and alignments are the target data layout's, except that an ADT
+// aligned beyond its members keeps the alignment it asked for, and so does
+// anything holding it. Such ADTs are padded in the IR, so the data layout
+// already agrees on their size.
+
+uint64_t CodeGen::getTypeSize(llvm::Type *T) {
+  // A struct that is not laid out yet has no size
+  if (!T->isSized()) {
+    return 0;
+  }
+  return Module->getDataLayout().getTypeAllocSize(T).getFixedValue();
+}
+
+uint64_t CodeGen::getTypeAlign(llvm::Type *T) {
+  if (!T->isSized()) {
+    return 1;
+  }
+  uint64_t Align = Module->getDataLayout().getABITypeAlign(T).value();
+  if (auto *ST = llvm::dyn_cast<llvm::StructType>(T)) {
+    if (ST->hasName()) {
+      auto It = RequestedAligns.find(ST->getName());
+      if (It != RequestedAligns.end())
+        return It->second;
+    }
+    if (!ST->isPacked()) {
+      for (auto *Elem : ST->elements()) {
+        Align = std::max(Align, getTypeAlign(Elem));
+      }
+    }
+  } else if (auto *AT = llvm::dyn_cast<llvm::ArrayType>(T)) {
+    Align = std::max(Align, getTypeAlign(AT->getElementType()));
+  }
+  return Align;
+}
+
+//===----------------------------------------------------------------------===//
+// Layout Alignment
+//===----------------------------------------------------------------------===//
+
+// IRBuilder aligns memory accesses by the data layout, which knows neither
+// `#[align(N)]` nor that a field of a packed struct may sit at any offset.
+// Every alloca, load and store passes through here as it is inserted, so
+// over-aligned values get their alignment and packed fields alignment 1.
+// Globals get theirs where they are created.
+
+void CodeGen::alignMemoryAccess(llvm::Instruction *I) {
+  if (RequestedAligns.empty() && !HasPackedStructs) {
+    return;
+  }
+
+  auto alignFor = [&](llvm::Type *Ty, llvm::Value *Ptr) {
+    if (Ptr && isPackedMember(Ptr)) {
+      return std::optional<llvm::Align>(llvm::Align(1));
+    }
+    if (hasRequestedAlign(Ty)) {
+      return std::optional<llvm::Align>(getTypeAlign(Ty));
+    }
+    return std::optional<llvm::Align>();
+  };
+
+  if (auto *AI = llvm::dyn_cast<llvm::AllocaInst>(I)) {
+    if (auto A = alignFor(AI->getAllocatedType(), nullptr)) {
+      AI->setAlignment(*A);
+    }
+  } else if (auto *LI = llvm::dyn_cast<llvm::LoadInst>(I)) {
+    if (auto A = alignFor(LI->getType(), LI->getPointerOperand())) {
+      LI->setAlignment(*A);
+    }
+  } else if (auto *SI = llvm::dyn_cast<llvm::StoreInst>(I)) {
+    if (auto A = alignFor(SI->getValueOperand()->getType(),
+                          SI->getPointerOperand())) {
+      SI->setAlignment(*A);
+    }
+  }
+}
+
+bool CodeGen::hasRequestedAlign(llvm::Type *T) {
+  if (auto *ST = llvm::dyn_cast<llvm::StructType>(T)) {
+    if (ST->hasName() && RequestedAligns.count(ST->getName())) {
+      return true;
+    }
+    return llvm::any_of(ST->elements(),
+                        [&](llvm::Type *E) { return hasRequestedAlign(E); });
+  }
+  if (auto *AT = llvm::dyn_cast<llvm::ArrayType>(T)) {
+    return hasRequestedAlign(AT->getElementType());
+  }
+  return false;
+}
+
+bool CodeGen::isPackedMember(llvm::Value *Ptr) {
+  auto *GEP = llvm::dyn_cast<llvm::GEPOperator>(Ptr);
+  if (!GEP) {
+    return false;
+  }
+
+  // Walk the indices after the first, which only steps over whole objects
+  llvm::Type *Ty = GEP->getSourceElementType();
+  for (auto Idx = GEP->idx_begin() + 1; Idx != GEP->idx_end(); ++Idx) {
+    if (auto *ST = llvm::dyn_cast<llvm::StructType>(Ty)) {
+      if (ST->isPacked()) {
+        return true;
+      }
+      auto *Field = llvm::dyn_cast<llvm::ConstantInt>(Idx->get());
+      if (!Field) {
+        return false;
+      }
+      Ty = ST->getElementType(Field->getZExtValue());
+    } else if (auto *AT = llvm::dyn_cast<llvm::ArrayType>(Ty)) {
+      Ty = AT->getElementType();
+    } else {
+      break;
+    }
+  }
+  return isPackedMember(GEP->getPointerOperand());
+}
+
+#undef DEBUG_TYPE
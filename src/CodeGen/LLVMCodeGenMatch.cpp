@@ -0,0 +1,506 @@
+#include "CodeGen/LLVMCodeGen.hpp"
+
+#include <map>
+#include <set>
+#include <optional>
+#include <string>
+#include <variant>
+
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+
+using namespace phi;
+
+namespace {
+
+/// Picks byte positions whose values tell apart every string in \p Strs, which
+/// all have the same length. Each step adds the position that splits the
+/// strings into the most groups, in the spirit of gperf's key positions.
+std::vector<size_t> pickKeyPositions(const std::vector<std::string> &Strs) {
+  std::vector<size_t> Positions;
+  if (Strs.size() < 2) {
+    return Positions;
+  }
+
+  size_t Len = Strs.front().size();
+  auto countGroups = [&](const std::vector<size_t> &Pos) {
+    std::set<std::string> Keys;
+    for (const auto &S : Strs) {
+      std::string Key;
+      for (size_t P : Pos) {
+        Key += S[P];
+      }
+      Keys.insert(std::move(Key));
+    }
+    return Keys.size();
+  };
+
+  while (countGroups(Positions) < Strs.size()) {
+    size_t Best = Len;
+    size_t BestGroups = 0;
+    for (size_t P = 0; P < Len; ++P) {
+      if (llvm::is_contained(Positions, P)) {
+        continue;
+      }
+      auto Candidate = Positions;
+      Candidate.push_back(P);
+      size_t Groups = countGroups(Candidate);
+      if (Groups > BestGroups) {
+        Best = P;
+        BestGroups = Groups;
+      }
+    }
+    Positions.push_back(Best);
+  }
+  return Positions;
+}
+
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// Phase 4: Match Expression Codegen
+//===----------------------------------------------------------------------===//
+
+// Every pattern tests the scrutinee itself, so the decision tree of a match
+// has a single level. Each constructor the patterns name (an enum variant or
+// a literal value) goes to the first arm that names it, and everything else
+// goes to the first wildcard arm. Arms after that wildcard cannot be reached.
+// The tested value, the tag for enums, is loaded once. Integer tests become
+// a single switch, untagged enums go through codegenNicheSwitch, strings
+// through codegenStringSwitch, and other tests become a chain of compares.
+//
+// Each case jumps to its arm's body. A case that binds a payload first goes
+// through a small block that binds it. The alternatives of an or-pattern
+// share their arm's body.
+
+llvm::Value *CodeGen::codegen(MatchExpr *E) {
+  llvm::Value *Scrutinee = codegenExpr(E->getScrutinee());
+  TypeRef ASTType = E->getScrutinee()->getType().removeIndir();
+  llvm::Type *ScrutineeTy = getLLVMType(ASTType);
+  llvm::Value *ScrutineeAlloca = Scrutinee;
+
+  // Handles pointer to struct (opaque)
+  if (!Scrutinee->getType()->isPointerTy() ||
+      !llvm::isa<llvm::StructType>(ScrutineeTy)) {
+    ScrutineeAlloca =
+        createEntryBlockAlloca(CurrentFunction, "scrutinee", ScrutineeTy);
+    Builder.CreateStore(Scrutinee, ScrutineeAlloca);
+  }
+
+  // Enum matches test the discriminant, everything else the value itself
+  auto *EnumTy = llvm::dyn_cast<llvm::StructType>(ScrutineeTy);
+  std::string EnumName;
+  const EnumLayout *Layout = nullptr;
+  if (EnumTy && EnumTy->hasName() &&
+      VariantDiscriminants.contains(EnumTy->getName().str())) {
+    EnumName = EnumTy->getName().str();
+    Layout = &EnumLayouts[EnumName];
+  } else {
+    EnumTy = nullptr;
+  }
+
+  // Collect the first arm for every constructor, up to the first wildcard
+  struct Case {
+    llvm::Constant *Key;
+    size_t Arm;
+    const Pattern *Pat;
+  };
+  std::vector<Case> Cases;
+  llvm::SmallPtrSet<llvm::Constant *, 16> Covered;
+  llvm::StringSet<> CoveredStrings;
+  std::optional<size_t> DefaultArm;
+
+  auto &Arms = E->getArms();
+  for (size_t I = 0; I < Arms.size() && !DefaultArm; ++I) {
+    if (Arms[I].Patterns.empty()) {
+      DefaultArm = I;
+      break;
+    }
+    for (const auto &Pat : Arms[I].Patterns) {
+      llvm::Constant *Key = nullptr;
+      if (std::holds_alternative<PatternAtomics::Wildcard>(Pat)) {
+        DefaultArm = I;
+        break;
+      }
+      if (auto *P = std::get_if<PatternAtomics::Variant>(&Pat)) {
+        if (!EnumTy) {
+          continue;
+        }
+        auto &Discs = VariantDiscriminants[EnumName];
+        auto It = Discs.find(P->VariantName.str());
+        if (It == Discs.end()) {
+          continue;
+        }
+        Key = Layout->TagTy
+                  ? llvm::ConstantInt::get(Layout->TagTy, It->second)
+                  : Builder.getInt32(It->second);
+      } else if (auto *P = std::get_if<PatternAtomics::Literal>(&Pat)) {
+        // Strings are compared by contents, never through a constant
+        if (auto *Str = llvm::dyn_cast<StrLiteral>(P->Value.get())) {
+          if (CoveredStrings.insert(Str->getValue()).second) {
+            Cases.push_back({nullptr, I, &Pat});
+          }
+          continue;
+        }
+        Key = llvm::dyn_cast<llvm::Constant>(codegenExpr(P->Value.get()));
+      }
+      if (Key && Covered.insert(Key).second) {
+        Cases.push_back({Key, I, &Pat});
+      }
+    }
+  }
+
+  // Blocks: one per reachable arm, one per binding case, and the fallthrough
+  auto *MergeBB =
+      llvm::BasicBlock::Create(Context, "match.end", CurrentFunction);
+  std::vector<llvm::BasicBlock *> ArmBBs(Arms.size(), nullptr);
+  auto getArmBB = [&](size_t I) {
+    if (!ArmBBs[I]) {
+      ArmBBs[I] = llvm::BasicBlock::Create(Context, "match.arm",
+                                           CurrentFunction, MergeBB);
+    }
+    return ArmBBs[I];
+  };
+
+  std::vector<llvm::BasicBlock *> Targets;
+  std::vector<std::pair<llvm::BasicBlock *, const Case *>> BindBBs;
+  for (const auto &C : Cases) {
+    auto *Var = std::get_if<PatternAtomics::Variant>(C.Pat);
+    if (Var && !Var->Vars.empty()) {
+      auto *BindBB = llvm::BasicBlock::Create(Context, "match.bind",
+                                              CurrentFunction, MergeBB);
+      BindBBs.push_back({BindBB, &C});
+      Targets.push_back(BindBB);
+    } else {
+      Targets.push_back(getArmBB(C.Arm));
+    }
+  }
+
+  llvm::BasicBlock *FailBB = nullptr;
+  llvm::BasicBlock *DefaultBB = nullptr;
+  if (DefaultArm) {
+    DefaultBB = getArmBB(*DefaultArm);
+  } else {
+    FailBB = llvm::BasicBlock::Create(Context, "match.fail", CurrentFunction,
+                                      MergeBB);
+    DefaultBB = FailBB;
+  }
+
+  // Load the tested value once and dispatch on it
+  llvm::Value *Tested = nullptr;
+  if (EnumTy && Layout->TagTy) {
+    auto *DiscPtr = Builder.CreateStructGEP(EnumTy, ScrutineeAlloca, 0);
+    Tested = Builder.CreateLoad(Layout->TagTy, DiscPtr, "match.disc");
+  } else if (!EnumTy && !Cases.empty()) {
+    Tested = Builder.CreateLoad(ScrutineeTy, ScrutineeAlloca, "match.val");
+  }
+
+  auto *Builtin = llvm::dyn_cast<BuiltinTy>(ASTType.getPtr());
+  bool IsString = Builtin && Builtin->getBuiltinKind() == BuiltinTy::String;
+  bool UseSwitch =
+      Tested && Tested->getType()->isIntegerTy() &&
+      llvm::all_of(Cases, [&](const Case &C) {
+        return C.Key && C.Key->getType() == Tested->getType() &&
+               llvm::isa<llvm::ConstantInt>(C.Key);
+      });
+
+  if (EnumTy && !Layout->TagTy) {
+    std::vector<std::pair<unsigned, llvm::BasicBlock *>> NicheCases;
+    for (size_t I = 0; I < Cases.size(); ++I) {
+      auto *Disc = llvm::cast<llvm::ConstantInt>(Cases[I].Key);
+      NicheCases.push_back({unsigned(Disc->getZExtValue()), Targets[I]});
+    }
+    codegenNicheSwitch(ScrutineeAlloca, EnumTy, NicheCases, DefaultBB);
+  } else if (IsString && Tested) {
+    std::vector<std::pair<std::string, llvm::BasicBlock *>> StrCases;
+    for (size_t I = 0; I < Cases.size(); ++I) {
+      const auto &Lit = std::get<PatternAtomics::Literal>(*Cases[I].Pat);
+      StrCases.push_back(
+          {llvm::cast<StrLiteral>(Lit.Value.get())->getValue(), Targets[I]});
+    }
+    codegenStringSwitch(Tested, StrCases, DefaultBB);
+  } else if (UseSwitch) {
+    auto *SI = Builder.CreateSwitch(Tested, DefaultBB, Cases.size());
+    for (size_t I = 0; I < Cases.size(); ++I) {
+      SI->addCase(llvm::cast<llvm::ConstantInt>(Cases[I].Key), Targets[I]);
+    }
+  } else {
+    for (size_t I = 0; I < Cases.size(); ++I) {
+      auto *NextBB = llvm::BasicBlock::Create(Context, "match.next",
+                                              CurrentFunction, MergeBB);
+      Builder.CreateCondBr(codegenMatchTest(Tested, Cases[I].Key), Targets[I],
+                           NextBB);
+      Builder.SetInsertPoint(NextBB);
+    }
+    Builder.CreateBr(DefaultBB);
+  }
+
+  // Bind payloads
+  for (auto &[BindBB, C] : BindBBs) {
+    Builder.SetInsertPoint(BindBB);
+    bindVariantPayload(std::get<PatternAtomics::Variant>(*C->Pat),
+                       ScrutineeAlloca, EnumTy);
+    Builder.CreateBr(getArmBB(C->Arm));
+  }
+
+  // Arm bodies
+  llvm::Type *ResultTy = getLLVMType(E->getType());
+  llvm::PHINode *ResultPHI = nullptr;
+  if (!ResultTy->isVoidTy()) {
+    Builder.SetInsertPoint(MergeBB);
+    ResultPHI =
+        Builder.CreatePHI(ResultTy, E->getArms().size() + 1, "match.result");
+  }
+
+  for (size_t I = 0; I < Arms.size(); ++I) {
+    if (ArmBBs[I]) {
+      Builder.SetInsertPoint(ArmBBs[I]);
+      codegenMatchBody(Arms[I], MergeBB, ResultPHI);
+    }
+  }
+
+  // Handle failure case (no pattern matched)
+  if (FailBB) {
+    Builder.SetInsertPoint(FailBB);
+    if (ResultPHI) {
+      ResultPHI->addIncoming(llvm::UndefValue::get(ResultTy), FailBB);
+    }
+    Builder.CreateBr(MergeBB);
+  }
+
+  Builder.SetInsertPoint(MergeBB);
+  if (ResultPHI)
+    return ResultPHI;
+  return llvm::Constant::getNullValue(Builder.getInt32Ty());
+}
+
+void CodeGen::codegenMatchBody(const MatchExpr::Arm &Arm,
+                               llvm::BasicBlock *MergeBB,
+                               llvm::PHINode *ResultPHI) {
+  // Generate the body by hand to capture its trailing expression
+  llvm::Value *BodyResult = nullptr;
+  auto &Stmts = Arm.Body->getStmts();
+  for (size_t I = 0; I < Stmts.size(); ++I) {
+    if (hasTerminator())
+      break;
+    if (ResultPHI && I == Stmts.size() - 1) {
+      if (auto *ES = llvm::dyn_cast<ExprStmt>(Stmts[I].get())) {
+        BodyResult = codegenExpr(&ES->getExpr());
+        continue;
+      }
+    }
+    codegenStmt(Stmts[I].get());
+  }
+
+  if (hasTerminator())
+    return;
+
+  if (ResultPHI) {
+    llvm::Value *Result =
+        BodyResult ? BodyResult
+                   : llvm::Constant::getNullValue(ResultPHI->getType());
+    if (Result->getType() != ResultPHI->getType()) {
+      Result = llvm::UndefValue::get(ResultPHI->getType());
+    }
+    ResultPHI->addIncoming(Result, Builder.GetInsertBlock());
+  }
+  Builder.CreateBr(MergeBB);
+}
+
+llvm::Value *CodeGen::codegenMatchTest(llvm::Value *Tested,
+                                       llvm::Constant *Key) {
+  if (!Key || Tested->getType() != Key->getType()) {
+    return Builder.getFalse();
+  }
+  if (Tested->getType()->isFloatingPointTy()) {
+    return Builder.CreateFCmpOEQ(Tested, Key, "match.cmp");
+  }
+  if (Tested->getType()->isIntOrPtrTy()) {
+    return Builder.CreateICmpEQ(Tested, Key, "match.cmp");
+  }
+  return Builder.getFalse();
+}
+
+// An untagged enum is its payload unless the niche holds one of the other
+// variants' values. With a pointer niche that is a single null check.
+void CodeGen::codegenNicheSwitch(
+    llvm::Value *Scrutinee, llvm::StructType *EnumTy,
+    const std::vector<std::pair<unsigned, llvm::BasicBlock *>> &Cases,
+    llvm::BasicBlock *DefaultBB) {
+  const EnumLayout &Layout = EnumLayouts[EnumTy->getName().str()];
+  auto targetOf = [&](unsigned Disc) {
+    for (const auto &[CaseDisc, Target] : Cases) {
+      if (CaseDisc == Disc) {
+        return Target;
+      }
+    }
+    return DefaultBB;
+  };
+
+  llvm::BasicBlock *DataBB = targetOf(Layout.DataDiscriminant);
+  if (!Layout.DiscNiche) {
+    Builder.CreateBr(DataBB);
+    return;
+  }
+
+  const Niche &N = *Layout.DiscNiche;
+  auto *NicheVal = Builder.CreateLoad(
+      N.Ty, getNichePtr(EnumTy, Scrutinee, N), "match.niche");
+  if (N.Ty->isPointerTy()) {
+    auto [UnitDisc, _] = *Layout.NicheValues.begin();
+    Builder.CreateCondBr(Builder.CreateIsNull(NicheVal, "match.isnull"),
+                         targetOf(UnitDisc), DataBB);
+    return;
+  }
+
+  // Ordered by niche value so the emitted IR is stable
+  std::map<uint64_t, unsigned> ByValue;
+  for (const auto &[Disc, Value] : Layout.NicheValues) {
+    ByValue[Value] = Disc;
+  }
+  auto *SI = Builder.CreateSwitch(NicheVal, DataBB, ByValue.size());
+  for (const auto &[Value, Disc] : ByValue) {
+    SI->addCase(llvm::ConstantInt::get(llvm::cast<llvm::IntegerType>(N.Ty),
+                                       Value),
+                targetOf(Disc));
+  }
+}
+
+void CodeGen::bindVariantPayload(const PatternAtomics::Variant &Var,
+                                 llvm::Value *Scrutinee,
+                                 llvm::StructType *EnumTy) {
+  auto &Payloads = VariantPayloadTypes[EnumTy->getName().str()];
+  auto PayloadIt = Payloads.find(Var.VariantName.str());
+  if (Var.Vars.empty() || PayloadIt == Payloads.end()) {
+    return;
+  }
+
+  const EnumLayout &Layout = EnumLayouts[EnumTy->getName().str()];
+  auto *PayloadPtr =
+      Builder.CreateStructGEP(EnumTy, Scrutinee, Layout.PayloadField);
+  llvm::Value *Payload = nullptr;
+  if (!Layout.TagTy && EnumTy->getElementType(0) != PayloadIt->second) {
+    // A bool stored widened to keep its niche
+    Payload = Builder.CreateTrunc(
+        Builder.CreateLoad(EnumTy->getElementType(0), PayloadPtr),
+        PayloadIt->second);
+  } else {
+    Payload = Builder.CreateLoad(PayloadIt->second, PayloadPtr);
+  }
+
+  // The payload binds to the first variable
+  auto &BoundVar = Var.Vars[0];
+  llvm::Type *VarTy = getLLVMType(BoundVar->getType());
+  auto *VarAlloca =
+      createEntryBlockAlloca(CurrentFunction, BoundVar->getId(), VarTy);
+  Builder.CreateStore(Payload, VarAlloca);
+  NamedValues[BoundVar.get()] = VarAlloca;
+}
+
+// A string match dispatches on the scrutinee's length, then, among literals
+// of that length, on the bytes at a few positions that tell them apart. Both
+// are switches, so picking the candidate costs the same for ten keywords as
+// for a thousand. The one candidate left is confirmed with a memcmp.
+void CodeGen::codegenStringSwitch(
+    llvm::Value *Str,
+    const std::vector<std::pair<std::string, llvm::BasicBlock *>> &Cases,
+    llvm::BasicBlock *DefaultBB) {
+  auto *SizeTy = Builder.getInt64Ty();
+  llvm::FunctionCallee Strlen = Module->getOrInsertFunction(
+      "strlen", llvm::FunctionType::get(SizeTy, {Builder.getPtrTy()}, false));
+  llvm::FunctionCallee Memcmp = Module->getOrInsertFunction(
+      "memcmp",
+      llvm::FunctionType::get(Builder.getInt32Ty(),
+                              {Builder.getPtrTy(), Builder.getPtrTy(), SizeTy},
+                              false));
+
+  // Ordered by length so the emitted IR is stable
+  std::map<size_t, std::vector<std::pair<std::string, llvm::BasicBlock *>>>
+      ByLength;
+  for (const auto &Case : Cases) {
+    ByLength[Case.first.size()].push_back(Case);
+  }
+
+  auto *Len = Builder.CreateCall(Strlen, {Str}, "match.len");
+  auto *LenSwitch = Builder.CreateSwitch(Len, DefaultBB, ByLength.size());
+
+  // Confirms that the scrutinee is \p Lit and continues to \p Target
+  auto confirm = [&](const std::string &Lit, llvm::BasicBlock *Target) {
+    auto *BB = llvm::BasicBlock::Create(Context, "match.str", CurrentFunction,
+                                        DefaultBB);
+    Builder.SetInsertPoint(BB);
+    if (Lit.empty()) {
+      Builder.CreateBr(Target);
+      return BB;
+    }
+    auto *Cmp = Builder.CreateCall(
+        Memcmp, {Str, Builder.CreateGlobalStringPtr(Lit),
+                 Builder.getInt64(Lit.size())});
+    Builder.CreateCondBr(Builder.CreateICmpEQ(Cmp, Builder.getInt32(0)),
+                         Target, DefaultBB);
+    return BB;
+  };
+
+  for (const auto &[Length, Group] : ByLength) {
+    if (Group.size() == 1) {
+      LenSwitch->addCase(Builder.getInt64(Length),
+                         confirm(Group[0].first, Group[0].second));
+      continue;
+    }
+
+    std::vector<std::string> Strs;
+    for (const auto &Case : Group) {
+      Strs.push_back(Case.first);
+    }
+    std::vector<size_t> Positions = pickKeyPositions(Strs);
+
+    // Pack the selected bytes into one integer and switch on it. Literals of
+    // one length differ somewhere, so the positions always exist, but past
+    // eight of them the key no longer fits in 64 bits.
+    auto *GroupBB = llvm::BasicBlock::Create(Context, "match.strkey",
+                                             CurrentFunction, DefaultBB);
+    LenSwitch->addCase(Builder.getInt64(Length), GroupBB);
+    Builder.SetInsertPoint(GroupBB);
+
+    if (Positions.size() > 8) {
+      for (const auto &[Lit, Target] : Group) {
+        auto *NextBB = llvm::BasicBlock::Create(Context, "match.next",
+                                                CurrentFunction, DefaultBB);
+        auto *Cmp = Builder.CreateCall(
+            Memcmp, {Str, Builder.CreateGlobalStringPtr(Lit),
+                     Builder.getInt64(Lit.size())});
+        Builder.CreateCondBr(Builder.CreateICmpEQ(Cmp, Builder.getInt32(0)),
+                             Target, NextBB);
+        Builder.SetInsertPoint(NextBB);
+      }
+      Builder.CreateBr(DefaultBB);
+      continue;
+    }
+
+    auto *KeyTy = Builder.getIntNTy(8 * Positions.size());
+    llvm::Value *Key = nullptr;
+    for (size_t I = 0; I < Positions.size(); ++I) {
+      auto *BytePtr = Builder.CreateConstInBoundsGEP1_64(
+          Builder.getInt8Ty(), Str, Positions[I]);
+      auto *Byte = Builder.CreateLoad(Builder.getInt8Ty(), BytePtr);
+      llvm::Value *Wide = Builder.CreateZExt(Byte, KeyTy);
+      if (I > 0) {
+        Wide = Builder.CreateShl(Wide, 8 * I);
+      }
+      Key = Key ? Builder.CreateOr(Key, Wide) : Wide;
+    }
+    auto *KeySwitch = Builder.CreateSwitch(Key, DefaultBB, Group.size());
+
+    for (const auto &[Lit, Target] : Group) {
+      uint64_t LitKey = 0;
+      for (size_t I = 0; I < Positions.size(); ++I) {
+        LitKey |= uint64_t(static_cast<unsigned char>(Lit[Positions[I]]))
+                  << (8 * I);
+      }
+      KeySwitch->addCase(llvm::ConstantInt::get(KeyTy, LitKey),
+                         confirm(Lit, Target));
+    }
+  }
+}
@@ -0,0 +1,26 @@
+#include "CodeGen/LLVMCodeGen.hpp"
+
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Transforms/IPO/MergeFunctions.h>
+
+using namespace phi;
+
+//===----------------------------------------------------------------------===//
+// Phase 5: Identical Function Merging
+//===----------------------------------------------------------------------===//
+
+// Instances are already shared when their type arguments lower alike, but
+// arguments that differ to the type system can still produce the same code:
+// `id<i32>` and `id<u32>`, or a body that never touches the argument. LLVM
+// compares the finished functions instruction by instruction, looking
+// through struct names, and points the callers of each duplicate at one
+// body. A duplicate left without users is deleted; one that is exported or
+// whose address is taken becomes a call to the shared body.
+void CodeGen::mergeIdenticalFunctions() {
+  llvm::ModuleAnalysisManager MAM;
+  llvm::PassBuilder PB;
+  PB.registerModuleAnalyses(MAM);
+
+  llvm::MergeFunctionsPass().run(*Module, MAM);
+}
@@ -1,10 +1,20 @@
 #include "CodeGen/LLVMCodeGen.hpp"
+#include "AST/TypeSystem/Context.hpp"
 
 #include <cctype>
+#include <stdexcept>
+#include <utility>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/Parallel.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 using namespace phi;
 
@@ -13,15 +23,30 @@ using namespace phi;
 //===----------------------------------------------------------------------===//
 
 void CodeGen::monomorphize() {
-  while (!Instantiations.empty()) {
-    auto It = Instantiations.begin();
-    TypeInstantiation TI = *It;
-    Instantiations.erase(It);
+  // Whether a signature passes an aggregate by pointer depends on its size,
+  // so every ADT instance is laid out before any function is declared
+  std::vector<TypeInstantiation> Callables;
+  while (!Worklist.empty()) {
+    TypeInstantiation TI = std::move(Worklist.front());
+    Worklist.pop_front();
+    if (llvm::isa<FunDecl, MethodDecl>(TI.GenericDecl)) {
+      Callables.push_back(std::move(TI));
+      continue;
+    }
+    monomorphizeDecl(TI);
+  }
+  for (const auto &TI : Callables) {
     monomorphizeDecl(TI);
   }
 }
 
 void CodeGen::monomorphizeDecl(const TypeInstantiation &TI) {
+  // Methods check for their function instead, see getOrMonomorphizeMethod
+  if (!llvm::isa<MethodDecl>(TI.GenericDecl) &&
+      !MonomorphizedInstances.insert(getMonomorphizedName(TI)).second) {
+    return;
+  }
+
   if (auto *S = llvm::dyn_cast<StructDecl>(TI.GenericDecl)) {
     monomorphizeStruct(S, TI.TypeArgs);
   } else if (auto *E = llvm::dyn_cast<EnumDecl>(TI.GenericDecl)) {
@@ -29,82 +54,66 @@ void CodeGen::monomorphizeDecl(const TypeInstantiation &TI) {
   } else if (auto *F = llvm::dyn_cast<FunDecl>(TI.GenericDecl)) {
     monomorphizeFunction(F, TI.TypeArgs);
   } else if (auto *M = llvm::dyn_cast<MethodDecl>(TI.GenericDecl)) {
-    monomorphizeMethod(M, TI.TypeArgs);
+    getOrMonomorphizeMethod(M, TI.TypeArgs);
+  }
+}
+
+llvm::Function *
+CodeGen::getOrMonomorphizeMethod(const MethodDecl *M,
+                                 const std::vector<TypeRef> &TypeArgs) {
+  if (auto *Fn = Module->getFunction(getMonomorphizedName({M, TypeArgs}))) {
+    return Fn;
+  }
+
+  // The method's signature may name the parent instance, so lay it out first
+  if (M->getParent()->hasTypeArgs()) {
+    monomorphizeDecl({M->getParent(), TypeArgs});
   }
+
+  return monomorphizeMethod(M, TypeArgs);
 }
 
 void CodeGen::monomorphizeStruct(const StructDecl *S,
                                  const std::vector<TypeRef> &TypeArgs) {
   std::string MonoName = generateMonomorphizedName(S->getId(), TypeArgs);
-  TypeInstantiation TI{S, TypeArgs};
-  MonomorphizedNames[TI] = MonoName;
 
   SubstitutionMap Subs = buildSubstitutionMap(S, TypeArgs);
 
-  // Create field types with substitutions
-  std::vector<TypeRef> FieldTypes;
+  // Create the struct type with substituted field types
+  std::vector<std::pair<Identifier, llvm::Type *>> Fields;
   for (const auto &F : S->getFields()) {
-    FieldTypes.push_back(substituteType(F->getType(), Subs));
+    Fields.push_back(
+        {F->getIdentifier(), getLLVMType(substituteType(F->getType(), Subs))});
   }
+  layOutStruct(MonoName, S, Fields);
 
-  // Register field indices
-  unsigned Idx = 0;
-  for (const auto &F : S->getFields()) {
-    FieldIndices[MonoName][F->getId()] = Idx++;
-  }
-
-  // Create the struct type
-  getOrCreateStructType(MonoName, FieldTypes);
-
-  // Monomorphize methods
-  for (auto &Method : S->getMethods()) {
-    monomorphizeMethod(Method.get(), TypeArgs);
-  }
+  // Methods are instantiated when they are called
+  noteMonomorphized(S, MonoName);
 }
+
 void CodeGen::monomorphizeEnum(const EnumDecl *E,
                                const std::vector<TypeRef> &TypeArgs) {
   std::string MonoName = generateMonomorphizedName(E->getId(), TypeArgs);
-  TypeInstantiation TI{E, TypeArgs};
-  MonomorphizedNames[TI] = MonoName;
 
   SubstitutionMap Subs = buildSubstitutionMap(E, TypeArgs);
 
-  // Calculate variant info with substituted types
-  uint64_t MaxPayloadSize = 0;
-  unsigned Discriminant = 0;
+  std::vector<std::pair<std::string, llvm::Type *>> Variants;
   for (const auto &V : E->getVariants()) {
-    VariantDiscriminants[MonoName][V->getId()] = Discriminant++;
+    llvm::Type *PayloadTy = nullptr;
     if (V->hasPayload()) {
-      TypeRef SubPayload = substituteType(V->getPayloadType(), Subs);
-      llvm::Type *PayloadTy = getLLVMType(SubPayload);
-      VariantPayloadTypes[MonoName][V->getId()] = PayloadTy;
-      MaxPayloadSize = std::max(MaxPayloadSize, getTypeSize(PayloadTy));
+      PayloadTy = getLLVMType(substituteType(V->getPayloadType(), Subs));
     }
+    Variants.push_back({V->getId(), PayloadTy});
   }
+  layOutEnum(MonoName, E, Variants);
 
-  // Create enum type
-  std::vector<llvm::Type *> Members = {Builder.getInt32Ty()};
-  if (MaxPayloadSize > 0) {
-    Members.push_back(
-        llvm::ArrayType::get(Builder.getInt8Ty(), MaxPayloadSize));
-  }
-
-  auto It = StructTypes.find(MonoName);
-  if (It != StructTypes.end()) {
-    It->second->setBody(Members);
-  } else {
-    auto *ST = llvm::StructType::create(Context, Members, MonoName);
-    StructTypes[MonoName] = ST;
-  }
-
-  // Monomorphize methods
-  for (auto &Method : E->getMethods()) {
-    monomorphizeMethod(Method.get(), TypeArgs);
-  }
+  // Methods are instantiated when they are called
+  noteMonomorphized(E, MonoName);
 }
 
-void CodeGen::monomorphizeMethod(const MethodDecl *M,
-                                 const std::vector<TypeRef> &TypeArgs) {
+llvm::Function *
+CodeGen::monomorphizeMethod(const MethodDecl *M,
+                            const std::vector<TypeRef> &TypeArgs) {
   // For now, simpler case: methods on generic structs, but method itself not
   // generic additional args?
 
@@ -114,10 +123,7 @@ void CodeGen::monomorphizeMethod(const MethodDecl *M,
 
   // Note: we track methods by the method decl + type args of the parent
   // If the method ALSO has type args, that's a separate level of instantiation
-  // we likely fall into via discoverInExpr
-
-  TypeInstantiation TI{M, TypeArgs};
-  MonomorphizedNames[TI] = MonoMethodName;
+  // we likely fall into via type finalization
 
   // Build substitution map (using Struct/Enum type args)
   SubstitutionMap Subs;
@@ -130,32 +136,22 @@ void CodeGen::monomorphizeMethod(const MethodDecl *M,
   auto SavedSubs = CurrentSubs;
   CurrentSubs = Subs;
 
-  std::vector<llvm::Type *> ParamTypes;
-  for (const auto &P : M->getParams()) {
-    ParamTypes.push_back(getLLVMType(P->getType()));
-  }
-
-  llvm::Type *RetTy = getLLVMType(M->getReturnType());
+  auto *Fn = createLoweredFunction(MonoMethodName, M->getParams(),
+                                   M->getReturnType(), isExported(M));
 
   CurrentSubs = SavedSubs;
 
-  auto *FnTy = llvm::FunctionType::get(RetTy, ParamTypes, false);
-  auto *Fn = llvm::Function::Create(FnTy, llvm::Function::ExternalLinkage,
-                                    MonoMethodName, Module);
-
-  unsigned Idx = 0;
-  for (auto &Arg : Fn->args()) {
-    Arg.setName(M->getParams()[Idx++]->getId());
-  }
-
   MonomorphizedMethodQueue.push_back({M, TypeArgs, Fn});
+  DeclaredMethods.push_back({M, TypeArgs});
+  noteMonomorphized(M->getParent(), MonoParentName);
+  MonoReport[MonoReportIndex.lookup(MonoParentName)].Methods.push_back(
+      M->getId());
+  return Fn;
 }
 
 void CodeGen::monomorphizeFunction(const FunDecl *F,
                                    const std::vector<TypeRef> &TypeArgs) {
   std::string MonoName = generateMonomorphizedName(F->getId(), TypeArgs);
-  TypeInstantiation TI{F, TypeArgs};
-  MonomorphizedNames[TI] = MonoName;
 
   // Build the function signature
   SubstitutionMap Subs = buildSubstitutionMap(F, TypeArgs);
@@ -164,26 +160,42 @@ void CodeGen::monomorphizeFunction(const FunDecl *F,
   auto SavedSubs = CurrentSubs;
   CurrentSubs = Subs;
 
-  std::vector<llvm::Type *> ParamTypes;
-  for (const auto &P : F->getParams()) {
-    ParamTypes.push_back(getLLVMType(P->getType()));
-  }
-
-  llvm::Type *RetTy = getLLVMType(F->getReturnType());
+  auto *Fn = createLoweredFunction(MonoName, F->getParams(),
+                                   F->getReturnType(), isExported(F));
 
   CurrentSubs = SavedSubs;
 
-  auto *FnTy = llvm::FunctionType::get(RetTy, ParamTypes, false);
-  auto *Fn = llvm::Function::Create(FnTy, llvm::Function::ExternalLinkage,
-                                    MonoName, Module);
+  MonomorphizedFunctionQueue.push_back({F, TypeArgs, Fn});
+  noteMonomorphized(F, MonoName);
+}
+
+//===----------------------------------------------------------------------===//
+// Monomorphization Report
+//===----------------------------------------------------------------------===//
 
-  // Name parameters
-  unsigned Idx = 0;
-  for (auto &Arg : Fn->args()) {
-    Arg.setName(F->getParams()[Idx++]->getId());
+void CodeGen::noteMonomorphized(const ItemDecl *Generic,
+                                const std::string &MonoName) {
+  if (!MonoReportIndex.try_emplace(MonoName, MonoReport.size()).second) {
+    return;
   }
+  auto *Adt = llvm::dyn_cast<AdtDecl>(Generic);
+  MonoReport.push_back(
+      {MonoName, Adt != nullptr, Adt ? Adt->getMethods().size() : 0, {}});
+}
 
-  MonomorphizedFunctionQueue.push_back({F, TypeArgs, Fn});
+void CodeGen::printMonomorphizationReport(llvm::raw_ostream &OS) const {
+  OS << "Monomorphized instances: " << MonoReport.size() << "\n";
+  for (const auto &Entry : MonoReport) {
+    OS << "  " << Entry.Name;
+    if (Entry.IsAdt) {
+      OS << ": " << Entry.Methods.size() << " of " << Entry.NumMethods
+         << " methods";
+      if (!Entry.Methods.empty()) {
+        OS << " (" << llvm::join(Entry.Methods, ", ") << ")";
+      }
+    }
+    OS << "\n";
+  }
 }
 
 TypeRef CodeGen::substituteType(TypeRef T, const SubstitutionMap &Subs) {
@@ -219,26 +231,27 @@ TypeRef CodeGen::substituteType(TypeRef T, const SubstitutionMap &Subs) {
       }
     }
 
-    // Only create a new AppliedTy if something actually changed
+    // Only intern a new AppliedTy if something actually changed
     if (Changed) {
-      return TypeRef(new AppliedTy(ApT->getBase(), SubArgs), T.getSpan());
+      return TypeCtx::getApplied(ApT->getBase(), std::move(SubArgs),
+                                 T.getSpan());
     }
     return T;
   }
 
   if (auto *PT = llvm::dyn_cast<PtrTy>(Ptr)) {
-    return TypeRef(new PtrTy(substituteType(PT->getPointee(), Subs)),
-                   T.getSpan());
+    return TypeCtx::getPtr(substituteType(PT->getPointee(), Subs),
+                           T.getSpan());
   }
 
   if (auto *RT = llvm::dyn_cast<RefTy>(Ptr)) {
-    return TypeRef(new RefTy(substituteType(RT->getPointee(), Subs)),
-                   T.getSpan());
+    return TypeCtx::getRef(substituteType(RT->getPointee(), Subs),
+                           T.getSpan());
   }
 
   if (auto *AT = llvm::dyn_cast<ArrayTy>(Ptr)) {
-    return TypeRef(new ArrayTy(substituteType(AT->getContainedTy(), Subs)),
-                   T.getSpan());
+    return TypeCtx::getArray(substituteType(AT->getContainedTy(), Subs),
+                             T.getSpan(), AT->getLength());
   }
 
   if (auto *TT = llvm::dyn_cast<TupleTy>(Ptr)) {
@@ -246,7 +259,7 @@ TypeRef CodeGen::substituteType(TypeRef T, const SubstitutionMap &Subs) {
     for (const auto &Elem : TT->getElementTys()) {
       SubElems.push_back(substituteType(Elem, Subs));
     }
-    return TypeRef(new TupleTy(SubElems), T.getSpan());
+    return TypeCtx::getTuple(SubElems, T.getSpan());
   }
 
   if (auto *FT = llvm::dyn_cast<FunTy>(Ptr)) {
@@ -254,9 +267,8 @@ TypeRef CodeGen::substituteType(TypeRef T, const SubstitutionMap &Subs) {
     for (const auto &Param : FT->getParamTys()) {
       SubParams.push_back(substituteType(Param, Subs));
     }
-    return TypeRef(
-        new FunTy(SubParams, substituteType(FT->getReturnTy(), Subs)),
-        T.getSpan());
+    return TypeCtx::getFun(SubParams, substituteType(FT->getReturnTy(), Subs),
+                           T.getSpan());
   }
 
   return T;
@@ -295,12 +307,50 @@ CodeGen::buildSubstitutionMap(const AdtDecl *Decl,
   return Subs;
 }
 
+/// Spells type argument \p T the way its instance lowers it. A generic body
+/// can only pass a value of its type parameter around, never look through
+/// it, so every pointer, reference and function is spelled the same, and
+/// `Box<&A>` and `Box<&B>` share one instance.
+static std::string getLayoutKey(TypeRef T) {
+  const Type *Ptr = T.getPtr();
+
+  if (llvm::isa<PtrTy, RefTy, FunTy>(Ptr)) {
+    return "*ptr";
+  }
+
+  auto joinKeys = [](llvm::ArrayRef<TypeRef> Types) {
+    std::vector<std::string> Keys;
+    for (const auto &Elem : Types) {
+      Keys.push_back(getLayoutKey(Elem));
+    }
+    return llvm::join(Keys, ", ");
+  };
+
+  if (auto *ApT = llvm::dyn_cast<AppliedTy>(Ptr)) {
+    return ApT->getBase().toString() + "<" + joinKeys(ApT->getArgs()) + ">";
+  }
+
+  if (auto *TT = llvm::dyn_cast<TupleTy>(Ptr)) {
+    return "(" + joinKeys(TT->getElementTys()) + ")";
+  }
+
+  if (auto *AT = llvm::dyn_cast<ArrayTy>(Ptr)) {
+    std::string Elem = getLayoutKey(AT->getContainedTy());
+    if (auto Length = AT->getLength()) {
+      return "[" + Elem + "; " + std::to_string(*Length) + "]";
+    }
+    return "[" + Elem + "]";
+  }
+
+  return T.toString();
+}
+
 std::string
 CodeGen::generateMonomorphizedName(const std::string &BaseName,
                                    const std::vector<TypeRef> &TypeArgs) {
   std::string Result = BaseName;
   for (const auto &Arg : TypeArgs) {
-    Result += "_" + Arg.toString();
+    Result += "_" + getLayoutKey(Arg);
   }
   // Clean up any special characters
   for (char &C : Result) {
@@ -311,43 +361,316 @@ CodeGen::generateMonomorphizedName(const std::string &BaseName,
   return Result;
 }
 
+std::string CodeGen::getMonomorphizedName(const TypeInstantiation &TI) {
+  // Methods are instantiated per parent instance
+  if (auto *M = llvm::dyn_cast<MethodDecl>(TI.GenericDecl)) {
+    return generateMonomorphizedName(M->getParent()->getId(), TI.TypeArgs) +
+           "_" + M->getId();
+  }
+  return generateMonomorphizedName(TI.GenericDecl->getId(), TI.TypeArgs);
+}
+
+//===----------------------------------------------------------------------===//
+// Monomorphized Bodies
+//===----------------------------------------------------------------------===//
+
+// Instance bodies are lowered on worker threads, each into a module in its
+// own LLVMContext. A body can instantiate methods it calls, so this runs in
+// rounds: the methods a round declares get their bodies in the next one.
+// Each round is split into the same contiguous chunks whatever the thread
+// count, and the modules are linked in chunk order once every round is
+// done, so the output only depends on the program.
+
+/// Upper bound on the modules one round is split into. Every worker parses
+/// the declarations and copies the layout tables, so more chunks than cores
+/// only adds overhead.
+static constexpr size_t MaxBodyChunks = 16;
+
 void CodeGen::generateMonomorphizedBodies() {
+  std::vector<llvm::SmallVector<char, 0>> Bitcode;
   while (!MonomorphizedFunctionQueue.empty() ||
          !MonomorphizedMethodQueue.empty()) {
-    // Process functions
-    std::vector<MonomorphizedFun> Funs = std::move(MonomorphizedFunctionQueue);
-    MonomorphizedFunctionQueue.clear();
-    for (auto &MF : Funs) {
-      if (GeneratedMonomorphizedBodies.contains(MF.Fn->getName().str()))
-        continue;
+    std::vector<BodyJob> Jobs;
+    auto addJob = [&](const NamedDecl *Decl, const std::vector<TypeRef> &Args,
+                      llvm::Function *Fn) {
+      if (GeneratedMonomorphizedBodies.insert(Fn->getName().str()).second) {
+        Jobs.push_back({Decl, Args, Fn->getName().str()});
+      }
+    };
+    for (auto &MF : std::exchange(MonomorphizedFunctionQueue, {})) {
+      addJob(MF.Fun, MF.Args, MF.Fn);
+    }
+    for (auto &MM : std::exchange(MonomorphizedMethodQueue, {})) {
+      addJob(MM.Method, MM.Args, MM.Fn);
+    }
+    if (Jobs.empty()) {
+      break;
+    }
+
+    llvm::SmallVector<char, 0> Decls = writeDeclarations();
+    llvm::MemoryBufferRef DeclsRef(llvm::StringRef(Decls.data(), Decls.size()),
+                                   SourcePath);
+
+    size_t NumChunks = std::min(Jobs.size(), MaxBodyChunks);
+    size_t First = Bitcode.size();
+    Bitcode.resize(First + NumChunks);
+    std::vector<std::vector<TypeInstantiation>> Found(NumChunks);
+    llvm::parallelFor(0, NumChunks, [&](size_t I) {
+      size_t Begin = Jobs.size() * I / NumChunks;
+      size_t End = Jobs.size() * (I + 1) / NumChunks;
+      Bitcode[First + I] = generateBodiesInWorker(
+          DeclsRef, llvm::ArrayRef<BodyJob>(Jobs).slice(Begin, End - Begin),
+          Found[I]);
+    });
+
+    // Declare what the workers instantiated, so that their declarations
+    // resolve to ours and the bodies are queued for next round
+    for (const auto &Chunk : Found) {
+      for (const auto &TI : Chunk) {
+        getOrMonomorphizeMethod(llvm::cast<MethodDecl>(TI.GenericDecl),
+                                TI.TypeArgs);
+      }
+    }
+  }
+  linkWorkerModules(Bitcode);
+}
+
+void CodeGen::generateMonomorphizedBody(const NamedDecl *Decl,
+                                        const std::vector<TypeRef> &Args,
+                                        llvm::Function *Fn) {
+  auto SavedSubs = CurrentSubs;
+  if (auto *F = llvm::dyn_cast<FunDecl>(Decl)) {
+    CurrentSubs = buildSubstitutionMap(F, Args);
+    codegenFunctionBody(const_cast<FunDecl *>(F), Fn);
+  } else {
+    auto *M = llvm::cast<MethodDecl>(Decl);
+    CurrentSubs = buildSubstitutionMap(M->getParent(), Args);
+    codegenMethodBody(const_cast<MethodDecl *>(M), Fn);
+  }
+  CurrentSubs = SavedSubs;
+}
 
-      GeneratedMonomorphizedBodies.insert(MF.Fn->getName().str());
+llvm::SmallVector<char, 0> CodeGen::writeDeclarations() const {
+  // Functions become external declarations, which a worker either calls or
+  // defines. Globals are only referenced from bodies, so none is kept.
+  llvm::ValueToValueMapTy VMap;
+  auto Decls = llvm::CloneModule(
+      *Module, VMap, [](const llvm::GlobalValue *) { return false; });
+  for (auto &GV : llvm::make_early_inc_range(Decls->globals())) {
+    GV.eraseFromParent();
+  }
+  for (auto &Fn : *Decls) {
+    Fn.setLinkage(llvm::GlobalValue::ExternalLinkage);
+  }
+
+  llvm::SmallVector<char, 0> Bitcode;
+  llvm::raw_svector_ostream OS(Bitcode);
+  llvm::WriteBitcodeToFile(*Decls, OS);
+  return Bitcode;
+}
 
-      // Save/Restore substitution map
-      auto SavedSubs = CurrentSubs;
-      CurrentSubs = buildSubstitutionMap(MF.Fun, MF.Args);
+namespace {
 
-      codegenFunctionBody(const_cast<FunDecl *>(MF.Fun), MF.Fn);
+/// Recreates types of the main module's context in a worker's. A struct is
+/// looked up by name, which the declarations keep as they are, and created
+/// if no declaration mentions it.
+class TypeImporter {
+public:
+  explicit TypeImporter(llvm::LLVMContext &Context) : Context(Context) {}
 
-      CurrentSubs = SavedSubs;
+  llvm::Type *import(llvm::Type *Ty) {
+    if (!Ty) {
+      return nullptr;
+    }
+    if (auto It = Imported.find(Ty); It != Imported.end()) {
+      return It->second;
     }
 
-    // Process methods
-    std::vector<MonomorphizedMethod> Methods =
-        std::move(MonomorphizedMethodQueue);
-    MonomorphizedMethodQueue.clear();
-    for (auto &MM : Methods) {
-      if (GeneratedMonomorphizedBodies.contains(MM.Fn->getName().str()))
-        continue;
+    auto *ST = llvm::dyn_cast<llvm::StructType>(Ty);
+    if (ST && !ST->isLiteral()) {
+      auto *Ours = llvm::StructType::getTypeByName(Context, ST->getName());
+      if (!Ours) {
+        // Registered first, as the body may refer back to it
+        Ours = llvm::StructType::create(Context, ST->getName());
+        Imported[Ty] = Ours;
+        if (!ST->isOpaque()) {
+          Ours->setBody(importAll(ST->elements()), ST->isPacked());
+        }
+      }
+      return Imported[Ty] = Ours;
+    }
 
-      GeneratedMonomorphizedBodies.insert(MM.Fn->getName().str());
+    llvm::Type *Result = nullptr;
+    if (ST) {
+      Result = llvm::StructType::get(Context, importAll(ST->elements()),
+                                     ST->isPacked());
+    } else if (auto *AT = llvm::dyn_cast<llvm::ArrayType>(Ty)) {
+      Result = llvm::ArrayType::get(import(AT->getElementType()),
+                                    AT->getNumElements());
+    } else if (auto *FT = llvm::dyn_cast<llvm::FunctionType>(Ty)) {
+      Result = llvm::FunctionType::get(import(FT->getReturnType()),
+                                       importAll(FT->params()),
+                                       FT->isVarArg());
+    } else if (auto *IT = llvm::dyn_cast<llvm::IntegerType>(Ty)) {
+      Result = llvm::IntegerType::get(Context, IT->getBitWidth());
+    } else if (auto *PT = llvm::dyn_cast<llvm::PointerType>(Ty)) {
+      Result = llvm::PointerType::get(Context, PT->getAddressSpace());
+    } else {
+      Result = llvm::Type::getPrimitiveType(Context, Ty->getTypeID());
+    }
+    return Imported[Ty] = Result;
+  }
 
-      auto SavedSubs = CurrentSubs;
-      CurrentSubs = buildSubstitutionMap(MM.Method->getParent(), MM.Args);
+private:
+  std::vector<llvm::Type *> importAll(llvm::ArrayRef<llvm::Type *> Types) {
+    std::vector<llvm::Type *> Result;
+    for (llvm::Type *Ty : Types) {
+      Result.push_back(import(Ty));
+    }
+    return Result;
+  }
 
-      codegenMethodBody(const_cast<MethodDecl *>(MM.Method), MM.Fn);
+  llvm::LLVMContext &Context;
+  llvm::DenseMap<llvm::Type *, llvm::Type *> Imported;
+};
+
+} // namespace
+
+CodeGen::CodeGen(const CodeGen &Parent, llvm::MemoryBufferRef Decls)
+    : Ast(Parent.Ast), SourcePath(Parent.SourcePath), Context(),
+      Builder(Context, llvm::ConstantFolder(),
+              llvm::IRBuilderCallbackInserter(
+                  [this](llvm::Instruction *I) { alignMemoryAccess(I); })),
+      Module(llvm::cantFail(llvm::parseBitcodeFile(Decls, Context))),
+      IsWorker(true) {
+  TypeImporter Types(Context);
+  auto importFunction = [&](const llvm::Function *Fn) {
+    return Module->getFunction(Fn->getName());
+  };
+
+  for (const auto &Entry : Parent.StructTypes) {
+    StructTypes[Entry.getKey()] =
+        llvm::cast<llvm::StructType>(Types.import(Entry.getValue()));
+  }
+  for (const auto &[T, Ty] : Parent.TypeCache) {
+    TypeCache[T] = Types.import(Ty);
+  }
+  for (const auto &[F, Fn] : Parent.Functions) {
+    Functions[F] = importFunction(Fn);
+  }
+  for (const auto &[M, Fn] : Parent.Methods) {
+    Methods[M] = importFunction(Fn);
+  }
+  for (const auto &[Fn, ABI] : Parent.FunctionABIs) {
+    FunctionABI &Ours = FunctionABIs[importFunction(Fn)];
+    Ours.SRetTy = Types.import(ABI.SRetTy);
+    for (llvm::Type *Ty : ABI.IndirectParams) {
+      Ours.IndirectParams.push_back(Types.import(Ty));
+    }
+  }
+
+  FieldIndices = Parent.FieldIndices;
+  VariantDiscriminants = Parent.VariantDiscriminants;
+  for (const auto &[Enum, Payloads] : Parent.VariantPayloadTypes) {
+    for (const auto &[Variant, Ty] : Payloads) {
+      VariantPayloadTypes[Enum][Variant] = Types.import(Ty);
+    }
+  }
+  for (const auto &[Enum, Layout] : Parent.EnumLayouts) {
+    EnumLayout &Ours = EnumLayouts[Enum] = Layout;
+    Ours.TagTy =
+        llvm::cast_or_null<llvm::IntegerType>(Types.import(Layout.TagTy));
+    for (auto *N : {&Ours.DiscNiche, &Ours.Spare}) {
+      if (*N) {
+        (*N)->Ty = Types.import((*N)->Ty);
+      }
+    }
+  }
+  RequestedAligns = Parent.RequestedAligns;
+  HasPackedStructs = Parent.HasPackedStructs;
 
-      CurrentSubs = SavedSubs;
+  QueuedInstances = Parent.QueuedInstances;
+  MonomorphizedInstances = Parent.MonomorphizedInstances;
+  MonoReport = Parent.MonoReport;
+  MonoReportIndex = Parent.MonoReportIndex;
+}
+
+llvm::SmallVector<char, 0>
+CodeGen::generateBodiesInWorker(llvm::MemoryBufferRef Decls,
+                                llvm::ArrayRef<BodyJob> Jobs,
+                                std::vector<TypeInstantiation> &Found) const {
+  CodeGen Worker(*this, Decls);
+  for (const auto &Job : Jobs) {
+    llvm::Function *Fn = Worker.Module->getFunction(Job.Name);
+    // Bitcode keeps no argument names for a declaration
+    for (auto [Ours, Theirs] :
+         llvm::zip(Fn->args(), Module->getFunction(Job.Name)->args())) {
+      Ours.setName(Theirs.getName());
     }
+    Worker.generateMonomorphizedBody(Job.Decl, Job.Args, Fn);
   }
+  Found = std::move(Worker.DeclaredMethods);
+
+  // The methods declared here are defined in another module, which the
+  // linker only resolves for an external declaration
+  for (auto &Fn : *Worker.Module) {
+    if (Fn.isDeclaration()) {
+      Fn.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    }
+  }
+
+  llvm::SmallVector<char, 0> Bitcode;
+  llvm::raw_svector_ostream OS(Bitcode);
+  llvm::WriteBitcodeToFile(*Worker.Module, OS);
+  return Bitcode;
+}
+
+void CodeGen::linkWorkerModules(
+    llvm::ArrayRef<llvm::SmallVector<char, 0>> Bitcode) {
+  if (Bitcode.empty()) {
+    return;
+  }
+
+  // The linker only resolves a declaration against an external definition
+  // and the other way around, so internal functions are external for the
+  // link and get their own linkage back after it
+  std::vector<std::pair<std::string, llvm::GlobalValue::LinkageTypes>>
+      Internal;
+  for (auto &Fn : *Module) {
+    if (Fn.hasLocalLinkage()) {
+      Internal.push_back({Fn.getName().str(), Fn.getLinkage()});
+      Fn.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    }
+  }
+
+  // This module is linked into a new one like the workers' are, so that
+  // struct types the linker folds by layout are folded alike in all of them
+  auto Linked =
+      std::make_unique<llvm::Module>(Module->getModuleIdentifier(), Context);
+  Linked->setTargetTriple(Module->getTargetTriple());
+  Linked->setDataLayout(Module->getDataLayout());
+  llvm::Linker L(*Linked);
+  bool Failed = L.linkInModule(std::move(Module));
+  for (const auto &Buffer : Bitcode) {
+    llvm::MemoryBufferRef Ref(llvm::StringRef(Buffer.data(), Buffer.size()),
+                              SourcePath);
+    Failed |=
+        L.linkInModule(llvm::cantFail(llvm::parseBitcodeFile(Ref, Context)));
+  }
+  if (Failed) {
+    throw std::runtime_error("Could not link the monomorphized bodies");
+  }
+  Module = std::move(Linked);
+
+  for (const auto &[Name, Linkage] : Internal) {
+    if (auto *Fn = Module->getFunction(Name)) {
+      Fn->setLinkage(Linkage);
+    }
+  }
+
+  // These point into the module that was linked away
+  Functions.clear();
+  Methods.clear();
+  FunctionABIs.clear();
+  PrintFn = nullptr;
 }
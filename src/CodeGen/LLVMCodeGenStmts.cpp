@@ -8,144 +8,38 @@
 using namespace phi;
 
 //===----------------------------------------------------------------------===//
-// Phase 3: Desugaring
+// Phase 4: Statement Codegen
 //===----------------------------------------------------------------------===//
 
-void CodeGen::desugar() {
-  for (auto *M : Ast) {
-    desugarModule(M);
-  }
-}
-
-void CodeGen::desugarModule(ModuleDecl *M) {
-  for (auto &Item : M->getItems()) {
-    if (auto *F = llvm::dyn_cast<FunDecl>(Item.get())) {
-      desugarFunction(F);
-    } else if (auto *S = llvm::dyn_cast<StructDecl>(Item.get())) {
-      for (auto &Method : S->getMethods()) {
-        desugarMethod(Method.get());
-      }
-    } else if (auto *E = llvm::dyn_cast<EnumDecl>(Item.get())) {
-      for (auto &Method : E->getMethods()) {
-        desugarMethod(Method.get());
-      }
-    }
-  }
-}
-
-void CodeGen::desugarFunction(FunDecl *F) { desugarBlock(&F->getBody()); }
-
-void CodeGen::desugarMethod(MethodDecl *M) { desugarBlock(&M->getBody()); }
-
-void CodeGen::desugarBlock(Block *B) {
+void CodeGen::codegenBlock(Block *B) {
+  DeferStack.emplace_back();
   for (auto &S : B->getStmts()) {
-    desugarStmt(S.get());
+    if (hasTerminator())
+      break;
+    codegenStmt(S.get());
   }
-}
 
-void CodeGen::desugarStmt(Stmt *S) {
-  if (auto *DS = llvm::dyn_cast<DeclStmt>(S)) {
-    if (DS->hasInit()) {
-      desugarExpr(&DS->getInit());
-    }
-  } else if (auto *RS = llvm::dyn_cast<ReturnStmt>(S)) {
-    if (RS->hasExpr()) {
-      desugarExpr(&RS->getExpr());
-    }
-  } else if (auto *IS = llvm::dyn_cast<IfStmt>(S)) {
-    desugarExpr(&IS->getCond());
-    desugarBlock(&IS->getThen());
-    if (IS->hasElse()) {
-      desugarBlock(&IS->getElse());
-    }
-  } else if (auto *WS = llvm::dyn_cast<WhileStmt>(S)) {
-    desugarExpr(&WS->getCond());
-    desugarBlock(&WS->getBody());
-  } else if (auto *FS = llvm::dyn_cast<ForStmt>(S)) {
-    desugarExpr(&FS->getRange());
-    desugarBlock(&FS->getBody());
-  } else if (auto *ES = llvm::dyn_cast<ExprStmt>(S)) {
-    desugarExpr(&ES->getExpr());
+  // Falling off the end runs this block's deferred expressions; every exit
+  // that jumps out has already run them
+  if (!hasTerminator()) {
+    emitDeferred(DeferStack.size() - 1);
   }
+  DeferStack.pop_back();
 }
 
-void CodeGen::desugarExpr(Expr *E) {
-  if (!E)
-    return;
-
-  // Recursively process child expressions first
-  if (auto *AI = llvm::dyn_cast<AdtInit>(E)) {
-    for (auto &Init : AI->getInits()) {
-      desugarExpr(Init->getInitValue());
-    }
-  } else if (auto *FC = llvm::dyn_cast<FunCallExpr>(E)) {
-    for (auto &Arg : FC->getArgs()) {
-      desugarExpr(Arg.get());
-    }
-  } else if (auto *MC = llvm::dyn_cast<MethodCallExpr>(E)) {
-    desugarExpr(MC->getBase());
-    for (auto &Arg : MC->getArgs()) {
-      desugarExpr(Arg.get());
-    }
-    // Note: actual method->function transformation happens in codegen
-  } else if (auto *BO = llvm::dyn_cast<BinaryOp>(E)) {
-    desugarExpr(&BO->getLhs());
-    desugarExpr(&BO->getRhs());
-  } else if (auto *UO = llvm::dyn_cast<UnaryOp>(E)) {
-    desugarExpr(&UO->getOperand());
-  } else if (auto *FA = llvm::dyn_cast<FieldAccessExpr>(E)) {
-    desugarExpr(FA->getBase());
-  } else if (auto *ME = llvm::dyn_cast<MatchExpr>(E)) {
-    desugarExpr(ME->getScrutinee());
-    for (auto &Arm : ME->getArms()) {
-      desugarBlock(Arm.Body.get());
-      if (Arm.Return)
-        desugarExpr(Arm.Return);
-    }
-  } else if (auto *IE = llvm::dyn_cast<TupleIndex>(E)) {
-    desugarExpr(IE->getBase());
-    desugarExpr(IE->getIndex());
-  } else if (auto *TL = llvm::dyn_cast<TupleLiteral>(E)) {
-    for (auto &Elem : TL->getElements()) {
-      desugarExpr(Elem.get());
+void CodeGen::emitDeferred(size_t Depth) {
+  for (size_t I = DeferStack.size(); I > Depth; --I) {
+    for (Expr *E : llvm::reverse(DeferStack[I - 1])) {
+      codegenExpr(E);
     }
   }
-  // TODO: ArrayLiteral desugar
-}
-
-//===----------------------------------------------------------------------===//
-// Phase 4: Statement Codegen
-//===----------------------------------------------------------------------===//
-
-void CodeGen::codegenBlock(Block *B) {
-  for (auto &S : B->getStmts()) {
-    if (hasTerminator())
-      break;
-    codegenStmt(S.get());
-  }
 }
 
 void CodeGen::codegenStmt(Stmt *S) {
-  if (auto *DS = llvm::dyn_cast<DeclStmt>(S)) {
-    codegenDeclStmt(DS);
-  } else if (auto *RS = llvm::dyn_cast<ReturnStmt>(S)) {
-    codegenReturnStmt(RS);
-  } else if (auto *IS = llvm::dyn_cast<IfStmt>(S)) {
-    codegenIfStmt(IS);
-  } else if (auto *WS = llvm::dyn_cast<WhileStmt>(S)) {
-    codegenWhileStmt(WS);
-  } else if (auto *FS = llvm::dyn_cast<ForStmt>(S)) {
-    codegenForStmt(FS);
-  } else if (auto *BS = llvm::dyn_cast<BreakStmt>(S)) {
-    codegenBreakStmt(BS);
-  } else if (auto *CS = llvm::dyn_cast<ContinueStmt>(S)) {
-    codegenContinueStmt(CS);
-  } else if (auto *ES = llvm::dyn_cast<ExprStmt>(S)) {
-    codegenExprStmt(ES);
-  }
+  dispatch(*S, [this](auto &X) { codegen(&X); });
 }
 
-void CodeGen::codegenDeclStmt(DeclStmt *S) {
+void CodeGen::codegen(DeclStmt *S) {
   auto &Decls = S->getDecls();
   bool IsDestructure = Decls.size() > 1;
 
@@ -159,33 +53,47 @@ void CodeGen::codegenDeclStmt(DeclStmt *S) {
     auto &Decl = *Decls[I];
     llvm::Type *Ty = getLLVMType(Decl.getType());
 
+    llvm::Value *Val = nullptr;
+    if (InitVal) {
+      Val = IsDestructure ? Builder.CreateExtractValue(InitVal, I)
+                          : coerceValue(InitVal, Decl.getType());
+    }
+
+    // A constant table that is only read needs no copy of its own
+    if (Val && isConstantTable(Val) && Val->getType() == Ty &&
+        !WrittenLocals.contains(&Decl)) {
+      NamedValues[&Decl] = getConstantGlobal(llvm::cast<llvm::Constant>(Val));
+      continue;
+    }
+
     auto *Alloca = createEntryBlockAlloca(CurrentFunction, Decl.getId(), Ty);
     NamedValues[&Decl] = Alloca;
 
-    if (InitVal) {
-      llvm::Value *Val = IsDestructure
-          ? Builder.CreateExtractValue(InitVal, I)
-          : InitVal;
-
+    if (Val) {
       if (Val->getType() != Alloca->getAllocatedType()) {
         llvm::errs() << "TYPE MISMATCH IN STORE!\n";
       }
-
-      Builder.CreateStore(Val, Alloca);
+      storeValue(Val, Alloca);
     }
   }
 }
 
-void CodeGen::codegenReturnStmt(ReturnStmt *S) {
-  if (S->hasExpr()) {
-    llvm::Value *RetVal = codegenExpr(&S->getExpr());
-    Builder.CreateRet(RetVal);
+void CodeGen::codegen(ReturnStmt *S) {
+  // The value is computed before any deferred expression runs
+  llvm::Value *Val = S->hasExpr() ? codegenExpr(&S->getExpr()) : nullptr;
+  emitDeferred(0);
+  if (Val) {
+    emitReturn(Val);
   } else {
     Builder.CreateRetVoid();
   }
 }
 
-void CodeGen::codegenIfStmt(IfStmt *S) {
+void CodeGen::codegen(DeferStmt *S) {
+  DeferStack.back().push_back(&S->getDeferred());
+}
+
+void CodeGen::codegen(IfStmt *S) {
   llvm::Value *Cond = codegenExpr(&S->getCond());
 
   // Convert to i1 if needed
@@ -217,7 +125,7 @@ void CodeGen::codegenIfStmt(IfStmt *S) {
   Builder.SetInsertPoint(MergeBB);
 }
 
-void CodeGen::codegenWhileStmt(WhileStmt *S) {
+void CodeGen::codegen(WhileStmt *S) {
   auto *CondBB =
       llvm::BasicBlock::Create(Context, "while.cond", CurrentFunction);
   auto *BodyBB =
@@ -238,7 +146,7 @@ void CodeGen::codegenWhileStmt(WhileStmt *S) {
 
   // Body
   Builder.SetInsertPoint(BodyBB);
-  LoopStack.emplace_back(CondBB, AfterBB);
+  LoopStack.emplace_back(CondBB, AfterBB, DeferStack.size());
   codegenBlock(&S->getBody());
   LoopStack.pop_back();
   if (!hasTerminator())
@@ -247,7 +155,7 @@ void CodeGen::codegenWhileStmt(WhileStmt *S) {
   Builder.SetInsertPoint(AfterBB);
 }
 
-void CodeGen::codegenForStmt(ForStmt *S) {
+void CodeGen::codegen(ForStmt *S) {
   // For now, simplified: for x in start..end
   auto *InitBB = llvm::BasicBlock::Create(Context, "for.init", CurrentFunction);
   auto *CondBB = llvm::BasicBlock::Create(Context, "for.cond", CurrentFunction);
@@ -280,7 +188,7 @@ void CodeGen::codegenForStmt(ForStmt *S) {
 
     // Body
     Builder.SetInsertPoint(BodyBB);
-    LoopStack.emplace_back(IncBB, AfterBB);
+    LoopStack.emplace_back(IncBB, AfterBB, DeferStack.size());
     codegenBlock(&S->getBody());
     LoopStack.pop_back();
     if (!hasTerminator())
@@ -307,16 +215,22 @@ void CodeGen::codegenForStmt(ForStmt *S) {
   Builder.SetInsertPoint(AfterBB);
 }
 
-void CodeGen::codegenBreakStmt(BreakStmt * /*S*/) {
+void CodeGen::codegen(BreakStmt * /*S*/) {
   if (!LoopStack.empty()) {
+    emitDeferred(LoopStack.back().DeferDepth);
     Builder.CreateBr(LoopStack.back().AfterBB);
   }
 }
 
-void CodeGen::codegenContinueStmt(ContinueStmt * /*S*/) {
+void CodeGen::codegen(ContinueStmt * /*S*/) {
   if (!LoopStack.empty()) {
+    emitDeferred(LoopStack.back().DeferDepth);
     Builder.CreateBr(LoopStack.back().CondBB);
   }
 }
 
-void CodeGen::codegenExprStmt(ExprStmt *S) { codegenExpr(&S->getExpr()); }
+void CodeGen::codegen(ExprStmt *S) { codegenExpr(&S->getExpr()); }
+
+// Imports and uses only affect name resolution
+void CodeGen::codegen(ImportStmt * /*S*/) {}
+void CodeGen::codegen(UseStmt * /*S*/) {}
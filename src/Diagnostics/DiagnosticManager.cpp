@@ -6,6 +6,13 @@
 
 namespace phi {
 
+namespace {
+
+/// Buffer of the innermost ThreadCapture on this thread, or null
+thread_local std::vector<Diagnostic> *CaptureBuffer = nullptr;
+
+} // namespace
+
 /**
  * Constructs a diagnostic manager with source manager and configuration.
  */
@@ -21,6 +28,11 @@ DiagnosticManager::DiagnosticManager(DiagnosticConfig Config)
  * Also tracks error and warning counts for compilation status.
  */
 void DiagnosticManager::emit(const Diagnostic &Diag, std::ostream &Out) const {
+  if (CaptureBuffer) {
+    CaptureBuffer->push_back(Diag);
+    return;
+  }
+
   renderDiagnostic(Diag, Out);
 
   // Update error/warning counters
@@ -31,6 +43,13 @@ void DiagnosticManager::emit(const Diagnostic &Diag, std::ostream &Out) const {
   }
 }
 
+DiagnosticManager::ThreadCapture::ThreadCapture(std::vector<Diagnostic> &Buffer)
+    : Previous(CaptureBuffer) {
+  CaptureBuffer = &Buffer;
+}
+
+DiagnosticManager::ThreadCapture::~ThreadCapture() { CaptureBuffer = Previous; }
+
 /**
  * Renders a complete diagnostic with all components:
  * 1. Header with error code and message
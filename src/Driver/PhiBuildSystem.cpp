@@ -3,6 +3,10 @@
 #include <fstream>
 #include <print>
 
+#include <llvm/ADT/ScopeExit.h>
+#include <llvm/ADT/Statistic.h>
+#include <llvm/Support/Timer.h>
+
 #include "CodeGen/LLVMCodeGen.hpp"
 #include "Lexer/Lexer.hpp"
 #include "Parser/Parser.hpp"
@@ -37,8 +41,11 @@ bool PhiBuildSystem::compileSingleFile(const fs::path &SourceFile,
     llvm::outs() << "[Phi] Output: " << OutputPath << "\n";
   }
 
+  enableStats(Opts);
+  auto PrintStats = llvm::make_scope_exit([&] { printStats(Opts); });
+
   DiagnosticManager Diags;
-  return compileFile(SourceFile, OutputPath, Opts.IsRelease, Diags);
+  return compileFile(SourceFile, OutputPath, Opts, Diags);
 }
 
 //===----------------------------------------------------------------------===//
@@ -65,6 +72,9 @@ bool PhiBuildSystem::buildProject(const CompilerOptions &Opts) {
     llvm::outs() << "[Phi] Project root: " << ProjectRoot << "\n";
   }
 
+  enableStats(Opts);
+  auto PrintStats = llvm::make_scope_exit([&] { printStats(Opts); });
+
   // Create and load project (discovers all .phi files in src/)
   PhiProject Project(ProjectRoot, Opts.IsRelease);
 
@@ -114,13 +124,19 @@ bool PhiBuildSystem::buildProject(const CompilerOptions &Opts) {
     Modules.push_back(Mod.get());
   }
 
-  if (!Sema(Modules, &Diags).analyze()) {
+  if (!Sema(Modules, &Diags, Opts.CheckAll).analyze()) {
     return false;
   }
 
   // Code generation
   CodeGen CodeGen(Modules);
   CodeGen.generate();
+  if (Opts.MonoReport) {
+    CodeGen.printMonomorphizationReport(llvm::errs());
+  }
+  if (Opts.LayoutReport) {
+    CodeGen.printLayoutReport(llvm::errs());
+  }
 
   // Output IR to build dir
   // For now, output the main module to main.ll
@@ -246,7 +262,8 @@ void PhiBuildSystem::clean() {
 //===----------------------------------------------------------------------===//
 
 bool PhiBuildSystem::compileFile(const fs::path &SourceFile,
-                                 const fs::path &OutputFile, bool IsRelease,
+                                 const fs::path &OutputFile,
+                                 const CompilerOptions &Opts,
                                  DiagnosticManager &Diags) {
   // Read source
   std::ifstream FileStream(SourceFile);
@@ -281,6 +298,11 @@ bool PhiBuildSystem::compileFile(const fs::path &SourceFile,
     return false;
   }
 
+  // Only bodies reachable from main are inferred and lowered
+  if (!Opts.CheckAll) {
+    Reachability(Resolved).run();
+  }
+
   // Type inference
   auto Checked = TypeInferencer(Resolved, &Diags).infer();
 
@@ -291,6 +313,12 @@ bool PhiBuildSystem::compileFile(const fs::path &SourceFile,
   // Code generation
   CodeGen CodeGen(Checked);
   CodeGen.generate();
+  if (Opts.MonoReport) {
+    CodeGen.printMonomorphizationReport(llvm::errs());
+  }
+  if (Opts.LayoutReport) {
+    CodeGen.printLayoutReport(llvm::errs());
+  }
 
   // Output IR
   std::string IRFilename = OutputFile.string();
@@ -346,6 +374,33 @@ void PhiBuildSystem::linkObjects(PhiProject &Project) {
   std::system(Cmd.c_str());
 }
 
+//===----------------------------------------------------------------------===//
+// Statistics Helpers
+//===----------------------------------------------------------------------===//
+
+void PhiBuildSystem::enableStats(const CompilerOptions &Opts) {
+  if (Opts.Stats) {
+    llvm::EnableStatistics(/*DoPrintOnExit=*/false);
+  }
+}
+
+void PhiBuildSystem::printStats(const CompilerOptions &Opts) {
+  if (!Opts.Stats) {
+    return;
+  }
+
+  // The JSON report already includes every timer group
+  if (*Opts.Stats == StatsFormat::Json) {
+    llvm::PrintStatisticsJSON(llvm::errs());
+  } else {
+    llvm::PrintStatistics(llvm::errs());
+    llvm::TimerGroup::printAll(llvm::errs());
+  }
+
+  // Otherwise the timer groups report again when they are destroyed at exit
+  llvm::TimerGroup::clearAll();
+}
+
 //===----------------------------------------------------------------------===//
 // Project Config Helpers
 //===----------------------------------------------------------------------===//
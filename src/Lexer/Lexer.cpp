@@ -110,6 +110,8 @@ Token Lexer::scanToken() {
     return makeToken(TokenKind::Comma);
   case ';':
     return makeToken(TokenKind::Semicolon);
+  case '#':
+    return makeToken(TokenKind::Hash);
 
   case '.':
     if (matchNextN(".="))
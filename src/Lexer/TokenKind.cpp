@@ -126,6 +126,8 @@ std::string TokenKind::toString() const {
     return "COMMA";
   case TokenKind::Semicolon:
     return "SEMICOLON";
+  case TokenKind::Hash:
+    return "HASH";
 
   // Basic operators
   case TokenKind::Plus:
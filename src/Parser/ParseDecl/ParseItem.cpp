@@ -32,6 +32,39 @@ std::optional<Visibility> Parser::parseItemVisibility() {
   }
 }
 
+std::vector<Attribute> Parser::parseAttributes() {
+  std::vector<Attribute> Attrs;
+  while (peekKind() == TokenKind::Hash) {
+    SrcLocation Start = advanceToken().getStart();
+    if (!expectToken(TokenKind::OpenBracket, "attribute")) {
+      continue;
+    }
+    auto Name = expectToken(TokenKind::Identifier, "attribute name");
+    if (!Name) {
+      syncTo(TokenKind::CloseBracket);
+      matchToken(TokenKind::CloseBracket);
+      continue;
+    }
+
+    Attribute Attr{Name->getSpan(), Name->getLexeme(), {}};
+    if (matchToken(TokenKind::OpenParen)) {
+      while (!atEOF() && !matchToken(TokenKind::CloseParen)) {
+        Attr.Args.push_back(advanceToken().getLexeme());
+        if (peekKind() != TokenKind::CloseParen) {
+          expectToken(TokenKind::Comma, "attribute arguments");
+        }
+      }
+    }
+    // Names and arguments are checked by the name resolver
+    auto Close = expectToken(TokenKind::CloseBracket, "attribute");
+    if (Close) {
+      Attr.Span = SrcSpan(Start, Close->getEnd());
+      Attrs.push_back(std::move(Attr));
+    }
+  }
+  return Attrs;
+}
+
 std::optional<std::vector<std::unique_ptr<TypeArgDecl>>>
 Parser::parseTypeArgDecls() {
   if (peekKind() != TokenKind::OpenCaret) {
@@ -47,8 +80,7 @@ Parser::parseTypeArgDecls() {
         }
 
         auto Span = Tok->getSpan();
-        auto Id = Tok->getLexeme();
-        return std::make_unique<TypeArgDecl>(Span, Id);
+        return std::make_unique<TypeArgDecl>(Span, Tok->getIdentifier());
       });
   if (!Res)
     return std::nullopt;
@@ -80,7 +112,7 @@ std::unique_ptr<FunDecl> Parser::parseFunDecl(Visibility Vis) {
         .emit(*Diags);
     return nullptr;
   }
-  std::string Id = peekToken().getLexeme();
+  Identifier Id = peekToken().getIdentifier();
   SrcSpan Span = advanceToken().getSpan();
 
   auto TypeArgs = parseTypeArgDecls();
@@ -117,7 +149,7 @@ std::unique_ptr<EnumDecl> Parser::parseEnumDecl(Visibility Vis) {
   assert(advanceToken().getKind() == TokenKind::EnumKw);
   expectToken(TokenKind::Identifier, "", false);
   SrcSpan Span = peekToken().getSpan();
-  std::string Id = advanceToken().getLexeme();
+  Identifier Id = advanceToken().getIdentifier();
 
   auto TypeArgs = parseTypeArgDecls();
   if (!TypeArgs) {
@@ -141,14 +173,14 @@ std::unique_ptr<EnumDecl> Parser::parseEnumDecl(Visibility Vis) {
 
     switch (peekKind()) {
     case TokenKind::FunKw:
-      if (auto Res = parseMethodDecl(Id, *Visibility)) {
+      if (auto Res = parseMethodDecl(Id.str(), *Visibility)) {
         if (!Res->getParams().empty() &&
             Res->getParams().front()->getId() == "this") {
           Methods.push_back(std::move(Res));
         } else {
           auto MethodId = Res->getId();
           desugarStaticMethod(
-              Id, MethodId, *TypeArgs, std::move(Res->getTypeArgs()),
+              Id.str(), MethodId, *TypeArgs, std::move(Res->getTypeArgs()),
               std::move(Res->getParams()), Res->getReturnType(),
               std::make_unique<Block>(std::move(Res->getBody())),
               Res->getSpan(), Res->getVisibility());
@@ -185,7 +217,7 @@ std::unique_ptr<StructDecl> Parser::parseStructDecl(Visibility Vis) {
   assert(advanceToken().getKind() == TokenKind::StructKw);
   expectToken(TokenKind::Identifier, "struct declaration", false);
   SrcSpan Span = peekToken().getSpan();
-  std::string Id = advanceToken().getLexeme();
+  Identifier Id = advanceToken().getIdentifier();
 
   auto TypeArgs = parseTypeArgDecls();
   if (!TypeArgs) {
@@ -210,14 +242,14 @@ std::unique_ptr<StructDecl> Parser::parseStructDecl(Visibility Vis) {
 
     switch (peekKind()) {
     case TokenKind::FunKw:
-      if (auto Res = parseMethodDecl(Id, *Visibility)) {
+      if (auto Res = parseMethodDecl(Id.str(), *Visibility)) {
         if (!Res->getParams().empty() &&
             Res->getParams().front()->getId() == "this") {
           Methods.push_back(std::move(Res));
         } else {
           auto MethodId = Res->getId();
           desugarStaticMethod(
-              Id, MethodId, *TypeArgs, std::move(Res->getTypeArgs()),
+              Id.str(), MethodId, *TypeArgs, std::move(Res->getTypeArgs()),
               std::move(Res->getParams()), Res->getReturnType(),
               std::make_unique<Block>(std::move(Res->getBody())),
               Res->getSpan(), Res->getVisibility());
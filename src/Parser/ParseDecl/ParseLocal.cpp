@@ -55,7 +55,7 @@ Parser::parseBinding(const BindingPolicy &Policy) {
   // Parse variable names
   //===------------------------------------------------------------------===//
 
-  std::vector<std::string> Names;
+  std::vector<Identifier> Names;
   std::vector<std::optional<TypeRef>> TypeAnnotations;
   SrcSpan Span = peekToken().getSpan();
 
@@ -68,10 +68,10 @@ Parser::parseBinding(const BindingPolicy &Policy) {
   }
 
   if (peekKind() == TokenKind::Identifier) {
-    Names.push_back(advanceToken().getLexeme());
+    Names.push_back(advanceToken().getIdentifier());
     TypeAnnotations.push_back(parseOptTypeAnnotation(Policy));
   } else if (peekKind() == TokenKind::OpenParen) {
-    using Var = std::pair<std::string, std::optional<TypeRef>>;
+    using Var = std::pair<Identifier, std::optional<TypeRef>>;
     auto Res = parseValueList<Var>(
         TokenKind::OpenParen, TokenKind::CloseParen,
         [&]() -> std::optional<Var> {
@@ -81,7 +81,8 @@ Parser::parseBinding(const BindingPolicy &Policy) {
           }
 
           return std::make_optional(
-              std::make_pair(Tok->getLexeme(), parseOptTypeAnnotation(Policy)));
+              std::make_pair(Tok->getIdentifier(),
+                             parseOptTypeAnnotation(Policy)));
         });
 
     if (!Res) {
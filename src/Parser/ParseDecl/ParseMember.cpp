@@ -34,10 +34,11 @@ std::unique_ptr<ParamDecl> Parser::parseMethodParam(std::string ParentName) {
   }
 
   auto Constness = parseMutability();
-  auto Base = TypeCtx::getAdt(ParentName, nullptr, peekToken().getSpan());
+  auto Base =
+      TypeCtx::getAdt(Identifier(ParentName), nullptr, peekToken().getSpan());
   auto Ty = TypeCtx::getRef(Base, peekToken().getSpan());
   return std::make_unique<ParamDecl>(advanceToken().getSpan(), *Constness,
-                                     "this", Ty);
+                                     Identifier("this"), Ty);
 }
 
 std::unique_ptr<MethodDecl> Parser::parseMethodDecl(std::string ParentName,
@@ -56,7 +57,7 @@ std::unique_ptr<MethodDecl> Parser::parseMethodDecl(std::string ParentName,
     return nullptr;
   }
   SrcSpan Span = peekToken().getSpan();
-  std::string Id = advanceToken().getLexeme();
+  Identifier Id = advanceToken().getIdentifier();
 
   auto TypeArgs = parseTypeArgDecls();
   if (!TypeArgs) {
@@ -131,7 +132,7 @@ std::unique_ptr<StructDecl> Parser::parseAnonymousStruct() {
   static uint32_t AnonymousStructCounter = 0;
   std::string StructId = std::format("@struct_{}", ++AnonymousStructCounter);
   return std::make_unique<StructDecl>(
-      SrcSpan(Start, End), Visibility::Public, StructId,
+      SrcSpan(Start, End), Visibility::Public, Identifier(StructId),
       std::vector<std::unique_ptr<TypeArgDecl>>{}, std::move(*Fields),
       std::vector<std::unique_ptr<MethodDecl>>{});
 }
@@ -139,7 +140,7 @@ std::unique_ptr<StructDecl> Parser::parseAnonymousStruct() {
 std::unique_ptr<VariantDecl> Parser::parseVariantDecl() {
   assert(peekToken().getKind() == TokenKind::Identifier);
   SrcSpan Span = peekToken().getSpan();
-  std::string Id = advanceToken().getLexeme();
+  Identifier Id = advanceToken().getIdentifier();
 
   // Comma or close brace indicates a variant with no payload;
   // parsing is trivial so we return early
@@ -161,7 +162,8 @@ std::unique_ptr<VariantDecl> Parser::parseVariantDecl() {
     if (!Res)
       return nullptr;
 
-    PayloadType = TypeCtx::getAdt(Res->getId(), Res.get(), Res->getSpan());
+    PayloadType =
+        TypeCtx::getAdt(Res->getIdentifier(), Res.get(), Res->getSpan());
     Ast.push_back(std::move(Res));
   }
 
@@ -192,7 +194,7 @@ replaceTypeDecl(TypeRef T,
     auto *GenTy = (GenericTy *)T.getPtr();
     for (size_t i = 0; i < OldDecls.size(); ++i) {
       if (GenTy->getDecl() == OldDecls[i].get()) {
-        return TypeCtx::getGeneric(GenTy->getId(), NewDecls[i].get(),
+        return TypeCtx::getGeneric(GenTy->getIdentifier(), NewDecls[i].get(),
                                    T.getSpan());
       }
     }
@@ -249,7 +251,7 @@ replaceTypeDecl(TypeRef T,
     auto *ArrTy = (ArrayTy *)T.getPtr();
     return TypeCtx::getArray(
         replaceTypeDecl(ArrTy->getContainedTy(), OldDecls, NewDecls),
-        T.getSpan());
+        T.getSpan(), ArrTy->getLength());
   }
 
   return T;
@@ -269,7 +271,7 @@ void Parser::desugarStaticMethod(
   // Clone parent type args
   for (const auto &Arg : ParentTypeArgs) {
     CombinedTypeArgs.push_back(
-        std::make_unique<TypeArgDecl>(Arg->getSpan(), Arg->getId()));
+        std::make_unique<TypeArgDecl>(Arg->getSpan(), Arg->getIdentifier()));
   }
 
   // Move method type args
@@ -283,14 +285,15 @@ void Parser::desugarStaticMethod(
     auto NewType =
         replaceTypeDecl(Param->getType(), ParentTypeArgs, CombinedTypeArgs);
     UpdatedParams.push_back(std::make_unique<ParamDecl>(
-        Param->getSpan(), Param->getMutability(), Param->getId(), NewType));
+        Param->getSpan(), Param->getMutability(), Param->getIdentifier(),
+        NewType));
   }
 
   auto UpdatedReturnTy =
       replaceTypeDecl(ReturnTy, ParentTypeArgs, CombinedTypeArgs);
 
   auto Fun = std::make_unique<FunDecl>(
-      Span, Vis, std::move(NewId), std::move(CombinedTypeArgs),
+      Span, Vis, Identifier(NewId), std::move(CombinedTypeArgs),
       std::move(UpdatedParams), UpdatedReturnTy, std::move(Body));
   Ast.push_back(std::move(Fun));
 }
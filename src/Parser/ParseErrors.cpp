@@ -89,7 +89,7 @@ void Parser::emitUnclosedDelimiterError(const Token &OpeningToken,
  */
 bool Parser::syncToTopLvl() {
   return syncTo({TokenKind::FunKw, TokenKind::StructKw, TokenKind::EnumKw,
-                 TokenKind::ImportKw});
+                 TokenKind::ImportKw, TokenKind::Hash});
 }
 
 /**
@@ -13,7 +13,7 @@ namespace phi {
 std::unique_ptr<AdtInit> Parser::parseAdtInit(std::unique_ptr<Expr> InitExpr,
                                               std::vector<TypeRef> TypeArgs) {
   auto *const DeclRef = llvm::dyn_cast<DeclRefExpr>(InitExpr.get());
-  std::string StructId = DeclRef->getId();
+  Identifier StructId = DeclRef->getIdentifier();
 
   auto Inits = parseList<MemberInit>(
       TokenKind::OpenBrace, TokenKind::CloseBrace, &Parser::parseMemberInit);
@@ -30,7 +30,7 @@ std::unique_ptr<MemberInit> Parser::parseMemberInit() {
     return nullptr;
   }
   SrcLocation Loc = Tok->getStart();
-  std::string FieldId = Tok->getLexeme();
+  Identifier FieldId = Tok->getIdentifier();
 
   // MemberInitExprs can be for data-less enum variants, so an equal sign
   // is not required, as it would be if they were only representing fields
@@ -85,8 +85,18 @@ std::unique_ptr<Expr> Parser::parseInfix(const Token &Op,
 
     // field access
     if (auto *Field = llvm::dyn_cast<DeclRefExpr>(Rhs.get())) {
-      return std::make_unique<FieldAccessExpr>(Field->getLocation(),
-                                               std::move(Lhs), Field->getId());
+      return std::make_unique<FieldAccessExpr>(
+          Field->getLocation(), std::move(Lhs), Field->getIdentifier());
+    }
+
+    // `a.field[i]` indexes the field rather than a variable named `field`
+    if (auto *Index = llvm::dyn_cast<ArrayIndex>(Rhs.get())) {
+      if (auto *Field = llvm::dyn_cast<DeclRefExpr>(Index->getBase())) {
+        auto Access = std::make_unique<FieldAccessExpr>(
+            Field->getLocation(), std::move(Lhs), Field->getIdentifier());
+        return std::make_unique<ArrayIndex>(
+            Index->getLocation(), std::move(Access), Index->takeIndex());
+      }
     }
 
     // method call
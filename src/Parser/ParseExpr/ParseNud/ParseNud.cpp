@@ -87,6 +87,7 @@ std::unique_ptr<Expr> Parser::parseNud(const Token &Tok) {
   // Identifiers and Kws
   case TokenKind::Identifier: {
     SrcLocation Location = Tok.getStart();
+    Identifier Id = Tok.getIdentifier();
     std::string QualId = Tok.getLexeme();
     while (peekKind() == TokenKind::DoubleColon) {
       // beginning of turbofish operator; we cannot advance the token
@@ -104,12 +105,13 @@ std::unique_ptr<Expr> Parser::parseNud(const Token &Tok) {
         return nullptr;
       }
       QualId += Tok->getLexeme();
+      Id = Identifier(QualId);
     }
 
-    return std::make_unique<DeclRefExpr>(Location, QualId);
+    return std::make_unique<DeclRefExpr>(Location, Id);
   }
   case TokenKind::ThisKw:
-    return std::make_unique<DeclRefExpr>(Tok.getStart(), "this");
+    return std::make_unique<DeclRefExpr>(Tok.getStart(), Identifier("this"));
   case TokenKind::MatchKw:
     return parseMatchExpr();
 
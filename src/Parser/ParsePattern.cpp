@@ -107,7 +107,7 @@ optional<Pattern> Parser::parseVariantPattern() {
   }
 
   const SrcLocation Loc = Tok->getStart();
-  const std::string Name = Tok->getLexeme();
+  const Identifier Name = Tok->getIdentifier();
 
   std::optional<std::vector<std::unique_ptr<VarDecl>>> Vars;
   if (peekKind() != TokenKind::OpenParen) {
@@ -119,7 +119,7 @@ optional<Pattern> Parser::parseVariantPattern() {
       [&] -> std::unique_ptr<VarDecl> {
         if (auto Tok = expectToken(TokenKind::Identifier)) {
           return std::make_unique<VarDecl>(Tok->getSpan(), Mutability::Var,
-                                           Tok->getLexeme(), std::nullopt);
+                                           Tok->getIdentifier(), std::nullopt);
         }
         return nullptr;
       });
@@ -277,7 +277,7 @@ std::unique_ptr<ForStmt> Parser::parseForStmt() {
 
     // Create loop variable declaration
     LoopVarDecl = std::make_unique<VarDecl>(
-        LoopVar.getSpan(), Mutability::Var, LoopVar.getLexeme(),
+        LoopVar.getSpan(), Mutability::Var, LoopVar.getIdentifier(),
         TypeCtx::getVar(VarTy::Domain::Int, LoopVar.getSpan()));
   } // scope_exit destructs here, setting NoAdtInit = false
 
@@ -35,9 +35,20 @@ std::optional<TypeRef> Parser::parseType(bool AllowPlaceholder) {
     if (!Contained)
       return std::nullopt;
 
+    // `[T; N]` carries its length in the type
+    std::optional<uint64_t> Length;
+    if (peekKind() == TokenKind::Semicolon) {
+      advanceToken();
+      if (peekKind() != TokenKind::IntLiteral) {
+        emitUnexpectedTokenError(peekToken());
+        return std::nullopt;
+      }
+      Length = std::stoull(advanceToken().getLexeme());
+    }
+
     if (peekKind() == TokenKind::CloseBracket) {
-      return TypeCtx::getArray(*Contained,
-                               SrcSpan(Open, advanceToken().getSpan().End));
+      return TypeCtx::getArray(
+          *Contained, SrcSpan(Open, advanceToken().getSpan().End), Length);
     }
     emitUnexpectedTokenError(peekToken());
     return std::nullopt;
@@ -137,7 +148,7 @@ std::optional<TypeRef> Parser::parseTypeBase(bool AllowPlaceholder) {
     for (const auto &Gen : ValidGenerics) {
       Gen->emit(0);
       if (Gen->getId() == Id) {
-        return TypeCtx::getGeneric(Gen->getId(), Gen, Span);
+        return TypeCtx::getGeneric(Gen->getIdentifier(), Gen, Span);
       }
     }
 
@@ -146,8 +157,9 @@ std::optional<TypeRef> Parser::parseTypeBase(bool AllowPlaceholder) {
     }
   }
 
-  return (It == PrimitiveMap.end()) ? TypeCtx::getAdt(Id, nullptr, Span)
-                                    : TypeCtx::getBuiltin(It->second, Span);
+  return (It == PrimitiveMap.end())
+             ? TypeCtx::getAdt(Identifier(Id), nullptr, Span)
+             : TypeCtx::getBuiltin(It->second, Span);
 }
 
 std::optional<std::vector<TypeRef>>
@@ -1,6 +1,7 @@
 #include "Parser/Parser.hpp"
 
 #include <cstdint>
+#include <format>
 #include <memory>
 #include <optional>
 #include <string>
@@ -51,7 +52,7 @@ std::unique_ptr<ModuleDecl> Parser::parse() {
     std::vector<std::unique_ptr<ImportStmt>> NoImports;
     std::vector<std::unique_ptr<UseStmt>> NoUses;
     return std::make_unique<ModuleDecl>(
-        Span, Visibility::Public, std::move(PathStr), std::move(Path),
+        Span, Visibility::Public, Identifier(PathStr), std::move(Path),
         std::move(Ast), std::move(NoImports), std::move(NoUses));
   }
 
@@ -75,10 +76,20 @@ std::unique_ptr<ModuleDecl> Parser::parse() {
   std::vector<std::unique_ptr<ImportStmt>> Imports;
   std::vector<std::unique_ptr<UseStmt>> Uses;
   while (!atEOF()) {
+    auto Attrs = parseAttributes();
     auto Visibility = parseItemVisibility();
     if (!Visibility)
       continue;
 
+    // Imports and uses introduce no declaration an attribute could apply to
+    if (!Attrs.empty() && (peekKind() == TokenKind::ImportKw ||
+                           peekKind() == TokenKind::UseKw)) {
+      error(std::format("attributes are not allowed on `{}`",
+                        peekToken().getLexeme()))
+          .with_primary_label(Attrs.front().Span, "remove this attribute")
+          .emit(*Diags);
+    }
+
     std::unique_ptr<ItemDecl> Res = nullptr;
     switch (peekKind()) {
     case TokenKind::FunKw:
@@ -91,30 +102,32 @@ std::unique_ptr<ModuleDecl> Parser::parse() {
       Res = parseEnumDecl(*Visibility);
       break;
     case TokenKind::ImportKw:
-      if (auto Import = parseImportStmt())
+      if (auto Import = parseImportStmt()) {
         Imports.push_back(std::move(Import));
-      else
-        syncToTopLvl();
+        continue;
+      }
       break;
     case TokenKind::UseKw:
-      if (auto Use = parseUseStmt())
+      if (auto Use = parseUseStmt()) {
         Uses.push_back(std::move(Use));
-      else
-        syncToTopLvl();
+        continue;
+      }
       break;
     default:
       emitUnexpectedTokenError(peekToken(),
                                {"fun", "struct", "enum", "import", "use"});
     }
 
-    if (Res)
+    if (Res) {
+      Res->setAttrs(std::move(Attrs));
       Ast.push_back(std::move(Res));
-    else
+    } else {
       syncToTopLvl(); // Error recovery
+    }
   }
 
   return std::make_unique<ModuleDecl>(
-      Span, Visibility::Public, std::move(PathStr), std::move(Path),
+      Span, Visibility::Public, Identifier(PathStr), std::move(Path),
       std::move(Ast), std::move(Imports), std::move(Uses));
 }
 
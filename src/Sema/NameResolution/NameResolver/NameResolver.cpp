@@ -1,9 +1,13 @@
 #include "Sema/NameResolution/NameResolver.hpp"
 
 #include <cassert>
+#include <deque>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/Parallel.h>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "AST/Nodes/Decl.hpp"
 #include "Diagnostics/DiagnosticBuilder.hpp"
@@ -21,23 +25,38 @@ std::vector<ModuleDecl *> NameResolver::resolve() {
     }
   }
 
-  for (auto &Mod : Modules) {
-    Mod = resolveSingleMod(std::move(Mod));
+  // Phase 1: Resolve imports, signatures and uses, one scope per module
+  std::deque<NameResolver> ModuleScopes;
+  std::vector<std::pair<const SymbolTable *, ItemDecl *>> Bodies;
+  for (auto *Mod : Modules) {
+    auto &Scope = ModuleScopes.emplace_back(SymbolTab, Diags);
+    Scope.resolveModuleScope(*Mod);
+    for (auto &Item : Mod->getItems()) {
+      Bodies.emplace_back(&Scope.SymbolTab, Item.get());
+    }
+  }
+
+  // Phase 2: Resolve bodies. Module scopes are no longer written to, so each
+  // body gets a worker layered over its module's scope.
+  std::vector<std::vector<Diagnostic>> BodyDiags(Bodies.size());
+  llvm::parallelFor(0, Bodies.size(), [&](size_t I) {
+    DiagnosticManager::ThreadCapture Capture(BodyDiags[I]);
+    auto [Scope, Item] = Bodies[I];
+    NameResolver Worker(*Scope, Diags);
+    Worker.resolveBodies(*Item);
+  });
+
+  for (auto &Buffered : BodyDiags) {
+    Diags->emitAll(Buffered);
   }
 
   return std::move(Modules);
 }
 
-ModuleDecl *NameResolver::resolveSingleMod(ModuleDecl *Module) {
-  SymbolTable::ScopeGuard ModuleScope(SymbolTab);
-
+void NameResolver::resolveModuleScope(ModuleDecl &Mod) {
   // Resolve the imports into the symbol table;
   // make sure we aren't trying to import something inside this module
-
-  // Decl with bodies are handled in 2 phases.
-  // Phase 1: Resolve signatures
-  // Phase 2: Resolve bodies
-
+  ModuleDecl *Module = &Mod;
   for (auto &Import : Module->getImports()) {
     auto *Decl = SymbolTab.lookupImport(Import.getPathStr());
     if (!Decl) {
@@ -55,13 +74,11 @@ ModuleDecl *NameResolver::resolveSingleMod(ModuleDecl *Module) {
         continue;
       }
 
-      for (auto *Item : Mod->getPublicItems()) {
-        auto Alias = Import.getAlias().value_or(Mod->getPath().back());
-        if (!SymbolTab.insertWithQual(Item, Alias)) {
-          error(std::format("redefinition of `{}`", Alias))
-              .with_primary_label(Import.getSpan())
-              .emit(*Diags);
-        }
+      auto Alias = Import.getAlias().value_or(Mod->getPath().back());
+      if (!SymbolTab.insertModuleAlias(Mod, Identifier(Alias))) {
+        error(std::format("redefinition of `{}`", Alias))
+            .with_primary_label(Import.getSpan())
+            .emit(*Diags);
       }
 
       continue;
@@ -78,7 +95,7 @@ ModuleDecl *NameResolver::resolveSingleMod(ModuleDecl *Module) {
       }
 
       auto Alias = Import.getAlias().value_or(Item->getId());
-      if (!SymbolTab.insertAs(Item, Alias)) {
+      if (!SymbolTab.insertAs(Item, Identifier(Alias))) {
         error(std::format("redefinition of `{}`", Alias))
             .with_primary_label(Import.getSpan())
             .emit(*Diags);
@@ -102,8 +119,9 @@ ModuleDecl *NameResolver::resolveSingleMod(ModuleDecl *Module) {
             {"bool", BuiltinTy::Bool},
         };
 
+    const Identifier Alias(Use.getAlias());
     if (PrimitiveMap.contains(Use.getPathStr())) {
-      if (auto *D = SymbolTab.lookup(Use.getAlias())) {
+      if (auto *D = SymbolTab.lookup(Alias)) {
         error(
             std::format("Naming conflict with type alias `{}`", Use.getAlias()))
             .with_extra_snippet(D->getSpan(), "with this declaration here")
@@ -112,7 +130,7 @@ ModuleDecl *NameResolver::resolveSingleMod(ModuleDecl *Module) {
       continue;
     }
 
-    auto *Decl = SymbolTab.lookupAll(Use.getPathStr());
+    auto *Decl = SymbolTab.lookupAll(Identifier(Use.getPathStr()));
     if (!Decl) {
       emitItemPathNotFound(Use.getPathStr(), Use.getSpan());
       continue;
@@ -120,19 +138,17 @@ ModuleDecl *NameResolver::resolveSingleMod(ModuleDecl *Module) {
 
     Use.setAliasedDecl(Decl);
     if (auto *Mod = llvm::dyn_cast<ModuleDecl>(Use.getAliasedDecl())) {
-      for (auto *Item : Mod->getPublicItems()) {
-        if (!SymbolTab.insertWithQual(Item, Use.getAlias())) {
-          error(std::format("redefinition of `{}`", Use.getAlias()))
-              .with_primary_label(Use.getSpan())
-              .emit(*Diags);
-        }
+      if (!SymbolTab.insertModuleAlias(Mod, Alias)) {
+        error(std::format("redefinition of `{}`", Use.getAlias()))
+            .with_primary_label(Use.getSpan())
+            .emit(*Diags);
       }
       continue;
     }
 
     if (auto *Item = llvm::dyn_cast<ItemDecl>(Use.getAliasedDecl())) {
       assert(!llvm::isa<ModuleDecl>(Item));
-      if (!SymbolTab.insertAs(Item, Use.getAlias())) {
+      if (!SymbolTab.insertAs(Item, Alias)) {
         error(std::format("redefinition of `{}`", Use.getAlias()))
             .with_primary_label(Use.getSpan())
             .emit(*Diags);
@@ -140,12 +156,6 @@ ModuleDecl *NameResolver::resolveSingleMod(ModuleDecl *Module) {
     }
   }
 
-  // Phase 2: Resolve function bodies
-  for (auto &Decl : Module->getItems()) {
-    resolveBodies(*Decl);
-  }
-
-  return Module;
 }
 
 } // namespace phi
@@ -1,6 +1,9 @@
 #include "Sema/NameResolution/NameResolver.hpp"
 
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/MathExtras.h>
 
 #include <cassert>
 #include <variant>
@@ -11,12 +14,14 @@
 namespace phi {
 
 bool NameResolver::resolveHeader(ItemDecl &D) {
+  bool Success = checkAttributes(D);
+
   if (auto *Adt = llvm::dyn_cast<AdtDecl>(&D)) {
-    return resolveHeader(*Adt);
+    return resolveHeader(*Adt) && Success;
   }
 
   if (auto *Fun = llvm::dyn_cast<FunDecl>(&D)) {
-    return resolveHeader(*Fun);
+    return resolveHeader(*Fun) && Success;
   }
 
   static_assert("ModuleDecl not yet supported");
@@ -40,6 +45,56 @@ bool NameResolver::resolveBodies(ItemDecl &D) {
   return true;
 }
 
+// Layout attributes: `repr(C)` and `packed` on structs, `align(N)` on structs
+// and enums. A packed struct cannot also ask for a larger alignment.
+bool NameResolver::checkAttributes(ItemDecl &D) {
+  bool Success = true;
+  auto reject = [&](const Attribute &A, std::string Msg, std::string Help) {
+    error(std::move(Msg))
+        .with_primary_label(A.Span, "here")
+        .with_help(std::move(Help))
+        .emit(*Diags);
+    Success = false;
+  };
+
+  bool IsStruct = llvm::isa<StructDecl>(D);
+  bool IsAdt = llvm::isa<AdtDecl>(D);
+  for (const auto &A : D.getAttrs()) {
+    if (A.Name == "repr") {
+      if (!IsStruct) {
+        reject(A, "invalid use of attribute `repr`",
+               "`#[repr(C)]` applies to structs");
+      } else if (A.Args != std::vector<std::string>{"C"}) {
+        reject(A,
+               std::format("unknown representation `{}`",
+                           llvm::join(A.Args, ", ")),
+               "the only supported representation is `repr(C)`");
+      }
+    } else if (A.Name == "packed") {
+      if (!IsStruct || !A.Args.empty()) {
+        reject(A, "invalid use of attribute `packed`",
+               "`#[packed]` applies to structs and takes no arguments");
+      } else if (D.getAttr("align")) {
+        reject(A, "a struct cannot be both packed and aligned",
+               "remove `#[packed]` or `#[align]`");
+      }
+    } else if (A.Name == "align") {
+      uint64_t N = 0;
+      bool IsNumber =
+          A.Args.size() == 1 && !llvm::StringRef(A.Args[0]).getAsInteger(10, N);
+      if (!IsAdt || !IsNumber || !llvm::isPowerOf2_64(N) || N > 4096) {
+        reject(A, "invalid use of attribute `align`",
+               "`#[align(N)]` applies to structs and enums, with N a power "
+               "of two up to 4096");
+      }
+    } else {
+      reject(A, std::format("unknown attribute `{}`", A.Name),
+             "the known attributes are `repr(C)`, `packed` and `align(N)`");
+    }
+  }
+  return Success;
+}
+
 bool NameResolver::resolveHeader(FunDecl &D) {
   if (!SymbolTab.insert(&D)) {
     emitRedefinitionError("Function", SymbolTab.lookup(D), &D);
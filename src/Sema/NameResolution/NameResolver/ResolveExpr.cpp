@@ -14,35 +14,6 @@
 
 namespace phi {
 
-bool NameResolver::visit(Expr &E) {
-  return llvm::TypeSwitch<Expr *, bool>(&E)
-      .Case<IntLiteral>([&](IntLiteral *X) { return visit(*X); })
-      .Case<FloatLiteral>([&](FloatLiteral *X) { return visit(*X); })
-      .Case<StrLiteral>([&](StrLiteral *X) { return visit(*X); })
-      .Case<CharLiteral>([&](CharLiteral *X) { return visit(*X); })
-      .Case<BoolLiteral>([&](BoolLiteral *X) { return visit(*X); })
-      .Case<RangeLiteral>([&](RangeLiteral *X) { return visit(*X); })
-      .Case<TupleLiteral>([&](TupleLiteral *X) { return visit(*X); })
-      .Case<ArrayLiteral>([&](ArrayLiteral *X) { return visit(*X); })
-      .Case<DeclRefExpr>([&](DeclRefExpr *X) { return visit(*X); })
-      .Case<FunCallExpr>([&](FunCallExpr *X) { return visit(*X); })
-      .Case<BinaryOp>([&](BinaryOp *X) { return visit(*X); })
-      .Case<UnaryOp>([&](UnaryOp *X) { return visit(*X); })
-      .Case<MemberInit>([&](MemberInit *X) { return visit(*X); })
-      .Case<FieldAccessExpr>([&](FieldAccessExpr *X) { return visit(*X); })
-      .Case<MethodCallExpr>([&](MethodCallExpr *X) { return visit(*X); })
-      .Case<MatchExpr>([&](MatchExpr *X) { return visit(*X); })
-      .Case<AdtInit>([&](AdtInit *X) { return visit(*X); })
-      .Case<IntrinsicCall>([&](IntrinsicCall *X) { return visit(*X); })
-      .Case<TupleIndex>([&](TupleIndex *X) { return visit(*X); })
-      .Case<ArrayIndex>([&](ArrayIndex *X) { return visit(*X); })
-      .Case<CastExpr>([&](CastExpr *X) { return visit(*X); })
-      .Default([&](Expr *) {
-        llvm_unreachable("Unhandled Expr kind in TypeInferencer");
-        return false;
-      });
-}
-
 bool NameResolver::visit(IntLiteral &E) {
   (void)E;
   return true;
@@ -174,7 +145,7 @@ bool NameResolver::visit(AdtInit &E) {
     return true;
   }
 
-  auto *Decl = SymbolTab.lookup(E.getTypeName());
+  auto *Decl = SymbolTab.lookup(E.getTypeIdentifier());
   if (!Decl) {
     emitNotFoundError(NotFoundErrorKind::Adt, E.getTypeName(), E.getLocation());
     return false;
@@ -189,7 +160,7 @@ bool NameResolver::visit(AdtInit &E) {
     }
   }
 
-  return llvm::TypeSwitch<AdtDecl *, bool>(SymbolTab.lookup(E.getTypeName()))
+  return llvm::TypeSwitch<AdtDecl *, bool>(Decl)
       .Case<StructDecl>(
           [&](auto *D) { return resolveStructInit(D, E) && Success; })
       .Case<EnumDecl>(
@@ -207,11 +178,11 @@ bool NameResolver::resolveStructInit(StructDecl *Found, AdtInit &E) {
 
   bool Success = true;
   for (auto &FieldInit : E.getInits()) {
-    if (Found->getField(FieldInit->getId()) == nullptr) {
+    if (Found->getField(FieldInit->getIdentifier()) == nullptr) {
       emitNotFoundError(NotFoundErrorKind::Field, FieldInit->getId(),
                         FieldInit->getLocation());
     } else {
-      FieldInit->setDecl(Found->getField(FieldInit->getId()));
+      FieldInit->setDecl(Found->getField(FieldInit->getIdentifier()));
       assert(FieldInit->getDecl() != nullptr);
       Missing.erase(FieldInit->getId());
     }
@@ -271,7 +242,7 @@ bool NameResolver::resolveEnumInit(EnumDecl *Found, AdtInit &E) {
   // 2. Check that the specfied variant is actually a variant of the enum
   assert(E.getInits().size() == 1);
   auto &ActiveVariant = *E.getInits().front();
-  auto *VariantDecl = Found->getVariant(ActiveVariant.getId());
+  auto *VariantDecl = Found->getVariant(ActiveVariant.getIdentifier());
   if (!VariantDecl) {
     emitNotFoundError(NotFoundErrorKind::Variant, ActiveVariant.getId(),
                       E.getLocation(), E.getTypeName());
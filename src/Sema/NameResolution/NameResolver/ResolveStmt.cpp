@@ -2,31 +2,12 @@
 
 #include <optional>
 
-#include <llvm/ADT/TypeSwitch.h>
-
 #include "AST/Nodes/Decl.hpp"
 #include "AST/Nodes/Stmt.hpp"
 #include "Sema/NameResolution/SymbolTable.hpp"
 
 namespace phi {
 
-bool NameResolver::visit(Stmt &S) {
-  return llvm::TypeSwitch<Stmt *, bool>(&S)
-      .Case<ReturnStmt>([&](ReturnStmt *X) { return visit(*X); })
-      .Case<DeferStmt>([&](DeferStmt *X) { return visit(*X); })
-      .Case<IfStmt>([&](IfStmt *X) { return visit(*X); })
-      .Case<WhileStmt>([&](WhileStmt *X) { return visit(*X); })
-      .Case<ForStmt>([&](ForStmt *X) { return visit(*X); })
-      .Case<DeclStmt>([&](DeclStmt *X) { return visit(*X); })
-      .Case<ContinueStmt>([&](ContinueStmt *X) { return visit(*X); })
-      .Case<BreakStmt>([&](BreakStmt *X) { return visit(*X); })
-      .Case<ExprStmt>([&](ExprStmt *X) { return visit(*X); })
-      .Default([&](Stmt *) {
-        std::unreachable();
-        return false;
-      });
-}
-
 bool NameResolver::visit(Block &Block, bool ScopeCreated = false) {
   // Create new scope unless parent already created one
   std::optional<SymbolTable::ScopeGuard> BlockScope;
@@ -4,9 +4,6 @@
 
 #include <llvm/ADT/TypeSwitch.h>
 
-#include <iostream>
-#include <print>
-
 namespace phi {
 
 bool NameResolver::visit(TypeRef T) {
@@ -16,9 +13,8 @@ bool NameResolver::visit(TypeRef T) {
 
   return llvm::TypeSwitch<const Type *, bool>(T.getPtr())
       .Case<AdtTy>([&](auto *Adt) {
-        auto *Decl = SymbolTab.lookup(Adt->getId());
+        auto *Decl = SymbolTab.lookup(Adt->getIdentifier());
         if (!Decl) {
-          std::println("this");
           emitTypeNotFound(Adt->getId(), T.getSpan().Start);
           return false;
         }
@@ -38,8 +34,7 @@ bool NameResolver::visit(TypeRef T) {
           return true;
         }
 
-        std::cout << "Generic type fall back to lookup";
-        auto *Decl = SymbolTab.lookupTypeArg(Generic->getId());
+        auto *Decl = SymbolTab.lookupTypeArg(Generic->getIdentifier());
         if (!Decl) {
           emitTypeNotFound(Generic->getId(), T.getSpan().Start);
           return false;
@@ -0,0 +1,180 @@
+#include "Sema/NameResolution/SuggestionIndex.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <llvm/ADT/Statistic.h>
+
+#define DEBUG_TYPE "suggest"
+
+STATISTIC(NumSuggestionQueries, "Number of typo-correction queries");
+STATISTIC(NumCandidatesScored, "Number of typo-correction candidates scored");
+
+namespace phi {
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Edit distance kernels
+//===----------------------------------------------------------------------===//
+
+/// Plain dynamic-programming OSA distance, for queries too long for one word
+std::size_t osaDistanceSlow(llvm::StringRef A, llvm::StringRef B) {
+  std::vector<std::size_t> Prev2(B.size() + 1);
+  std::vector<std::size_t> Prev(B.size() + 1);
+  std::vector<std::size_t> Cur(B.size() + 1);
+  for (std::size_t J = 0; J <= B.size(); ++J) {
+    Prev[J] = J;
+  }
+
+  for (std::size_t I = 1; I <= A.size(); ++I) {
+    Cur[0] = I;
+    for (std::size_t J = 1; J <= B.size(); ++J) {
+      const std::size_t Cost = A[I - 1] == B[J - 1] ? 0 : 1;
+      Cur[J] = std::min({Prev[J] + 1, Cur[J - 1] + 1, Prev[J - 1] + Cost});
+      if (I > 1 && J > 1 && A[I - 1] == B[J - 2] && A[I - 2] == B[J - 1]) {
+        Cur[J] = std::min(Cur[J], Prev2[J - 2] + 1);
+      }
+    }
+    std::swap(Prev2, Prev);
+    std::swap(Prev, Cur);
+  }
+
+  return Prev[B.size()];
+}
+
+/**
+ * A query preprocessed for Hyyrö's bit-parallel OSA distance.
+ *
+ * Each column of the DP matrix is held as vertical delta bit-vectors, one
+ * bit per query character, so a whole column is advanced in a handful of
+ * word operations per candidate character.
+ */
+class QueryMask {
+public:
+  explicit QueryMask(llvm::StringRef Query) : Query(Query) {
+    if (Query.size() > 64) {
+      return;
+    }
+    for (std::size_t I = 0; I < Query.size(); ++I) {
+      Peq[static_cast<unsigned char>(Query[I])] |= uint64_t{1} << I;
+    }
+  }
+
+  /// Returns the distance to \p Text, or some value above \p Bound once the
+  /// distance is known to exceed it
+  [[nodiscard]] std::size_t distance(llvm::StringRef Text,
+                                     std::size_t Bound) const {
+    if (Query.empty()) {
+      return Text.size();
+    }
+    if (Query.size() > 64) {
+      return osaDistanceSlow(Query, Text);
+    }
+
+    const uint64_t Last = uint64_t{1} << (Query.size() - 1);
+    uint64_t VP = ~uint64_t{0};
+    uint64_t VN = 0;
+    uint64_t D0 = 0;
+    uint64_t PrevPM = 0;
+    std::size_t Dist = Query.size();
+
+    for (std::size_t J = 0; J < Text.size(); ++J) {
+      const uint64_t PM = Peq[static_cast<unsigned char>(Text[J])];
+      const uint64_t TR = (((~D0) & PM) << 1) & PrevPM;
+      D0 = (((PM & VP) + VP) ^ VP) | PM | VN | TR;
+
+      uint64_t HP = VN | ~(D0 | VP);
+      uint64_t HN = D0 & VP;
+      if (HP & Last) {
+        ++Dist;
+      } else if (HN & Last) {
+        --Dist;
+      }
+
+      // Each remaining character can lower the distance by at most one
+      const std::size_t Remaining = Text.size() - J - 1;
+      if (Dist > Bound + Remaining) {
+        return Bound + 1;
+      }
+
+      HP = (HP << 1) | 1;
+      HN <<= 1;
+      VP = HN | ~(D0 | HP);
+      VN = HP & D0;
+      PrevPM = PM;
+    }
+
+    return Dist;
+  }
+
+private:
+  llvm::StringRef Query;
+  std::array<uint64_t, 256> Peq{};
+};
+
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// SuggestionIndex
+//===----------------------------------------------------------------------===//
+
+void SuggestionIndex::add(llvm::StringRef Name, Decl *D) {
+  if (ByLength.size() <= Name.size()) {
+    ByLength.resize(Name.size() + 1);
+  }
+  ByLength[Name.size()].push_back({.Name = Name.str(), .D = D, .Order = Size});
+  ++Size;
+}
+
+std::optional<SuggestionIndex::Match>
+SuggestionIndex::findClosest(llvm::StringRef Query,
+                             std::size_t MaxDistance) const {
+  ++NumSuggestionQueries;
+  if (empty()) {
+    return std::nullopt;
+  }
+
+  const QueryMask P(Query);
+  const Candidate *Best = nullptr;
+  std::size_t Bound = MaxDistance;
+
+  auto scoreBucket = [&](std::size_t Len) {
+    if (Len >= ByLength.size()) {
+      return;
+    }
+    for (const Candidate &C : ByLength[Len]) {
+      ++NumCandidatesScored;
+      const std::size_t Dist = P.distance(C.Name, Bound);
+      if (Dist > Bound) {
+        continue;
+      }
+      if (!Best || Dist < Bound || C.Order < Best->Order) {
+        Best = &C;
+        Bound = Dist;
+      }
+    }
+  };
+
+  // A candidate whose length differs by more than the bound cannot be within
+  // it, so only the buckets around the query's length are ever looked at
+  const std::size_t Len = Query.size();
+  for (std::size_t Delta = 0; Delta <= Bound; ++Delta) {
+    scoreBucket(Len + Delta);
+    if (Delta != 0 && Delta <= Len) {
+      scoreBucket(Len - Delta);
+    }
+  }
+
+  if (!Best) {
+    return std::nullopt;
+  }
+  return Match{.Name = Best->Name, .D = Best->D, .Distance = Bound};
+}
+
+} // namespace phi
+
+#undef DEBUG_TYPE
@@ -1,72 +1,27 @@
 #include "Sema/NameResolution/SymbolTable.hpp"
 
 #include <algorithm>
-#include <limits>
 #include <optional>
-#include <ranges>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
-namespace phi {
-
-// ---------- Damerau–Levenshtein (anonymous namespace) ----------
-namespace {
-
-using size_t_t = std::size_t;
-
-size_t_t damerauLevenshtein(const std::string &A, const std::string &B) {
-  const size_t_t LenA = A.size();
-  const size_t_t LenB = B.size();
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/Statistic.h>
+#include <llvm/Support/Casting.h>
 
-  if (LenA == 0)
-    return LenB;
-  if (LenB == 0)
-    return LenA;
+#define DEBUG_TYPE "symtab"
 
-  const size_t_t INF = LenA + LenB;
-  std::vector<std::vector<size_t_t>> DP(LenA + 2,
-                                        std::vector<size_t_t>(LenB + 2, 0));
-  DP[0][0] = INF;
-  for (size_t_t i = 0; i <= LenA; ++i) {
-    DP[i + 1][1] = i;
-    DP[i + 1][0] = INF;
-  }
-  for (size_t_t j = 0; j <= LenB; ++j) {
-    DP[1][j + 1] = j;
-    DP[0][j + 1] = INF;
-  }
+STATISTIC(NumSuggestionIndexes, "Number of suggestion indexes built");
 
-  std::unordered_map<char, size_t_t> Last;
-  for (size_t_t i = 1; i <= LenA; ++i) {
-    size_t_t LastMatchCol = 0;
-    for (size_t_t j = 1; j <= LenB; ++j) {
-      const size_t_t i1 = Last.count(B[j - 1]) ? Last[B[j - 1]] : 0;
-      const size_t_t j1 = LastMatchCol;
-      const size_t_t Cost = (A[i - 1] == B[j - 1]) ? 0 : 1;
-      if (Cost == 0)
-        LastMatchCol = j;
-
-      DP[i + 1][j + 1] = std::min({
-          DP[i][j] + Cost,                             // substitution
-          DP[i + 1][j] + 1,                            // insertion
-          DP[i][j + 1] + 1,                            // deletion
-          DP[i1][j1] + (i - i1 - 1) + 1 + (j - j1 - 1) // transposition
-      });
-    }
-    Last[A[i - 1]] = i;
-  }
+namespace phi {
 
-  return DP[LenA + 1][LenB + 1];
-}
+namespace {
 
-// Decide whether a found distance is "good enough" as a suggestion.
-// We make threshold dynamic: short identifiers get small thresholds,
-// longer identifiers allow slightly larger distances (but capped).
-bool IsDistanceGoodEnough(std::size_t Distance, const std::string &Query) {
+// Largest distance still worth suggesting. Short identifiers get small
+// thresholds, longer identifiers allow slightly larger distances (but capped).
+std::size_t maxSuggestionDistance(const std::string &Query) {
   std::size_t Thr = std::max<std::size_t>(1, Query.size() / 3);
-  Thr = std::min<std::size_t>(Thr, 4); // cap so suggestions don't become noisy
-  return Distance <= Thr;
+  return std::min<std::size_t>(Thr, 4); // cap so suggestions don't become noisy
 }
 
 } // namespace
@@ -76,100 +31,110 @@ static const std::vector<std::string> PrimitiveNames = {
     "i8",  "i16", "i32", "i64",    "u8",   "u16",  "u32",
     "u64", "f32", "f64", "string", "char", "bool", "range"};
 
-// ---------- Closest helpers ----------
-FunDecl *SymbolTable::getClosestFun(const std::string &Undeclared) const {
-  FunDecl *Best = nullptr;
-  std::size_t BestDist = std::numeric_limits<std::size_t>::max();
-
-  // Prefer innermost scopes first (iterate from back to front)
-  for (const auto &ScopeRef : std::ranges::reverse_view(Scopes)) {
-    for (const auto &Pair : ScopeRef.Funs) {
-      const std::string &CandName = Pair.first;
-      std::size_t Dist = damerauLevenshtein(Undeclared, CandName);
-      if (Dist < BestDist) {
-        BestDist = Dist;
-        Best = Pair.second;
-      }
+static const SuggestionIndex &primitiveSuggestions() {
+  static const SuggestionIndex Index = [] {
+    SuggestionIndex I;
+    for (const auto &Prim : PrimitiveNames) {
+      I.add(Prim, nullptr);
     }
-  }
+    return I;
+  }();
+  return Index;
+}
 
-  if (Best && IsDistanceGoodEnough(BestDist, Undeclared))
-    return Best;
-  return nullptr;
+// ---------- Suggestion index ----------
+const SuggestionIndex &SymbolTable::localSuggestions(Namespace NS) const {
+  std::scoped_lock Lock(SuggestionMutex);
+  auto &Index = Suggestions[static_cast<std::size_t>(NS)];
+  if (!Index) {
+    ++NumSuggestionIndexes;
+    Index.emplace();
+    forEachLocalBinding(NS, [&](llvm::StringRef CandName, Decl *D) {
+      Index->add(CandName, D);
+    });
+    HasSuggestions.store(true, std::memory_order_release);
+  }
+  return *Index;
 }
 
-AdtDecl *SymbolTable::getClosestAdt(const std::string &Undeclared) const {
-  AdtDecl *Best = nullptr;
-  std::size_t BestDist = std::numeric_limits<std::size_t>::max();
-
-  // Prefer innermost scopes first (iterate from back to front)
-  for (const auto &ScopeRef : std::ranges::reverse_view(Scopes)) {
-    for (const auto &Pair : ScopeRef.Adts) {
-      const std::string &CandName = Pair.first;
-      std::size_t Dist = damerauLevenshtein(Undeclared, CandName);
-      if (Dist < BestDist) {
-        BestDist = Dist;
-        Best = Pair.second;
-      }
+/// Searches this table and then each enclosing one. An outer candidate has to
+/// be strictly closer, so ties go to the nearest declaration.
+std::optional<SuggestionIndex::Match>
+SymbolTable::findClosest(Namespace NS, llvm::StringRef Query,
+                         std::size_t MaxDistance) const {
+  std::optional<SuggestionIndex::Match> Best;
+  for (const auto *Table = this; Table; Table = Table->Parent) {
+    auto Match = Table->localSuggestions(NS).findClosest(Query, MaxDistance);
+    if (!Match) {
+      continue;
     }
+    Best = Match;
+    if (Match->Distance == 0) {
+      break;
+    }
+    MaxDistance = Match->Distance - 1;
   }
-
-  if (Best && IsDistanceGoodEnough(BestDist, Undeclared))
-    return Best;
-  return nullptr;
+  return Best;
 }
 
-LocalDecl *SymbolTable::getClosestLocal(const std::string &Undeclared) const {
-  LocalDecl *Best = nullptr;
-  std::size_t BestDist = std::numeric_limits<std::size_t>::max();
-
-  // Prefer innermost scopes first (iterate from back to front)
-  for (const auto &ScopeRef : std::ranges::reverse_view(Scopes)) {
-    for (const auto &Pair : ScopeRef.Vars) {
-      const std::string &CandName = Pair.first;
-      std::size_t Dist = damerauLevenshtein(Undeclared, CandName);
-      if (Dist < BestDist) {
-        BestDist = Dist;
-        Best = Pair.second;
-      }
-    }
+void SymbolTable::invalidateSuggestions(Namespace NS) {
+  // Only the thread that owns this table binds into it, and it is the one
+  // that could have built an index since the flag was last cleared
+  if (!HasSuggestions.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  std::scoped_lock Lock(SuggestionMutex);
+  Suggestions[static_cast<std::size_t>(NS)].reset();
+
+  // Items behind a module alias are suggested under their qualified name
+  if (NS == Namespace::Module) {
+    Suggestions[static_cast<std::size_t>(Namespace::Fun)].reset();
+    Suggestions[static_cast<std::size_t>(Namespace::Adt)].reset();
   }
+  HasSuggestions.store(
+      llvm::any_of(Suggestions, [](const auto &I) { return I.has_value(); }),
+      std::memory_order_release);
+}
 
-  if (Best && IsDistanceGoodEnough(BestDist, Undeclared))
-    return Best;
-  return nullptr;
+// ---------- Closest helpers ----------
+FunDecl *SymbolTable::getClosestFun(const std::string &Undeclared) const {
+  auto Best = findClosest(Namespace::Fun, Undeclared,
+                          maxSuggestionDistance(Undeclared));
+  return Best ? llvm::cast<FunDecl>(Best->D) : nullptr;
+}
+
+AdtDecl *SymbolTable::getClosestAdt(const std::string &Undeclared) const {
+  auto Best = findClosest(Namespace::Adt, Undeclared,
+                          maxSuggestionDistance(Undeclared));
+  return Best ? llvm::cast<AdtDecl>(Best->D) : nullptr;
+}
+
+LocalDecl *SymbolTable::getClosestLocal(const std::string &Undeclared) const {
+  auto Best = findClosest(Namespace::Var, Undeclared,
+                          maxSuggestionDistance(Undeclared));
+  return Best ? llvm::cast<LocalDecl>(Best->D) : nullptr;
 }
 
 std::optional<std::string>
 SymbolTable::getClosestType(const std::string &Undeclared) const {
-  std::string BestName;
-  std::size_t BestDist = std::numeric_limits<std::size_t>::max();
-
-  // 1) primitives
-  for (const auto &Prim : PrimitiveNames) {
-    std::size_t Dist = damerauLevenshtein(Undeclared, Prim);
-    if (Dist < BestDist) {
-      BestDist = Dist;
-      BestName = Prim;
-    }
+  // Primitives win ties, so an ADT must be strictly closer than the best one
+  std::size_t MaxDist = maxSuggestionDistance(Undeclared);
+  auto Best = primitiveSuggestions().findClosest(Undeclared, MaxDist);
+  if (Best && Best->Distance == 0) {
+    return Best->Name.str();
   }
-
-  for (const auto &ScopeRef : std::ranges::reverse_view(Scopes)) {
-    // Check structs
-    for (const auto &Pair : ScopeRef.Adts) {
-      const std::string &CandName = Pair.first;
-      std::size_t Dist = damerauLevenshtein(Undeclared, CandName);
-      if (Dist < BestDist) {
-        BestDist = Dist;
-        BestName = CandName;
-      }
-    }
+  if (Best) {
+    MaxDist = Best->Distance - 1;
   }
 
-  if (!BestName.empty() && IsDistanceGoodEnough(BestDist, Undeclared))
-    return BestName;
-
+  if (auto Adt = findClosest(Namespace::Adt, Undeclared, MaxDist))
+    return Adt->Name.str();
+  if (Best)
+    return Best->Name.str();
   return std::nullopt;
 }
 
 } // namespace phi
+
+#undef DEBUG_TYPE
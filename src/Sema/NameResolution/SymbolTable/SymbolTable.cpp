@@ -1,9 +1,9 @@
 #include "Sema/NameResolution/SymbolTable.hpp"
 
-#include <ranges>
 #include <string>
 #include <utility>
 
+#include <llvm/ADT/Statistic.h>
 #include <llvm/ADT/TypeSwitch.h>
 #include <llvm/Support/Casting.h>
 
@@ -11,22 +11,133 @@
 #include "AST/Nodes/Expr.hpp"
 #include "AST/Nodes/Stmt.hpp"
 
+#define DEBUG_TYPE "symtab"
+
+STATISTIC(NumScopes, "Number of scopes pushed");
+STATISTIC(NumLookups, "Number of symbol lookups");
+STATISTIC(NumLookupMisses, "Number of symbol lookups that found nothing");
+
 namespace phi {
 
 /**
  * Enters a new scope in the symbol table.
  *
- * Scopes are implemented as stack of hash maps.
- * Each scope corresponds to a lexical block (function, if, for, etc.).
+ * Only the current length of the undo log is recorded, so entering a scope is
+ * constant time no matter how many blocks enclose it.
  */
-void SymbolTable::enterScope() { Scopes.emplace_back(); }
+void SymbolTable::enterScope() {
+  ++NumScopes;
+  ScopeMarks.push_back(static_cast<uint32_t>(Bindings.size()));
+}
 
 /**
  * Exits the current scope, discarding all declarations within it.
  *
- * Automatically removes all symbols defined in the current scope.
+ * Every binding appended since the matching enterScope() is removed from the
+ * visible table, newest first.
  */
-void SymbolTable::exitScope() { Scopes.pop_back(); }
+void SymbolTable::exitScope() {
+  const uint32_t Mark = ScopeMarks.back();
+  ScopeMarks.pop_back();
+  while (Bindings.size() > Mark) {
+    const Binding &B = Bindings.back();
+    invalidateSuggestions(B.NS);
+    Visible.erase(key(B.NS, B.Name));
+    Bindings.pop_back();
+  }
+}
+
+SymbolTable::Namespace SymbolTable::namespaceOf(const ItemDecl &Item) {
+  if (llvm::isa<FunDecl>(Item)) {
+    return Namespace::Fun;
+  }
+  if (llvm::isa<AdtDecl>(Item)) {
+    return Namespace::Adt;
+  }
+  return Namespace::Module;
+}
+
+SymbolTable::ExportTable::ExportTable(ModuleDecl &Mod) {
+  for (auto *Item : Mod.getPublicItems()) {
+    const Namespace NS = namespaceOf(*Item);
+    if (NS == Namespace::Module) {
+      continue;
+    }
+    if (Items.try_emplace(key(NS, Item->getIdentifier()), Item).second) {
+      Order.push_back(Item);
+    }
+  }
+}
+
+Decl *SymbolTable::find(Namespace NS, Identifier Id) const {
+  ++NumLookups;
+  auto *D = findVisible(NS, Id);
+  if (!D) {
+    ++NumLookupMisses;
+  }
+  return D;
+}
+
+/// Looks \p Id up without counting it, for callers that probe several
+/// namespaces as part of a single lookup
+Decl *SymbolTable::findVisible(Namespace NS, Identifier Id) const {
+  if (auto *D = findBound(NS, Id)) {
+    return D;
+  }
+  if (NS == Namespace::Fun || NS == Namespace::Adt) {
+    return findExported(NS, Id);
+  }
+  return nullptr;
+}
+
+/// Looks \p Id up in this table and then in each enclosing one
+Decl *SymbolTable::findBound(Namespace NS, Identifier Id) const {
+  for (const auto *Table = this; Table; Table = Table->Parent) {
+    if (auto It = Table->Visible.find(key(NS, Id));
+        It != Table->Visible.end()) {
+      return It->second;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * Resolves `Alias::Name` through the export table of the module bound to
+ * `Alias`. Only reached when the qualified spelling has no binding of its own.
+ * Both halves are looked up without interning: a spelling that was never
+ * interned cannot be bound or exported.
+ */
+Decl *SymbolTable::findExported(Namespace NS, Identifier Id) const {
+  auto [Qual, Name] = llvm::StringRef(Id.str()).rsplit("::");
+  if (Name.empty()) {
+    return nullptr;
+  }
+
+  auto QualId = Identifier::find(Qual);
+  auto *Mod = QualId ? findBound(Namespace::Module, *QualId) : nullptr;
+  if (!Mod) {
+    return nullptr;
+  }
+
+  auto NameId = Identifier::find(Name);
+  if (!NameId) {
+    return nullptr;
+  }
+  const auto &Table = root().Exports.at(llvm::cast<ModuleDecl>(Mod));
+  return Table.lookup(NS, *NameId);
+}
+
+bool SymbolTable::bind(Namespace NS, Identifier Id, Decl *D) {
+  if (Parent && Parent->findBound(NS, Id)) {
+    return false;
+  }
+  if (!Visible.try_emplace(key(NS, Id), D).second) {
+    return false;
+  }
+  Bindings.push_back({.NS = NS, .Name = Id, .D = D});
+  invalidateSuggestions(NS);
+  return true;
+}
 
 bool SymbolTable::insertAsImportable(ModuleDecl *Mod) {
   if (ImportableItems.contains(Mod->getId())) {
@@ -34,6 +145,7 @@ bool SymbolTable::insertAsImportable(ModuleDecl *Mod) {
   }
 
   ImportableItems[Mod->getId()] = Mod;
+  Exports.try_emplace(Mod, *Mod);
   return true;
 }
 
@@ -47,27 +159,17 @@ bool SymbolTable::insertAsImportable(ItemDecl *Item, ModuleDecl *ParentMod) {
   return true;
 }
 
-bool SymbolTable::insertAs(ItemDecl *Item, const std::string &Alias) {
+bool SymbolTable::insertAs(ItemDecl *Item, Identifier Alias) {
   assert(!llvm::isa<ModuleDecl>(Item) &&
          "Do not use insert for a ModuleDecl; they cannot be referenced other "
          "than being imported. In that case, use insertAsImportable");
 
-  if (auto *Fun = llvm::dyn_cast<FunDecl>(Item)) {
-    for (auto &Scope : Scopes) {
-      if (Scope.Funs.contains(Alias))
-        return false;
-    }
-    Scopes.back().Funs[Alias] = Fun;
-    return true;
+  if (llvm::isa<FunDecl>(Item)) {
+    return bind(Namespace::Fun, Alias, Item);
   }
 
-  if (auto *Adt = llvm::dyn_cast<AdtDecl>(Item)) {
-    for (auto &Scope : Scopes) {
-      if (Scope.Adts.contains(Alias))
-        return false;
-    }
-    Scopes.back().Adts[Alias] = Adt;
-    return true;
+  if (llvm::isa<AdtDecl>(Item)) {
+    return bind(Namespace::Adt, Alias, Item);
   }
 
   std::unreachable();
@@ -75,116 +177,56 @@ bool SymbolTable::insertAs(ItemDecl *Item, const std::string &Alias) {
 }
 
 bool SymbolTable::insert(ItemDecl *Item) {
-  return insertAs(Item, Item->getId());
+  return insertAs(Item, Item->getIdentifier());
 }
 
 bool SymbolTable::insert(LocalDecl *Var) {
-  for (auto &Scope : Scopes) {
-    if (Scope.Vars.find(Var->getId()) != Scope.Vars.end())
-      return false;
-  }
-  Scopes.back().Vars[Var->getId()] = Var;
-  return true;
+  return bind(Namespace::Var, Var->getIdentifier(), Var);
 }
 
 bool SymbolTable::insert(MemberDecl *Field) {
-  for (auto &Scope : Scopes) {
-    if (Scope.Mems.find(Field->getId()) != Scope.Mems.end())
-      return false;
-  }
-  Scopes.back().Mems[Field->getId()] = Field;
-  return true;
+  return bind(Namespace::Member, Field->getIdentifier(), Field);
 }
 
 bool SymbolTable::insert(TypeArgDecl *TypeArg) {
-  for (auto &Scope : Scopes) {
-    if (Scope.TypeArgs.find(TypeArg->getId()) != Scope.TypeArgs.end())
-      return false;
-  }
-  Scopes.back().TypeArgs[TypeArg->getId()] = TypeArg;
-  return true;
+  return bind(Namespace::TypeArg, TypeArg->getIdentifier(), TypeArg);
 }
 
-bool SymbolTable::insertWithQual(ItemDecl *Item, const std::string &Quals) {
-  assert(!llvm::isa<ModuleDecl>(Item) &&
-         "Do not use insertWithQual for a ModuleDecl; they cannot be "
-         "referenced other "
-         "than being imported. In that case, use insertAsImportable");
-
-  std::string QualifiedName = std::format("{}::{}", Quals, Item->getId());
-  if (auto *Fun = llvm::dyn_cast<FunDecl>(Item)) {
-    for (auto &Scope : Scopes) {
-      if (Scope.Funs.find(QualifiedName) != Scope.Funs.end())
-        return false;
-    }
-    Scopes.back().Funs[QualifiedName] = Fun;
-    return true;
-  }
-
-  if (auto *Adt = llvm::dyn_cast<AdtDecl>(Item)) {
-    for (auto &Scope : Scopes) {
-      if (Scope.Adts.find(QualifiedName) != Scope.Adts.end())
-        return false;
-    }
-    Scopes.back().Adts[QualifiedName] = Adt;
-    return true;
-  }
-
-  std::unreachable();
-  return false;
+bool SymbolTable::insertModuleAlias(ModuleDecl *Mod, Identifier Alias) {
+  assert(root().Exports.contains(Mod) &&
+         "Only modules made importable have an export table");
+  return bind(Namespace::Module, Alias, Mod);
 }
 
 LocalDecl *SymbolTable::lookup(DeclRefExpr &Var) {
-  for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-    if (auto It = Scope.Vars.find(Var.getId()); It != Scope.Vars.end()) {
-      return It->second;
-    }
-  }
-  return nullptr;
+  return llvm::cast_or_null<LocalDecl>(
+      find(Namespace::Var, Var.getIdentifier()));
 }
 
 FunDecl *SymbolTable::lookup(FunCallExpr &Fun) {
   auto *DeclRef = llvm::dyn_cast<DeclRefExpr>(&Fun.getCallee());
-  for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-    if (auto It = Scope.Funs.find(DeclRef->getId()); It != Scope.Funs.end()) {
-      return It->second;
-    }
-  }
-  return nullptr;
+  return llvm::cast_or_null<FunDecl>(
+      find(Namespace::Fun, DeclRef->getIdentifier()));
 }
 
-AdtDecl *SymbolTable::lookup(const std::string &Id) {
-  for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-    if (auto It = Scope.Adts.find(Id); It != Scope.Adts.end()) {
-      return It->second;
-    }
-  }
-  return nullptr;
+AdtDecl *SymbolTable::lookup(Identifier Id) {
+  return llvm::cast_or_null<AdtDecl>(find(Namespace::Adt, Id));
 }
 
-ItemDecl *SymbolTable::lookupAll(const std::string &Id) {
-  for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-    if (auto It = Scope.Adts.find(Id); It != Scope.Adts.end()) {
-      return It->second;
-    }
+ItemDecl *SymbolTable::lookupAll(Identifier Id) {
+  ++NumLookups;
+  if (auto *Adt = findVisible(Namespace::Adt, Id)) {
+    return llvm::cast<AdtDecl>(Adt);
   }
-
-  for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-    if (auto It = Scope.Funs.find(Id); It != Scope.Funs.end()) {
-      return It->second;
-    }
+  if (auto *Fun = findVisible(Namespace::Fun, Id)) {
+    return llvm::cast<FunDecl>(Fun);
   }
-
+  ++NumLookupMisses;
   return nullptr;
 }
 
-TypeArgDecl *SymbolTable::lookupTypeArg(const std::string &Id) {
-  for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-    if (auto It = Scope.TypeArgs.find(Id); It != Scope.TypeArgs.end()) {
-      return It->second;
-    }
-  }
-  return nullptr;
+TypeArgDecl *SymbolTable::lookupTypeArg(Identifier Id) {
+  return llvm::cast_or_null<TypeArgDecl>(find(Namespace::TypeArg, Id));
 }
 
 // === Lookup overloads by declaration type ===
@@ -193,45 +235,40 @@ ItemDecl *SymbolTable::lookup(ItemDecl &Item) {
   assert(!llvm::isa<ModuleDecl>(&Item) &&
          "Do not use `lookup` on a ModuleDecl; use `lookupImport` with the "
          "Module's name");
-  if (auto *Fun = llvm::dyn_cast<FunDecl>(&Item)) {
-    for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-      if (auto It = Scope.Funs.find(Fun->getId()); It != Scope.Funs.end()) {
-        return It->second;
-      }
-    }
-    return nullptr;
+  if (llvm::isa<FunDecl>(&Item)) {
+    return llvm::cast_or_null<FunDecl>(
+        find(Namespace::Fun, Item.getIdentifier()));
   }
 
   if (auto *Adt = llvm::dyn_cast<AdtDecl>(&Item)) {
-    return lookup(Adt->getId());
+    return llvm::cast_or_null<AdtDecl>(
+        find(Namespace::Adt, Adt->getIdentifier()));
   }
 
   std::unreachable();
 }
 
 LocalDecl *SymbolTable::lookup(LocalDecl &Local) {
-  for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-    if (auto It = Scope.Vars.find(Local.getId()); It != Scope.Vars.end()) {
-      return llvm::dyn_cast<VarDecl>(It->second);
-    }
-  }
-  return nullptr;
+  return llvm::dyn_cast_or_null<VarDecl>(
+      find(Namespace::Var, Local.getIdentifier()));
 }
 
 MemberDecl *SymbolTable::lookup(MemberDecl &Member) {
-  for (auto &Scope : std::ranges::reverse_view(Scopes)) {
-    if (auto It = Scope.Mems.find(Member.getId()); It != Scope.Mems.end()) {
-      return It->second;
-    }
-  }
-  return nullptr;
+  // MemberDecl has no classof; only members are bound in this namespace
+  return static_cast<MemberDecl *>(
+      find(Namespace::Member, Member.getIdentifier()));
 }
 
 ItemDecl *SymbolTable::lookupImport(const std::string &Id) {
-  if (auto It = ImportableItems.find(Id); It != ImportableItems.end()) {
+  ++NumLookups;
+  const auto &Importable = root().ImportableItems;
+  if (auto It = Importable.find(Id); It != Importable.end()) {
     return It->second;
   }
+  ++NumLookupMisses;
   return nullptr;
 }
 
 } // namespace phi
+
+#undef DEBUG_TYPE
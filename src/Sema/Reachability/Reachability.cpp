@@ -0,0 +1,174 @@
+#include "Sema/Reachability/Reachability.hpp"
+
+#include <llvm/ADT/Statistic.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/Casting.h>
+
+#define DEBUG_TYPE "reach"
+
+STATISTIC(NumReachableItems, "Number of items reachable from the entry points");
+STATISTIC(NumUnreachableItems, "Number of items whose bodies were skipped");
+
+namespace phi {
+
+namespace {
+
+/// Calls \p Fn on every function and ADT, looking through nested modules
+template <typename F> void forEachItem(ModuleDecl &Mod, F &&Fn) {
+  for (auto &Item : Mod.getItems()) {
+    if (auto *Nested = llvm::dyn_cast<ModuleDecl>(Item.get())) {
+      forEachItem(*Nested, Fn);
+      continue;
+    }
+    Fn(*Item);
+  }
+}
+
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// Main Entry Point
+//===----------------------------------------------------------------------===//
+
+void Reachability::run() {
+  for (auto *Mod : Modules) {
+    forEachItem(*Mod, [](ItemDecl &Item) { Item.setReachable(false); });
+  }
+
+  collectRoots();
+  while (!Worklist.empty()) {
+    ItemDecl *Item = Worklist.back();
+    Worklist.pop_back();
+    visitItem(*Item);
+  }
+
+  for (auto *Mod : Modules) {
+    forEachItem(*Mod, [](ItemDecl &Item) {
+      if (Item.isReachable()) {
+        ++NumReachableItems;
+      } else {
+        ++NumUnreachableItems;
+      }
+    });
+  }
+}
+
+void Reachability::collectRoots() {
+  // A program starts at main
+  for (auto *Mod : Modules) {
+    for (auto &Item : Mod->getItems()) {
+      if (llvm::isa<FunDecl>(Item.get()) && Item->getId() == "main") {
+        reach(Item.get());
+      }
+    }
+  }
+  if (!Worklist.empty()) {
+    return;
+  }
+
+  // A library exports its public items
+  for (auto *Mod : Modules) {
+    for (auto *Item : Mod->getPublicItems()) {
+      reach(Item);
+    }
+  }
+  if (!Worklist.empty()) {
+    return;
+  }
+
+  // Nothing marks an entry point, so nothing can be left out
+  for (auto *Mod : Modules) {
+    forEachItem(*Mod, [this](ItemDecl &Item) { reach(&Item); });
+  }
+}
+
+void Reachability::reach(ItemDecl *Item) {
+  if (!Item || !Reached.insert(Item).second) {
+    return;
+  }
+  Item->setReachable(true);
+  Worklist.push_back(Item);
+}
+
+//===----------------------------------------------------------------------===//
+// Traversal
+//===----------------------------------------------------------------------===//
+
+void Reachability::visitItem(ItemDecl &Item) {
+  auto visitMethods = [&](AdtDecl &Adt) {
+    for (auto &Method : Adt.getMethods()) {
+      for (auto &Param : Method->getParams()) {
+        visitType(Param->getType());
+      }
+      visitType(Method->getReturnType());
+      visit(Method->getBody());
+    }
+  };
+
+  llvm::TypeSwitch<ItemDecl *>(&Item)
+      .Case<FunDecl>([&](FunDecl *X) {
+        for (auto &Param : X->getParams()) {
+          visitType(Param->getType());
+        }
+        visitType(X->getReturnType());
+        visit(X->getBody());
+      })
+      .Case<StructDecl>([&](StructDecl *X) {
+        for (auto &Field : X->getFields()) {
+          visitType(Field->getType());
+        }
+        visitMethods(*X);
+      })
+      .Case<EnumDecl>([&](EnumDecl *X) {
+        for (auto &Variant : X->getVariants()) {
+          if (Variant->hasPayload()) {
+            visitType(Variant->getPayloadType());
+          }
+        }
+        visitMethods(*X);
+      })
+      .Case<ModuleDecl>([&](ModuleDecl *X) {
+        forEachItem(*X, [this](ItemDecl &Nested) { reach(&Nested); });
+      });
+}
+
+void Reachability::visit(FunCallExpr &E) {
+  reach(E.getDecl());
+  RecursiveASTVisitor::visit(E);
+}
+
+void Reachability::visit(AdtInit &E) {
+  reach(E.getDecl());
+  RecursiveASTVisitor::visit(E);
+}
+
+void Reachability::visitType(TypeRef T) {
+  llvm::TypeSwitch<Type *>(T.getPtr())
+      .Case<AdtTy>([&](AdtTy *X) {
+        reach(const_cast<AdtDecl *>(X->getDecl()));
+      })
+      .Case<AppliedTy>([&](AppliedTy *X) {
+        visitType(X->getBase());
+        for (auto &Arg : X->getArgs()) {
+          visitType(Arg);
+        }
+      })
+      .Case<TupleTy>([&](TupleTy *X) {
+        for (auto &Elem : X->getElementTys()) {
+          visitType(Elem);
+        }
+      })
+      .Case<FunTy>([&](FunTy *X) {
+        for (auto &Param : X->getParamTys()) {
+          visitType(Param);
+        }
+        visitType(X->getReturnTy());
+      })
+      .Case<ArrayTy>([&](ArrayTy *X) { visitType(X->getContainedTy()); })
+      .Case<PtrTy>([&](PtrTy *X) { visitType(X->getPointee()); })
+      .Case<RefTy>([&](RefTy *X) { visitType(X->getPointee()); });
+}
+
+} // namespace phi
+
+#undef DEBUG_TYPE
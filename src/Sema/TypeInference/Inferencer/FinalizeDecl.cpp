@@ -24,6 +24,7 @@ void TypeInferencer::finalize(VarDecl &D) {
         .emit(*Diags);
   }
   D.setType(ResolvedT);
+  recordInstantiations(ResolvedT);
 }
 
 void TypeInferencer::finalize(FunDecl &D) { finalize(D.getBody()); }
@@ -1,9 +1,7 @@
 #include "Sema/TypeInference/Inferencer.hpp"
 
-#include <llvm/ADT/TypeSwitch.h>
 #include <llvm/Support/Casting.h>
 #include <optional>
-#include <print>
 
 #include "AST/Nodes/Decl.hpp"
 #include "AST/Nodes/Expr.hpp"
@@ -13,36 +11,11 @@
 namespace phi {
 
 void TypeInferencer::finalize(Expr &E) {
-  llvm::TypeSwitch<Expr *>(&E)
-      .Case<IntLiteral>([&](IntLiteral *X) { finalize(*X); })
-      .Case<FloatLiteral>([&](FloatLiteral *X) { finalize(*X); })
-      .Case<StrLiteral>([&](StrLiteral *X) { finalize(*X); })
-      .Case<CharLiteral>([&](CharLiteral *X) { finalize(*X); })
-      .Case<BoolLiteral>([&](BoolLiteral *X) { finalize(*X); })
-      .Case<RangeLiteral>([&](RangeLiteral *X) { finalize(*X); })
-      .Case<TupleLiteral>([&](TupleLiteral *X) { finalize(*X); })
-      .Case<ArrayLiteral>([&](ArrayLiteral *X) { finalize(*X); })
-      .Case<DeclRefExpr>([&](DeclRefExpr *X) { finalize(*X); })
-      .Case<FunCallExpr>([&](FunCallExpr *X) { finalize(*X); })
-      .Case<BinaryOp>([&](BinaryOp *X) { finalize(*X); })
-      .Case<UnaryOp>([&](UnaryOp *X) { finalize(*X); })
-      .Case<MemberInit>([&](MemberInit *X) { finalize(*X); })
-      .Case<FieldAccessExpr>([&](FieldAccessExpr *X) { finalize(*X); })
-      .Case<MethodCallExpr>([&](MethodCallExpr *X) { finalize(*X); })
-      .Case<MatchExpr>([&](MatchExpr *X) { finalize(*X); })
-      .Case<AdtInit>([&](AdtInit *X) { finalize(*X); })
-      .Case<IntrinsicCall>([&](IntrinsicCall *X) { finalize(*X); })
-      .Case<TupleIndex>([&](TupleIndex *X) { finalize(*X); })
-      .Case<ArrayIndex>([&](ArrayIndex *X) { finalize(*X); })
-      .Case<CastExpr>([&](CastExpr *X) { finalize(*X); })
-      .Default([&](Expr *) {
-        llvm_unreachable("Unhandled Expr kind in TypeInferencer");
-      });
+  dispatch(E, [this](auto &X) { finalize(X); });
 }
 
 void TypeInferencer::finalize(IntLiteral &E) {
   auto T = Unifier.resolve(E.getType());
-  std::println("finalize: {}", T.toString());
   assert(T.isBuiltin() || T.isVar());
   if (T.isVar()) {
     auto Int = llvm::dyn_cast<VarTy>(T.getPtr());
@@ -125,6 +98,7 @@ void TypeInferencer::finalize(FunCallExpr &E) {
     ResolvedTypeArgs.push_back(defaultVarTy(Resolved).value_or(Resolved));
   }
   E.setTypeArgs(ResolvedTypeArgs);
+  recordInstantiation(E.getDecl(), E.getTypeArgs());
 
   E.setType(Unifier.resolve(E.getType()));
 }
@@ -163,8 +137,6 @@ std::optional<TypeRef> TypeInferencer::defaultVarTy(TypeRef T) {
 }
 
 void TypeInferencer::finalize(AdtInit &E) {
-  std::println("{}", E.getSpan().toString());
-
   E.setType(Unifier.resolve(E.getType()));
 
   std::vector<TypeRef> ResolvedArgs;
@@ -178,6 +150,7 @@ void TypeInferencer::finalize(AdtInit &E) {
     ResolvedArgs.push_back(defaultVarTy(Resolved).value_or(Resolved));
   }
   E.setTypeArgs(ResolvedArgs);
+  recordInstantiation(E.getDecl(), E.getTypeArgs());
 
   TypeRef Base = E.getType();
   if (auto *App = llvm::dyn_cast<AppliedTy>(E.getType().getPtr())) {
@@ -250,7 +223,7 @@ void TypeInferencer::finalize(FieldAccessExpr &E) {
     return;
   }
 
-  auto *Field = Struct->getField(E.getFieldId());
+  auto *Field = Struct->getField(E.getFieldIdentifier());
   if (!Field) {
     error(std::format("Field `{}` not found in `{}`", E.getFieldId(),
                       Adt->getId()))
@@ -285,6 +258,7 @@ void TypeInferencer::finalize(MethodCallExpr &E) {
   E.setType(Unifier.resolve(E.getType()));
 
   if (E.getMethodPtr()) {
+    recordInstantiation(E);
     return;
   }
 
@@ -321,8 +295,9 @@ void TypeInferencer::finalize(MethodCallExpr &E) {
     return;
   }
 
-  std::string Id = llvm::dyn_cast<DeclRefExpr>(&E.getCallee())->getId();
-  auto *Method = Decl->getMethod(Id);
+  auto *Callee = llvm::dyn_cast<DeclRefExpr>(&E.getCallee());
+  const std::string &Id = Callee->getId();
+  auto *Method = Decl->getMethod(Callee->getIdentifier());
   if (!Method) {
     error(std::format("Method `{}` not found in `{}`", Id, Adt->getId()))
         .with_primary_label(
@@ -333,6 +308,7 @@ void TypeInferencer::finalize(MethodCallExpr &E) {
   }
   E.setMethod(Method);
   assert(E.getMethodPtr());
+  recordInstantiation(E);
 }
 
 void TypeInferencer::finalize(MatchExpr &E) {
@@ -390,8 +366,9 @@ void TypeInferencer::finalize(MatchExpr &E) {
               VariantDecl *Variant = Enum->getVariant(P.VariantName);
               if (!Variant) {
                 error("unknown enum variant")
-                    .with_primary_label(P.Location, "no variant named `" +
-                                                        P.VariantName + "`")
+                    .with_primary_label(P.Location,
+                                        "no variant named `" +
+                                            P.VariantName.str() + "`")
                     .emit(*Diags);
               }
 
@@ -469,6 +446,8 @@ void TypeInferencer::finalize(ArrayIndex &E) {
 void TypeInferencer::finalize(CastExpr &E) {
   finalize(*E.getFrom());
   E.setType(Unifier.resolve(E.getType()));
+  // The target type is written in the source, so nothing else records it
+  recordInstantiations(E.getType());
 }
 
 } // namespace phi
@@ -1,21 +1,19 @@
 #include "Sema/TypeInference/Inferencer.hpp"
 
-#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/ErrorHandling.h>
 
 namespace phi {
 
 void TypeInferencer::finalize(Stmt &S) {
-  llvm::TypeSwitch<Stmt *>(&S)
-      .Case<ReturnStmt>([&](ReturnStmt *X) { finalize(*X); })
-      .Case<DeferStmt>([&](DeferStmt *X) { finalize(*X); })
-      .Case<IfStmt>([&](IfStmt *X) { finalize(*X); })
-      .Case<WhileStmt>([&](WhileStmt *X) { finalize(*X); })
-      .Case<ForStmt>([&](ForStmt *X) { finalize(*X); })
-      .Case<DeclStmt>([&](DeclStmt *X) { finalize(*X); })
-      .Case<ContinueStmt>([&](ContinueStmt *X) { finalize(*X); })
-      .Case<BreakStmt>([&](BreakStmt *X) { finalize(*X); })
-      .Case<ExprStmt>([&](ExprStmt *X) { finalize(*X); })
-      .Default([&](Stmt *) { std::unreachable(); });
+  dispatch(S, [this](auto &X) { finalize(X); });
+}
+
+// Imports and uses are consumed by name resolution and never reach a body
+void TypeInferencer::finalize(ImportStmt &) {
+  llvm_unreachable("import statement in a body");
+}
+void TypeInferencer::finalize(UseStmt &) {
+  llvm_unreachable("use statement in a body");
 }
 
 void TypeInferencer::finalize(ReturnStmt &S) { finalize(S.getExpr()); }
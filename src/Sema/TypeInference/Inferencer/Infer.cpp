@@ -1,24 +1,136 @@
 #include "Sema/TypeInference/Inferencer.hpp"
 
+#include <deque>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include <llvm/ADT/Statistic.h>
+#include <llvm/ADT/TypeSwitch.h>
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/Parallel.h>
+#include <llvm/Support/Timer.h>
 
 #include "AST/TypeSystem/Type.hpp"
 #include "Sema/TypeInference/Unifier.hpp"
 
+#define DEBUG_TYPE "infer"
+
+STATISTIC(NumBodies, "Number of function and method bodies inferred");
+
 namespace phi {
 
+namespace {
+
+/// Starts a timer for one body when statistics are enabled. Timers are kept
+/// alive until the report is printed so the group lists every body together.
+llvm::Timer *startBodyTimer(const Decl &D) {
+  if (!llvm::AreStatisticsEnabled()) {
+    return nullptr;
+  }
+
+  static llvm::TimerGroup Group("infer", "Type inference time per body");
+  static std::mutex Mutex;
+  static std::deque<llvm::Timer> Timers;
+
+  std::string Name = llvm::TypeSwitch<const Decl *, std::string>(&D)
+                         .Case<MethodDecl>([](const MethodDecl *X) {
+                           return X->getParent()->getId() + "::" + X->getId();
+                         })
+                         .Case<FunDecl>([](const FunDecl *X) {
+                           return X->getId();
+                         });
+
+  std::scoped_lock Lock(Mutex);
+  return &Timers.emplace_back(Name, Name, Group);
+}
+
+} // namespace
+
 std::vector<ModuleDecl *> TypeInferencer::infer() {
-  for (auto &Mod : Modules)
-    visit(*Mod);
+  std::vector<Body> Bodies;
+  for (auto &Mod : Modules) {
+    collectBodies(*Mod, Bodies);
+  }
+
+  // Signatures are fully annotated, so no type variable is shared between two
+  // bodies and each one can be solved on its own worker. Diagnostics and
+  // instantiations are buffered per body and merged in declaration order
+  // afterwards.
+  std::vector<std::vector<Diagnostic>> BodyDiags(Bodies.size());
+  std::vector<InstantiationSet> BodyInsts(Bodies.size());
+  llvm::parallelFor(0, Bodies.size(), [&](size_t I) {
+    DiagnosticManager::ThreadCapture Capture(BodyDiags[I]);
+    BodyInsts[I] = inferBody(*Bodies[I].D);
+  });
+
+  for (auto &Buffered : BodyDiags) {
+    Diags->emitAll(Buffered);
+  }
 
-  for (auto &Mod : Modules)
-    finalize(*Mod);
+  for (size_t I = 0; I < Bodies.size(); ++I) {
+    Bodies[I].Module->getInstantiations().append(BodyInsts[I]);
+  }
 
   return std::move(Modules);
 }
 
+void TypeInferencer::collectBodies(ModuleDecl &D, std::vector<Body> &Bodies) {
+  // Signatures of unreachable items are still compiled and checked, only
+  // their bodies are left out
+  auto CollectMethods = [&](AdtDecl &Adt) {
+    for (auto &Method : Adt.getMethods()) {
+      Schemes->try_emplace(Method.get(), *Method);
+      if (Adt.isReachable()) {
+        Bodies.push_back({&D, Method.get()});
+      }
+    }
+  };
+
+  for (auto &Item : D.getItems()) {
+    llvm::TypeSwitch<Decl *>(Item.get())
+        .Case<FunDecl>([&](FunDecl *X) {
+          Schemes->try_emplace(X, *X);
+          if (X->isReachable()) {
+            Bodies.push_back({&D, X});
+          }
+        })
+        .Case<StructDecl>([&](StructDecl *X) {
+          Schemes->try_emplace(X, *X);
+          for (auto &Field : X->getFields()) {
+            visit(*Field);
+          }
+          CollectMethods(*X);
+        })
+        .Case<EnumDecl>([&](EnumDecl *X) {
+          Schemes->try_emplace(X, *X);
+          for (auto &Variant : X->getVariants()) {
+            visit(*Variant);
+          }
+          CollectMethods(*X);
+        })
+        .Case<ModuleDecl>([&](ModuleDecl *X) { collectBodies(*X, Bodies); })
+        .Default([&](Decl *X) { visit(*X); });
+  }
+}
+
+InstantiationSet TypeInferencer::inferBody(Decl &D) {
+  ++NumBodies;
+  llvm::TimeRegion Timing(startBodyTimer(D));
+
+  TypeInferencer Worker({}, Diags);
+  Worker.Schemes = Schemes;
+  Worker.visit(D);
+  Worker.finalize(D);
+  return std::move(Worker.Instantiations);
+}
+
+const TypeScheme &TypeInferencer::getScheme(const Decl &D) const {
+  auto It = Schemes->find(&D);
+  assert(It != Schemes->end() && "no type scheme compiled for declaration");
+  return It->second;
+}
+
 std::string TypeInferencer::toString(TypeRef T) {
   auto A = Unifier.resolve(T);
   if (A.isVar()) {
@@ -39,3 +151,5 @@ std::string TypeInferencer::toString(TypeRef T) {
 }
 
 } // namespace phi
+
+#undef DEBUG_TYPE
@@ -1,7 +1,6 @@
 #include "Sema/TypeInference/Inferencer.hpp"
 
 #include <memory>
-#include <unordered_map>
 
 #include <llvm/ADT/TypeSwitch.h>
 
@@ -27,47 +26,6 @@ void TypeInferencer::visit(Decl &D) {
       });
 }
 
-std::unordered_map<const TypeArgDecl *, TypeRef>
-TypeInferencer::buildGenericSubstMap(
-    const std::vector<std::unique_ptr<TypeArgDecl>> &TypeArgs) {
-  std::unordered_map<const TypeArgDecl *, TypeRef> Map;
-  for (auto &T : TypeArgs) {
-    Map.emplace(T.get(), TypeCtx::getVar(VarTy::Any, T->getSpan()));
-    assert(Map.contains(T.get()));
-  }
-  return Map;
-}
-
-TypeRef TypeInferencer::substituteGenerics(
-    TypeRef Ty, const std::unordered_map<const TypeArgDecl *, TypeRef> &Map) {
-  if (Map.empty()) {
-    return Ty;
-  }
-
-  if (auto G = llvm::dyn_cast<GenericTy>(Ty.getPtr())) {
-    auto It = Map.find(G->getDecl());
-    if (It != Map.end()) {
-      return It->second;
-    }
-    return Ty;
-  }
-
-  if (auto App = llvm::dyn_cast<AppliedTy>(Ty.getPtr())) {
-    std::vector<TypeRef> SubstitutedArgs;
-    for (auto &ArgTy : App->getArgs()) {
-      SubstitutedArgs.push_back(substituteGenerics(ArgTy, Map));
-    }
-    return TypeCtx::getApplied(App->getBase(), SubstitutedArgs, Ty.getSpan());
-  }
-
-  if (auto Arr = llvm::dyn_cast<ArrayTy>(Ty.getPtr())) {
-    return TypeCtx::getArray(substituteGenerics(Arr->getContainedTy(), Map),
-                             Ty.getSpan());
-  }
-
-  return Ty;
-}
-
 TypeRef TypeInferencer::instantiate(Decl *D) {
   return llvm::TypeSwitch<Decl *, TypeRef>(D)
       .Case<LocalDecl>([&](LocalDecl *X) {
@@ -76,28 +34,9 @@ TypeRef TypeInferencer::instantiate(Decl *D) {
         }
         return X->getType();
       })
-      .Case<FunDecl>([&](FunDecl *X) {
-        auto Map = buildGenericSubstMap(X->getTypeArgs());
-
-        std::vector<TypeRef> ParamTs;
-        for (auto &Param : X->getParams()) {
-          ParamTs.emplace_back(substituteGenerics(Param->getType(), Map));
-        }
-        TypeRef ReturnT = substituteGenerics(X->getReturnType(), Map);
-        return TypeCtx::getFun(std::move(ParamTs), std::move(ReturnT),
-                               X->getSpan());
-      })
-      .Case<MethodDecl>([&](MethodDecl *X) {
-        auto Map = buildGenericSubstMap(X->getTypeArgs());
-        Map.merge(buildGenericSubstMap(X->getParent()->getTypeArgs()));
-
-        std::vector<TypeRef> ParamTs;
-        for (auto &Param : X->getParams()) {
-          ParamTs.emplace_back(substituteGenerics(Param->getType(), Map));
-        }
-        TypeRef ReturnT = substituteGenerics(X->getReturnType(), Map);
-        return TypeCtx::getFun(std::move(ParamTs), std::move(ReturnT),
-                               X->getSpan());
+      .Case<FunDecl, MethodDecl>([&](auto *X) {
+        const auto &Scheme = getScheme(*X);
+        return Scheme.instantiateSignature(Scheme.freshArgs());
       })
       .Case<FieldDecl>([&](FieldDecl *X) {
         if (X->getType().isGeneric()) {
@@ -162,7 +101,7 @@ void TypeInferencer::visit(FieldDecl &D) {
   }
 
   auto T = instantiate(&D);
-  auto Res = Unifier.unify(T, D.getInit().getType());
+  auto Res = Unifier.coerce(D.getInit().getType(), T);
   if (!Res) {
     error("Mismatched types in field declaration")
         .with_primary_label(D.getInit().getSpan(),
@@ -1,7 +1,6 @@
 #include "Sema/TypeInference/Inferencer.hpp"
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <llvm/ADT/STLExtras.h>
@@ -18,41 +17,12 @@
 
 namespace phi {
 
-TypeRef TypeInferencer::visit(Expr &E) {
-  return llvm::TypeSwitch<Expr *, TypeRef>(&E)
-      .Case<IntLiteral>([&](IntLiteral *X) { return visit(*X); })
-      .Case<FloatLiteral>([&](FloatLiteral *X) { return visit(*X); })
-      .Case<StrLiteral>([&](StrLiteral *X) { return visit(*X); })
-      .Case<CharLiteral>([&](CharLiteral *X) { return visit(*X); })
-      .Case<BoolLiteral>([&](BoolLiteral *X) { return visit(*X); })
-      .Case<RangeLiteral>([&](RangeLiteral *X) { return visit(*X); })
-      .Case<TupleLiteral>([&](TupleLiteral *X) { return visit(*X); })
-      .Case<ArrayLiteral>([&](ArrayLiteral *X) { return visit(*X); })
-      .Case<DeclRefExpr>([&](DeclRefExpr *X) { return visit(*X); })
-      .Case<FunCallExpr>([&](FunCallExpr *X) { return visit(*X); })
-      .Case<BinaryOp>([&](BinaryOp *X) { return visit(*X); })
-      .Case<UnaryOp>([&](UnaryOp *X) { return visit(*X); })
-      .Case<MemberInit>([&](MemberInit *X) { return visit(*X); })
-      .Case<FieldAccessExpr>([&](FieldAccessExpr *X) { return visit(*X); })
-      .Case<MethodCallExpr>([&](MethodCallExpr *X) { return visit(*X); })
-      .Case<MatchExpr>([&](MatchExpr *X) { return visit(*X); })
-      .Case<AdtInit>([&](AdtInit *X) { return visit(*X); })
-      .Case<IntrinsicCall>([&](IntrinsicCall *X) { return visit(*X); })
-      .Case<TupleIndex>([&](TupleIndex *X) { return visit(*X); })
-      .Case<ArrayIndex>([&](ArrayIndex *X) { return visit(*X); })
-      .Case<CastExpr>([&](CastExpr *X) { return visit(*X); })
-      .Default([&](Expr *) {
-        llvm_unreachable("Unhandled Expr kind in TypeInferencer");
-        return TypeCtx::getErr(E.getSpan());
-      });
-}
-
 TypeRef TypeInferencer::visit(IntLiteral &E) {
-  return Unifier.resolve(E.getType());
+  return Unifier.shallow(E.getType());
 }
 
 TypeRef TypeInferencer::visit(FloatLiteral &E) {
-  return Unifier.resolve(E.getType());
+  return Unifier.shallow(E.getType());
 }
 
 TypeRef TypeInferencer::visit(BoolLiteral &E) {
@@ -96,13 +66,15 @@ TypeRef TypeInferencer::visit(TupleLiteral &E) {
 }
 
 TypeRef TypeInferencer::visit(ArrayLiteral &E) {
-  TypeRef ContainedTy = E.getElements().front()->getType();
+  TypeRef ContainedTy = visit(*E.getElements().front());
   for (auto &Elem : llvm::drop_begin(E.getElements(), 1)) {
-    Unifier.unify(ContainedTy, Elem->getType());
+    Unifier.unify(ContainedTy, visit(*Elem));
   }
 
-  Unifier.unify(TypeCtx::getArray(ContainedTy, E.getSpan()), E.getType());
-  return Unifier.resolve(E.getType());
+  Unifier.unify(TypeCtx::getArray(ContainedTy, E.getSpan(),
+                                  E.getElements().size()),
+                E.getType());
+  return Unifier.shallow(E.getType());
 }
 
 TypeRef TypeInferencer::visit(DeclRefExpr &E) {
@@ -114,7 +86,7 @@ TypeRef TypeInferencer::visit(DeclRefExpr &E) {
     return TypeCtx::getErr(E.getSpan());
   }
 
-  return Unifier.resolve(E.getType());
+  return Unifier.shallow(E.getType());
 }
 
 TypeRef TypeInferencer::visit(FunCallExpr &E) {
@@ -122,31 +94,28 @@ TypeRef TypeInferencer::visit(FunCallExpr &E) {
 
   bool Errored = false;
 
-  auto Map = buildGenericSubstMap(E.getDecl()->getTypeArgs());
+  const auto &Scheme = getScheme(*E.getDecl());
+  auto TypeArgs = Scheme.freshArgs();
 
   // If explicit type arguments are provided, unify them with the generic
   // parameters
   if (E.hasTypeArgs()) {
-    if (E.getTypeArgs().size() != E.getDecl()->getTypeArgs().size()) {
+    if (E.getTypeArgs().size() != TypeArgs.size()) {
       error("Generic argument count mismatch")
           .with_primary_label(
               E.getSpan(), std::format("expected {} generic arguments, got {}",
-                                       E.getDecl()->getTypeArgs().size(),
-                                       E.getTypeArgs().size()))
+                                       TypeArgs.size(), E.getTypeArgs().size()))
           .emit(*Diags);
     } else {
-      for (auto [Explicit, GenericParam] :
-           llvm::zip(E.getTypeArgs(), E.getDecl()->getTypeArgs())) {
-        auto It = Map.find(GenericParam.get());
-        assert(It != Map.end());
-        Unifier.unify(It->second, Explicit);
+      for (auto [Explicit, Arg] : llvm::zip(E.getTypeArgs(), TypeArgs)) {
+        Unifier.unify(Arg, Explicit);
       }
     }
   }
 
   std::vector<TypeRef> InferredTypeArgs;
-  for (auto &Pair : Map) {
-    InferredTypeArgs.push_back(Unifier.resolve(Pair.second));
+  for (auto &Arg : TypeArgs) {
+    InferredTypeArgs.push_back(Unifier.shallow(Arg));
   }
   E.setTypeArgs(InferredTypeArgs);
 
@@ -163,8 +132,8 @@ TypeRef TypeInferencer::visit(FunCallExpr &E) {
   for (auto [Arg, Param] : llvm::zip(E.getArgs(), E.getDecl()->getParams())) {
     visit(*Arg);
 
-    auto Res = Unifier.unify(Arg->getType(),
-                             substituteGenerics(Param->getType(), Map));
+    auto Res =
+        Unifier.coerce(Arg->getType(), Scheme.instantiate(*Param, TypeArgs));
 
     if (!Res) {
       Errored = true;
@@ -180,12 +149,10 @@ TypeRef TypeInferencer::visit(FunCallExpr &E) {
     }
   }
 
-  Errored =
-      Unifier.unify(E.getType(),
-                    substituteGenerics(E.getDecl()->getReturnType(), Map)) &&
-      Errored;
+  Errored = Unifier.unify(E.getType(), Scheme.instantiateReturn(TypeArgs)) &&
+            Errored;
   auto Res =
-      Errored ? TypeCtx::getErr(E.getSpan()) : Unifier.resolve(E.getType());
+      Errored ? TypeCtx::getErr(E.getSpan()) : Unifier.shallow(E.getType());
   E.setType(Res);
   return Res;
 }
@@ -222,27 +189,12 @@ TypeRef TypeInferencer::visit(BinaryOp &E) {
     return TypeCtx::getBuiltin(BuiltinTy::Bool, E.getSpan());
   }
 
-  auto Res = Unifier.unify(LhsType, RhsType);
-  if (!Res) {
-    error("Operands have different types")
-        .with_primary_label(E.getLhs().getSpan(),
-                            std::format("type `{}`", toString(LhsType)))
-        .with_secondary_label(E.getRhs().getSpan(),
-                              std::format("type `{}`", toString(RhsType)))
-        .emit(*Diags);
-    return TypeCtx::getErr(E.getSpan());
-  }
-
-  if (K.isComparison() || K.isEquality()) {
-    auto Bool = TypeCtx::getBuiltin(BuiltinTy::Bool, E.getSpan());
-    Unifier.unify(E.getType(), Bool);
-    return Bool;
-  }
-
   if (K == TokenKind::Equals || K == TokenKind::PlusEquals ||
       K == TokenKind::SubEquals || K == TokenKind::MulEquals ||
       K == TokenKind::DivEquals || K == TokenKind::ModEquals) {
-    auto Res = Unifier.unify(LhsType, RhsType);
+    // A plain assignment stores the value as the variable's type
+    auto Res = K == TokenKind::Equals ? Unifier.coerce(RhsType, LhsType)
+                                      : Unifier.unify(LhsType, RhsType);
     if (!Res) {
       error("Mismatched types in assignment")
           .with_primary_label(
@@ -257,9 +209,26 @@ TypeRef TypeInferencer::visit(BinaryOp &E) {
     return LhsType;
   }
 
+  auto Res = Unifier.unify(LhsType, RhsType);
+  if (!Res) {
+    error("Operands have different types")
+        .with_primary_label(E.getLhs().getSpan(),
+                            std::format("type `{}`", toString(LhsType)))
+        .with_secondary_label(E.getRhs().getSpan(),
+                              std::format("type `{}`", toString(RhsType)))
+        .emit(*Diags);
+    return TypeCtx::getErr(E.getSpan());
+  }
+
+  if (K.isComparison() || K.isEquality()) {
+    auto Bool = TypeCtx::getBuiltin(BuiltinTy::Bool, E.getSpan());
+    Unifier.unify(E.getType(), Bool);
+    return Bool;
+  }
+
   assert(K.isArithmetic());
   Unifier.unify(E.getType(), LhsType);
-  return Unifier.resolve(E.getType());
+  return Unifier.shallow(E.getType());
 }
 
 TypeRef TypeInferencer::visit(UnaryOp &E) {
@@ -284,7 +253,7 @@ TypeRef TypeInferencer::visit(UnaryOp &E) {
   case phi::TokenKind::Minus: {
     // Unary minus
     Unifier.unify(E.getType(), OperandT);
-    return Unifier.resolve(E.getType());
+    return Unifier.shallow(E.getType());
   }
   case phi::TokenKind::DoublePlus:
   case phi::TokenKind::DoubleMinus: {
@@ -292,7 +261,7 @@ TypeRef TypeInferencer::visit(UnaryOp &E) {
     // Operand must be numeric (or unify with result)
     // For now assume same type
     Unifier.unify(E.getType(), OperandT);
-    return Unifier.resolve(E.getType());
+    return Unifier.shallow(E.getType());
   }
   case phi::TokenKind::Star: {
     // Wait, Deref returns Pointee.
@@ -322,24 +291,21 @@ TypeRef TypeInferencer::visit(AdtInit &E) {
 
   // if !E.isAnonymous(), then we already know the type of E
   // after name resolution
-  auto Map = buildGenericSubstMap(E.getDecl()->getTypeArgs());
+  const auto &Scheme = getScheme(*E.getDecl());
+  auto TypeArgs = Scheme.freshArgs();
 
   // If explicit type arguments are provided, unify them with the generic
   // parameters
   if (!E.getTypeArgs().empty()) {
-    if (E.getTypeArgs().size() != E.getDecl()->getTypeArgs().size()) {
+    if (E.getTypeArgs().size() != TypeArgs.size()) {
       error("Generic argument count mismatch")
           .with_primary_label(
               E.getSpan(), std::format("expected {} generic arguments, got {}",
-                                       E.getDecl()->getTypeArgs().size(),
-                                       E.getTypeArgs().size()))
+                                       TypeArgs.size(), E.getTypeArgs().size()))
           .emit(*Diags);
     } else {
-      for (auto [Explicit, GenericParam] :
-           llvm::zip(E.getTypeArgs(), E.getDecl()->getTypeArgs())) {
-        auto It = Map.find(GenericParam.get());
-        assert(It != Map.end());
-        Unifier.unify(It->second, Explicit);
+      for (auto [Explicit, Arg] : llvm::zip(E.getTypeArgs(), TypeArgs)) {
+        Unifier.unify(Arg, Explicit);
       }
     }
   }
@@ -351,10 +317,10 @@ TypeRef TypeInferencer::visit(AdtInit &E) {
     assert(!E.isAnonymous());
     llvm::TypeSwitch<AdtDecl *>(E.getDecl())
         .Case<StructDecl>([&](StructDecl *D) {
-          auto *Field = D->getField(Init->getId());
-          auto Declared = substituteGenerics(Field->getType(), Map);
+          auto *Field = D->getField(Init->getIdentifier());
+          auto Declared = Scheme.instantiate(*Field, TypeArgs);
           auto Got = Init->getInitValue()->getType();
-          if (!Unifier.unify(Declared, Got)) {
+          if (!Unifier.coerce(Got, Declared)) {
             error("Mismatched types in struct initialization")
                 .with_primary_label(Init->getInitValue()->getSpan(),
                                     std::format("expected `{}`, got `{}`",
@@ -365,11 +331,11 @@ TypeRef TypeInferencer::visit(AdtInit &E) {
           }
         })
         .Case<EnumDecl>([&](EnumDecl *D) {
-          auto *Variant = D->getVariant(Init->getId());
+          auto *Variant = D->getVariant(Init->getIdentifier());
           if (Variant->hasPayload()) {
-            auto Declared = substituteGenerics(Variant->getPayloadType(), Map);
+            auto Declared = Scheme.instantiate(*Variant, TypeArgs);
             auto Got = Init->getInitValue()->getType();
-            if (!Unifier.unify(Declared, Got)) {
+            if (!Unifier.coerce(Got, Declared)) {
               error("Mismatched types in enum variant payload")
                   .with_primary_label(Init->getInitValue()->getSpan(),
                                       std::format("expected `{}`, got `{}`",
@@ -390,8 +356,8 @@ TypeRef TypeInferencer::visit(AdtInit &E) {
     return E.getType();
 
   std::vector<TypeRef> InferredTypeArgs;
-  for (auto &Pair : Map) {
-    InferredTypeArgs.push_back(Unifier.resolve(Pair.second));
+  for (auto &Arg : TypeArgs) {
+    InferredTypeArgs.push_back(Unifier.shallow(Arg));
   }
 
   E.setTypeArgs(InferredTypeArgs);
@@ -406,7 +372,7 @@ TypeRef TypeInferencer::visit(MemberInit &E) {
   }
 
   auto T = visit(*E.getInitValue());
-  return Unifier.resolve(T);
+  return Unifier.shallow(T);
 }
 
 TypeRef TypeInferencer::visit(FieldAccessExpr &E) {
@@ -449,7 +415,7 @@ TypeRef TypeInferencer::visit(FieldAccessExpr &E) {
     return TypeCtx::getErr(E.getSpan());
   }
 
-  auto *Field = Struct->getField(E.getFieldId());
+  auto *Field = Struct->getField(E.getFieldIdentifier());
   if (!Field) {
     error(std::format("Field `{}` not found in `{}`", E.getFieldId(),
                       Adt->getId()))
@@ -468,20 +434,15 @@ TypeRef TypeInferencer::visit(FieldAccessExpr &E) {
     return Field->getType();
   }
 
-  auto *App = llvm::dyn_cast<AppliedTy>(T.getPtr());
-  std::unordered_map<const TypeArgDecl *, TypeRef> Map;
-  for (const auto &[Arg, Inst] :
-       llvm::zip(Struct->getTypeArgs(), App->getArgs())) {
-    Map.emplace(Arg.get(), Inst);
-  }
-  auto FieldT = substituteGenerics(Field->getType(), Map);
+  auto *App = llvm::cast<AppliedTy>(T.getPtr());
+  auto FieldT = getScheme(*Struct).instantiate(*Field, App->getArgs());
   Unifier.unify(E.getType(), FieldT);
   return FieldT;
 }
 
 TypeRef TypeInferencer::visit(MethodCallExpr &E) {
   // 1. Infer base type
-  auto BaseT = visit(*E.getBase());
+  auto BaseT = Unifier.resolve(visit(*E.getBase()));
   auto UnderlyingBaseT = BaseT.getUnderlying();
 
   // 2. Only ADTs can have methods
@@ -511,8 +472,9 @@ TypeRef TypeInferencer::visit(MethodCallExpr &E) {
     return TypeCtx::getErr(E.getSpan());
   }
 
-  std::string Id = llvm::dyn_cast<DeclRefExpr>(&E.getCallee())->getId();
-  auto *Method = Decl->getMethod(Id);
+  auto *Callee = llvm::dyn_cast<DeclRefExpr>(&E.getCallee());
+  const std::string &Id = Callee->getId();
+  auto *Method = Decl->getMethod(Callee->getIdentifier());
   if (!Method) {
     error(std::format("Method `{}` not found in `{}`", Id, Adt->getId()))
         .with_primary_label(
@@ -526,40 +488,43 @@ TypeRef TypeInferencer::visit(MethodCallExpr &E) {
   bool Errored = false;
 
   auto BaseNoIndir = BaseT.removeIndir();
-  std::unordered_map<const TypeArgDecl *, TypeRef> Map;
+  const auto &Scheme = getScheme(*Method);
+
+  // The receiver's type arguments fill the ADT's parameters, which come first
+  // in the method's scheme; only the method's own parameters get fresh
+  // variables. Inside the ADT (`this` is not applied) its parameters stand
+  // for themselves.
+  llvm::ArrayRef<TypeRef> AdtArgs;
   if (auto *App = llvm::dyn_cast<AppliedTy>(BaseNoIndir.getPtr())) {
-    for (const auto &[Arg, Inst] :
-         llvm::zip(Decl->getTypeArgs(), App->getArgs())) {
-      Map.emplace(Arg.get(), Inst);
-    }
+    AdtArgs = App->getArgs();
+  } else if (Decl->hasTypeArgs()) {
+    AdtArgs = llvm::cast<AppliedTy>(Decl->getType().getPtr())->getArgs();
   }
-
-  auto Temp = buildGenericSubstMap(Method->getTypeArgs());
+  const size_t NumAdtArgs = Decl->getTypeArgs().size();
+  auto TypeArgs = Scheme.freshArgs(AdtArgs.take_front(NumAdtArgs));
+  auto MethodTypeArgs =
+      llvm::ArrayRef<TypeRef>(TypeArgs).drop_front(NumAdtArgs);
 
   // If explicit type arguments are provided for the method, unify them
   if (E.hasTypeArgs()) {
-    if (E.getTypeArgs().size() != Method->getTypeArgs().size()) {
+    if (E.getTypeArgs().size() != MethodTypeArgs.size()) {
       error("Generic argument count mismatch")
           .with_primary_label(
               E.getSpan(),
               std::format("expected {} generic arguments, got {}",
-                          Method->getTypeArgs().size(), E.getTypeArgs().size()))
+                          MethodTypeArgs.size(), E.getTypeArgs().size()))
           .emit(*Diags);
     } else {
-      for (auto [Explicit, GenericParam] :
-           llvm::zip(E.getTypeArgs(), Method->getTypeArgs())) {
-        auto It = Temp.find(GenericParam.get());
-        assert(It != Temp.end());
-        Unifier.unify(It->second, Explicit);
+      for (auto [Explicit, Arg] : llvm::zip(E.getTypeArgs(), MethodTypeArgs)) {
+        Unifier.unify(Arg, Explicit);
       }
     }
   }
 
   std::vector<TypeRef> InferredTypeArgs;
-  for (auto &Pair : Temp) {
-    InferredTypeArgs.push_back(Unifier.resolve(Pair.second));
+  for (auto &Arg : MethodTypeArgs) {
+    InferredTypeArgs.push_back(Unifier.shallow(Arg));
   }
-  Map.merge(Temp);
   E.setTypeArgs(InferredTypeArgs);
 
   // 6. Parameter arity check (method params include 'self' as first param)
@@ -578,9 +543,9 @@ TypeRef TypeInferencer::visit(MethodCallExpr &E) {
          llvm::zip(E.getArgs(), llvm::drop_begin(Params, 1))) {
       // visit arg to compute its type
       auto ArgT = visit(*Arg);
-      auto ParamT = substituteGenerics(Param->getType(), Map);
+      auto ParamT = Scheme.instantiate(*Param, TypeArgs);
 
-      if (!Unifier.unify(ArgT, ParamT)) {
+      if (!Unifier.coerce(ArgT, ParamT)) {
         error(std::format("Mismatched type for parameter `{}`", Param->getId()))
             .with_primary_label(Arg->getSpan(),
                                 std::format("expected type `{}` but got `{}`",
@@ -591,11 +556,10 @@ TypeRef TypeInferencer::visit(MethodCallExpr &E) {
     }
   }
 
-  Errored = Unifier.unify(E.getType(),
-                          substituteGenerics(Method->getReturnType(), Map)) &&
+  Errored = Unifier.unify(E.getType(), Scheme.instantiateReturn(TypeArgs)) &&
             Errored;
   auto Res =
-      Errored ? TypeCtx::getErr(E.getSpan()) : Unifier.resolve(E.getType());
+      Errored ? TypeCtx::getErr(E.getSpan()) : Unifier.shallow(E.getType());
   E.setType(Res);
   return Res;
 }
@@ -611,7 +575,7 @@ TypeRef TypeInferencer::visit(MatchExpr &E) {
           if constexpr (std::is_same_v<T, PatternAtomics::Literal>) {
             assert(Pattern.Value && "Literal pattern has no expression value");
             auto LiteralType = visit(*Pattern.Value);
-            return Unifier.resolve(LiteralType);
+            return Unifier.shallow(LiteralType);
           }
 
           else if constexpr (std::is_same_v<T, PatternAtomics::Variant>) {
@@ -641,7 +605,7 @@ TypeRef TypeInferencer::visit(MatchExpr &E) {
     Unifier.unify(E.getType(), ArmT);
   }
 
-  return Unifier.resolve(E.getType());
+  return Unifier.shallow(E.getType());
 }
 
 TypeRef TypeInferencer::visit(IntrinsicCall &E) {
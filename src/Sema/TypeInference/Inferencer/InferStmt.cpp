@@ -2,7 +2,6 @@
 
 #include <cassert>
 #include <llvm-18/llvm/ADT/STLExtras.h>
-#include <llvm/ADT/TypeSwitch.h>
 #include <llvm/Support/Casting.h>
 #include <print>
 
@@ -11,20 +10,6 @@
 
 namespace phi {
 
-void TypeInferencer::visit(Stmt &S) {
-  llvm::TypeSwitch<Stmt *>(&S)
-      .Case<ReturnStmt>([&](ReturnStmt *X) { visit(*X); })
-      .Case<DeferStmt>([&](DeferStmt *X) { visit(*X); })
-      .Case<IfStmt>([&](IfStmt *X) { visit(*X); })
-      .Case<WhileStmt>([&](WhileStmt *X) { visit(*X); })
-      .Case<ForStmt>([&](ForStmt *X) { visit(*X); })
-      .Case<DeclStmt>([&](DeclStmt *X) { visit(*X); })
-      .Case<ContinueStmt>([&](ContinueStmt *X) { visit(*X); })
-      .Case<BreakStmt>([&](BreakStmt *X) { visit(*X); })
-      .Case<ExprStmt>([&](ExprStmt *X) { visit(*X); })
-      .Default([&](Stmt *) { std::unreachable(); });
-}
-
 void TypeInferencer::visit(ReturnStmt &S) {
   if (!S.hasExpr()) {
     return;
@@ -37,7 +22,7 @@ void TypeInferencer::visit(ReturnStmt &S) {
         using T = std::decay_t<decltype(Fun)>;
 
         if constexpr (!std::is_same_v<T, std::monostate>) {
-          auto Res = Unifier.unify(Fun->getReturnType(), ExprT);
+          auto Res = Unifier.coerce(ExprT, Fun->getReturnType());
           if (!Res) {
             error("Mismatched return type")
                 .with_primary_label(S.getExpr().getSpan(),
@@ -122,7 +107,7 @@ void TypeInferencer::visit(DeclStmt &S) {
   }
 
   visit(S.getInit());
-  auto InitT = Unifier.resolve(S.getInit().getType());
+  auto InitT = Unifier.shallow(S.getInit().getType());
   if (S.getDecls().size() > 1 && !InitT.isTuple()) {
     error("cannot destructure non-tuple type")
         .with_primary_label(
@@ -154,7 +139,7 @@ void TypeInferencer::visit(DeclStmt &S) {
       InitT = llvm::dyn_cast<TupleTy>(InitT.getPtr())->getElementTys()[i];
     }
 
-    auto Res = Unifier.unify(T, InitT);
+    auto Res = Unifier.coerce(InitT, T);
     if (!Res) {
       error("Mismatched types in variable declaration")
           .with_primary_label(S.getInit().getSpan(),
@@ -0,0 +1,113 @@
+#include "Sema/TypeInference/Inferencer.hpp"
+
+#include <llvm/ADT/Statistic.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/Casting.h>
+
+#include "AST/Nodes/Decl.hpp"
+#include "AST/TypeSystem/Type.hpp"
+
+#define DEBUG_TYPE "infer"
+
+STATISTIC(NumInstantiationsRecorded,
+          "Number of generic instantiations recorded during finalization");
+
+namespace phi {
+
+namespace {
+
+/// True if \p T mentions no type parameter and no unsolved variable, so that
+/// it names the same type in every context
+bool isConcrete(TypeRef T) {
+  return llvm::TypeSwitch<const Type *, bool>(T.getPtr())
+      .Case<GenericTy, VarTy, ErrTy>([](auto *) { return false; })
+      .Case<AppliedTy>([](const AppliedTy *X) {
+        return isConcrete(X->getBase()) &&
+               llvm::all_of(X->getArgs(), isConcrete);
+      })
+      .Case<TupleTy>([](const TupleTy *X) {
+        return llvm::all_of(X->getElementTys(), isConcrete);
+      })
+      .Case<FunTy>([](const FunTy *X) {
+        return llvm::all_of(X->getParamTys(), isConcrete) &&
+               isConcrete(X->getReturnTy());
+      })
+      .Case<ArrayTy>(
+          [](const ArrayTy *X) { return isConcrete(X->getContainedTy()); })
+      .Case<PtrTy>([](const PtrTy *X) { return isConcrete(X->getPointee()); })
+      .Case<RefTy>([](const RefTy *X) { return isConcrete(X->getPointee()); })
+      .Default([](const Type *) { return true; });
+}
+
+} // namespace
+
+void TypeInferencer::recordInstantiation(const NamedDecl *D,
+                                         const std::vector<TypeRef> &TypeArgs) {
+  if (!D || TypeArgs.empty()) {
+    return;
+  }
+
+  // Items and methods are the only declarations with type parameters
+  bool IsGeneric = false;
+  if (auto *Item = llvm::dyn_cast<ItemDecl>(D)) {
+    IsGeneric = Item->hasTypeArgs();
+  } else if (auto *Method = llvm::dyn_cast<MethodDecl>(D)) {
+    IsGeneric = Method->hasTypeArgs() || Method->getParent()->hasTypeArgs();
+  }
+  if (!IsGeneric) {
+    return;
+  }
+
+  // A use inside another generic body is instantiated when that body is
+  // monomorphized, once its own parameters are known
+  if (!llvm::all_of(TypeArgs, isConcrete)) {
+    return;
+  }
+
+  if (Instantiations.insert({D, TypeArgs})) {
+    ++NumInstantiationsRecorded;
+  }
+}
+
+void TypeInferencer::recordInstantiations(TypeRef T) {
+  llvm::TypeSwitch<const Type *>(T.getPtr())
+      .Case<AppliedTy>([&](const AppliedTy *X) {
+        for (const auto &Arg : X->getArgs()) {
+          recordInstantiations(Arg);
+        }
+        if (auto *Adt = llvm::dyn_cast<AdtTy>(X->getBase().getPtr())) {
+          recordInstantiation(Adt->getDecl(), X->getArgs());
+        }
+      })
+      .Case<TupleTy>([&](const TupleTy *X) {
+        for (const auto &Elem : X->getElementTys()) {
+          recordInstantiations(Elem);
+        }
+      })
+      .Case<ArrayTy>(
+          [&](const ArrayTy *X) { recordInstantiations(X->getContainedTy()); })
+      .Case<PtrTy>(
+          [&](const PtrTy *X) { recordInstantiations(X->getPointee()); })
+      .Case<RefTy>(
+          [&](const RefTy *X) { recordInstantiations(X->getPointee()); });
+}
+
+void TypeInferencer::recordInstantiation(const MethodCallExpr &E) {
+  const MethodDecl *Method = E.getMethodPtr();
+  if (!Method->getParent()->hasTypeArgs()) {
+    recordInstantiation(Method, E.getTypeArgs());
+    return;
+  }
+
+  // The receiver's type arguments pick the parent instance. A receiver that
+  // is not applied yet (`this` inside a generic method) is instantiated when
+  // the enclosing body is monomorphized.
+  Type *Receiver = E.getBase()->getType().removeIndir().getPtr();
+  if (auto *App = llvm::dyn_cast<AppliedTy>(Receiver)) {
+    recordInstantiation(Method, App->getArgs());
+  }
+}
+
+} // namespace phi
+
+#undef DEBUG_TYPE
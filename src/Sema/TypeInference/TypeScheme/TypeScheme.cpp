@@ -0,0 +1,228 @@
+#include "Sema/TypeInference/TypeScheme.hpp"
+
+#include <cassert>
+
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/Statistic.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/ErrorHandling.h>
+
+#include "AST/TypeSystem/Context.hpp"
+
+#define DEBUG_TYPE "typescheme"
+
+STATISTIC(NumSchemes, "Number of type schemes compiled");
+STATISTIC(NumInstantiations, "Number of generic instantiations");
+STATISTIC(NumMemberInstantiations, "Number of member types rebuilt from a scheme");
+
+namespace phi {
+
+//===----------------------------------------------------------------------===//
+// Constructors
+//===----------------------------------------------------------------------===//
+
+TypeScheme::TypeScheme(const FunDecl &D) {
+  ++NumSchemes;
+  addTypeParams(D.getTypeArgs());
+  compileFunction(D.getParams(), D.getReturnType(), D.getSpan());
+}
+
+TypeScheme::TypeScheme(const MethodDecl &D) {
+  ++NumSchemes;
+  addTypeParams(D.getParent()->getTypeArgs());
+  addTypeParams(D.getTypeArgs());
+  compileFunction(D.getParams(), D.getReturnType(), D.getSpan());
+}
+
+TypeScheme::TypeScheme(const AdtDecl &D) {
+  ++NumSchemes;
+  addTypeParams(D.getTypeArgs());
+  llvm::TypeSwitch<const AdtDecl *>(&D)
+      .Case<StructDecl>([&](const StructDecl *X) {
+        for (auto &Field : X->getFields()) {
+          Members[Field.get()] = compile(Field->getType());
+        }
+      })
+      .Case<EnumDecl>([&](const EnumDecl *X) {
+        for (auto &Variant : X->getVariants()) {
+          if (Variant->hasPayload()) {
+            Members[Variant.get()] = compile(Variant->getPayloadType());
+          }
+        }
+      });
+}
+
+void TypeScheme::addTypeParams(
+    const std::vector<std::unique_ptr<TypeArgDecl>> &Args) {
+  for (auto &Arg : Args) {
+    TypeParams.push_back(Arg.get());
+  }
+}
+
+void TypeScheme::compileFunction(
+    const std::vector<std::unique_ptr<ParamDecl>> &Params, TypeRef ReturnTy,
+    const SrcSpan &Span) {
+  std::vector<TypeRef> ParamTys;
+  for (auto &Param : Params) {
+    ParamTys.push_back(Param->getType());
+    Members[Param.get()] = compile(Param->getType());
+  }
+
+  Return = compile(ReturnTy);
+  Signature = compile(TypeCtx::getFun(ParamTys, ReturnTy, Span));
+}
+
+//===----------------------------------------------------------------------===//
+// Compilation
+//===----------------------------------------------------------------------===//
+
+TypeScheme::Program TypeScheme::compile(TypeRef T) {
+  const auto Begin = static_cast<uint32_t>(Ops.size());
+  emit(T);
+  return {Begin, static_cast<uint32_t>(Ops.size()) - Begin};
+}
+
+/// Appends the postfix program for \p T and returns whether it mentions any
+/// type parameter. Subtrees that do not are collapsed into a single Fixed op.
+bool TypeScheme::emit(TypeRef T) {
+  const size_t Begin = Ops.size();
+
+  auto emitAll = [&](const std::vector<TypeRef> &Children) {
+    bool Mentions = false;
+    for (auto &Child : Children) {
+      Mentions = emit(Child) || Mentions;
+    }
+    return Mentions;
+  };
+  auto composite = [&](Op::Kind K, size_t N, bool Mentions) {
+    if (Mentions) {
+      Ops.push_back({K, static_cast<uint32_t>(N), T});
+    }
+    return Mentions;
+  };
+
+  bool Dependent =
+      llvm::TypeSwitch<Type *, bool>(T.getPtr())
+          .Case<GenericTy>([&](GenericTy *X) {
+            auto It = llvm::find(TypeParams, X->getDecl());
+            if (It == TypeParams.end()) {
+              return false;
+            }
+            auto Index = static_cast<uint32_t>(It - TypeParams.begin());
+            Ops.push_back({Op::Param, Index, T});
+            return true;
+          })
+          .Case<AppliedTy>([&](AppliedTy *X) {
+            bool Mentions = emit(X->getBase());
+            Mentions = emitAll(X->getArgs()) || Mentions;
+            return composite(Op::Applied, X->getArgs().size() + 1, Mentions);
+          })
+          .Case<TupleTy>([&](TupleTy *X) {
+            return composite(Op::Tuple, X->getElementTys().size(),
+                             emitAll(X->getElementTys()));
+          })
+          .Case<FunTy>([&](FunTy *X) {
+            bool Mentions = emitAll(X->getParamTys());
+            Mentions = emit(X->getReturnTy()) || Mentions;
+            return composite(Op::Fun, X->getParamTys().size() + 1, Mentions);
+          })
+          .Case<ArrayTy>([&](ArrayTy *X) {
+            return composite(Op::Array, 1, emit(X->getContainedTy()));
+          })
+          .Case<PtrTy>([&](PtrTy *X) {
+            return composite(Op::Ptr, 1, emit(X->getPointee()));
+          })
+          .Case<RefTy>([&](RefTy *X) {
+            return composite(Op::Ref, 1, emit(X->getPointee()));
+          })
+          .Default([](Type *) { return false; });
+
+  if (!Dependent) {
+    Ops.erase(Ops.begin() + Begin, Ops.end());
+    Ops.push_back({Op::Fixed, 0, T});
+  }
+  return Dependent;
+}
+
+//===----------------------------------------------------------------------===//
+// Instantiation
+//===----------------------------------------------------------------------===//
+
+llvm::SmallVector<TypeRef, 4>
+TypeScheme::freshArgs(llvm::ArrayRef<TypeRef> Known) const {
+  assert(Known.size() <= TypeParams.size() && "too many type arguments");
+  if (Known.size() < TypeParams.size()) {
+    ++NumInstantiations;
+  }
+
+  llvm::SmallVector<TypeRef, 4> Args(Known.begin(), Known.end());
+  for (auto *Param : llvm::drop_begin(TypeParams, Known.size())) {
+    Args.push_back(TypeCtx::getVar(VarTy::Any, Param->getSpan()));
+  }
+  return Args;
+}
+
+TypeRef TypeScheme::instantiate(const Decl &Member,
+                                llvm::ArrayRef<TypeRef> Args) const {
+  auto It = Members.find(&Member);
+  assert(It != Members.end() && "member was not compiled into this scheme");
+  return run(It->second, Args);
+}
+
+TypeRef TypeScheme::run(Program P, llvm::ArrayRef<TypeRef> Args) const {
+  assert(P.Size != 0 && "type was not compiled into this scheme");
+  assert(Args.size() == TypeParams.size() && "wrong number of type arguments");
+
+  auto Code = llvm::ArrayRef<Op>(Ops).slice(P.Begin, P.Size);
+  if (Code.size() == 1 && Code.front().K == Op::Fixed) {
+    return Code.front().T;
+  }
+  ++NumMemberInstantiations;
+
+  llvm::SmallVector<TypeRef, 8> Stack;
+  for (const Op &O : Code) {
+    if (O.K == Op::Fixed) {
+      Stack.push_back(O.T);
+      continue;
+    }
+    if (O.K == Op::Param) {
+      Stack.push_back(Args[O.N]);
+      continue;
+    }
+
+    auto Operands = llvm::ArrayRef<TypeRef>(Stack).take_back(O.N);
+    auto Span = O.T.getSpan();
+    TypeRef Res = [&] {
+      switch (O.K) {
+      case Op::Applied:
+        return TypeCtx::getApplied(Operands.front(),
+                                   Operands.drop_front().vec(), Span);
+      case Op::Tuple:
+        return TypeCtx::getTuple(Operands.vec(), Span);
+      case Op::Fun:
+        return TypeCtx::getFun(Operands.drop_back().vec(), Operands.back(),
+                               Span);
+      case Op::Array: {
+        auto Length = llvm::cast<ArrayTy>(O.T.getPtr())->getLength();
+        return TypeCtx::getArray(Operands.front(), Span, Length);
+      }
+      case Op::Ptr:
+        return TypeCtx::getPtr(Operands.front(), Span);
+      case Op::Ref:
+        return TypeCtx::getRef(Operands.front(), Span);
+      default:
+        llvm_unreachable("Fixed and Param ops are handled above");
+      }
+    }();
+
+    Stack.pop_back_n(O.N);
+    Stack.push_back(Res);
+  }
+
+  assert(Stack.size() == 1);
+  return Stack.front();
+}
+
+} // namespace phi
+
+#undef DEBUG_TYPE
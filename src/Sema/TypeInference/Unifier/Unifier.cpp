@@ -1,45 +1,230 @@
 #include "Sema/TypeInference/Unifier.hpp"
 
+#include <algorithm>
 #include <optional>
 #include <print>
 
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/Statistic.h>
 #include <llvm/ADT/TypeSwitch.h>
 #include <llvm/Support/Casting.h>
 #include <llvm/Support/ErrorHandling.h>
 
 #include "AST/TypeSystem/Type.hpp"
 
-namespace phi {
+#define DEBUG_TYPE "unifier"
 
-TypeUnifier::Node &TypeUnifier::getNode(TypeRef T) {
-  return getNode(T.getPtr());
-}
+STATISTIC(NumUnifyCalls, "Number of unify calls");
+STATISTIC(NumResolveCalls, "Number of full resolve calls");
+STATISTIC(NumZonkCacheHits, "Number of resolutions answered from the cache");
+STATISTIC(NumFindSteps, "Number of parent links followed in union-find");
+STATISTIC(MaxFindPath, "Longest union-find path followed");
+
+namespace phi {
 
-TypeUnifier::Node &TypeUnifier::getNode(Type *T) {
-  auto [It, Inserted] = Nodes.try_emplace(
-      T, Node{T, T, 1,
-              llvm::isa<VarTy>(T) ? llvm::cast<VarTy>(T)->getDomain()
-                                  : VarTy::Domain::Any});
+uint64_t TypeUnifier::getSlot(VarTy *Var) {
+  auto [It, Inserted] = SlotOf.try_emplace(Var, Slots.size());
+  if (Inserted) {
+    // A variable starts out as its own root
+    Slots.push_back({.Parent = It->second, .Var = Var});
+  }
   return It->second;
 }
 
-Type *TypeUnifier::find(TypeRef T) { return find(T.getPtr()); }
+uint64_t TypeUnifier::findRoot(uint64_t N) {
+  // Path halving: point every other node on the path at its grandparent
+  unsigned Steps = 0;
+  while (Slots[N].Parent != N) {
+    Slots[N].Parent = Slots[Slots[N].Parent].Parent;
+    N = Slots[N].Parent;
+    ++Steps;
+  }
+
+  if (Steps) {
+    NumFindSteps += Steps;
+    MaxFindPath.updateMax(Steps);
+  }
+  return N;
+}
 
 Type *TypeUnifier::find(Type *T) {
-  Node &N = Nodes.find(T)->second;
-  return N.Parent == T ? T : (N.Parent = find(N.Parent));
+  auto *Var = llvm::dyn_cast<VarTy>(T);
+  if (!Var) {
+    return T;
+  }
+
+  auto &Root = Slots[findRoot(getSlot(Var))];
+  return Root.Bound ? Root.Bound : Root.Var;
+}
+
+bool TypeUnifier::isStillValid(const ZonkEntry &Entry) const {
+  return llvm::all_of(Entry.Free, [&](uint32_t S) {
+    return Slots[S].Parent == S && !Slots[S].Bound;
+  });
+}
+
+Type *TypeUnifier::zonk(Type *T, llvm::SmallVectorImpl<uint32_t> &Free) {
+  T = find(T);
+  switch (T->getKind()) {
+  case Type::TypeKind::Var:
+    // find() stopped at an unbound root
+    Free.push_back(findRoot(getSlot(llvm::cast<VarTy>(T))));
+    return T;
+  case Type::TypeKind::Builtin:
+  case Type::TypeKind::Adt:
+  case Type::TypeKind::Generic:
+  case Type::TypeKind::Err:
+    return T;
+  default:
+    break;
+  }
+
+  if (auto It = ZonkCache.find(T); It != ZonkCache.end()) {
+    const ZonkEntry &Entry = It->second;
+    if (isStillValid(Entry)) {
+      ++NumZonkCacheHits;
+      ++NumCacheHits;
+      Free.append(Entry.Free.begin(), Entry.Free.end());
+      return Entry.Result;
+    }
+  }
+
+  // Only re-intern the type when one of its children actually changed, so
+  // resolving an already-resolved type never allocates
+  llvm::SmallVector<uint32_t, 2> OwnFree;
+  bool Changed = false;
+  auto zonkChild = [&](const TypeRef &Child) {
+    Type *Res = zonk(Child.getPtr(), OwnFree);
+    Changed = Changed || Res != Child.getPtr();
+    return TypeRef(Res, Child.getSpan());
+  };
+  auto zonkChildren = [&](const std::vector<TypeRef> &Children) {
+    llvm::SmallVector<TypeRef, 4> Res;
+    for (const auto &Child : Children) {
+      Res.push_back(zonkChild(Child));
+    }
+    return Res;
+  };
+
+  Type *Result =
+      llvm::TypeSwitch<Type *, Type *>(T)
+          .Case<AppliedTy>([&](AppliedTy *App) {
+            auto Base = zonkChild(App->getBase());
+            auto Args = zonkChildren(App->getArgs());
+            if (!Changed)
+              return T;
+            return TypeCtx::getApplied(Base, {Args.begin(), Args.end()},
+                                       Base.getSpan())
+                .getPtr();
+          })
+          .Case<FunTy>([&](FunTy *Fun) {
+            auto Params = zonkChildren(Fun->getParamTys());
+            auto Ret = zonkChild(Fun->getReturnTy());
+            if (!Changed)
+              return T;
+            return TypeCtx::getFun({Params.begin(), Params.end()}, Ret,
+                                   Ret.getSpan())
+                .getPtr();
+          })
+          .Case<TupleTy>([&](TupleTy *Tup) {
+            auto Elems = zonkChildren(Tup->getElementTys());
+            if (!Changed)
+              return T;
+            auto Span = Elems.front().getSpan();
+            return TypeCtx::getTuple({Elems.begin(), Elems.end()}, Span)
+                .getPtr();
+          })
+          .Case<ArrayTy>([&](ArrayTy *Arr) {
+            auto Contained = zonkChild(Arr->getContainedTy());
+            if (!Changed)
+              return T;
+            return TypeCtx::getArray(Contained, Contained.getSpan(),
+                                     Arr->getLength())
+                .getPtr();
+          })
+          .Case<PtrTy>([&](PtrTy *Ptr) {
+            auto Pointee = zonkChild(Ptr->getPointee());
+            if (!Changed)
+              return T;
+            return TypeCtx::getPtr(Pointee, Pointee.getSpan()).getPtr();
+          })
+          .Case<RefTy>([&](RefTy *Ref) {
+            auto Pointee = zonkChild(Ref->getPointee());
+            if (!Changed)
+              return T;
+            return TypeCtx::getRef(Pointee, Pointee.getSpan()).getPtr();
+          })
+          .Default([](Type *T) { return T; });
+
+  llvm::sort(OwnFree);
+  OwnFree.erase(std::unique(OwnFree.begin(), OwnFree.end()), OwnFree.end());
+  Free.append(OwnFree.begin(), OwnFree.end());
+
+  ZonkCache[T] = ZonkEntry{Result, OwnFree};
+  if (Result != T) {
+    ZonkCache[Result] = ZonkEntry{Result, std::move(OwnFree)};
+  }
+  return Result;
+}
+
+TypeRef TypeUnifier::resolve(TypeRef T) {
+  ++NumResolveCalls;
+  llvm::SmallVector<uint32_t, 2> Free;
+  return {zonk(T.getPtr(), Free), T.getSpan()};
+}
+
+bool TypeUnifier::occurs(uint64_t Root, Type *T) {
+  T = find(T);
+  if (auto *Var = llvm::dyn_cast<VarTy>(T)) {
+    return findRoot(getSlot(Var)) == Root;
+  }
+
+  // Ground types cannot mention any variable
+  if (auto It = ZonkCache.find(T);
+      It != ZonkCache.end() && It->second.Free.empty()) {
+    return false;
+  }
+
+  auto anyOccurs = [&](const std::vector<TypeRef> &Children) {
+    return llvm::any_of(Children, [&](const TypeRef &Child) {
+      return occurs(Root, Child.getPtr());
+    });
+  };
+
+  return llvm::TypeSwitch<Type *, bool>(T)
+      .Case<AppliedTy>([&](AppliedTy *App) {
+        return occurs(Root, App->getBase().getPtr()) ||
+               anyOccurs(App->getArgs());
+      })
+      .Case<FunTy>([&](FunTy *Fun) {
+        return occurs(Root, Fun->getReturnTy().getPtr()) ||
+               anyOccurs(Fun->getParamTys());
+      })
+      .Case<TupleTy>(
+          [&](TupleTy *Tup) { return anyOccurs(Tup->getElementTys()); })
+      .Case<ArrayTy>([&](ArrayTy *Arr) {
+        return occurs(Root, Arr->getContainedTy().getPtr());
+      })
+      .Case<PtrTy>(
+          [&](PtrTy *Ptr) { return occurs(Root, Ptr->getPointee().getPtr()); })
+      .Case<RefTy>(
+          [&](RefTy *Ref) { return occurs(Root, Ref->getPointee().getPtr()); })
+      .Default([](Type * /*T*/) { return false; });
 }
 
 bool TypeUnifier::unify(TypeRef A, TypeRef B) {
   assert(A.getPtr());
   assert(B.getPtr());
+  ++NumUnifyCalls;
 
-  // make sure both are inside the TypeUnifier context
-  getNode(A);
-  getNode(B);
+  // Only the outermost layer is resolved here; unifyConcretes recurses
+  // into the children, which resolve their own outermost layer in turn
+  A = shallow(A);
+  B = shallow(B);
 
-  A = resolve(A);
-  B = resolve(B);
+  if (A.getPtr() == B.getPtr()) {
+    return true;
+  }
 
   if (A.isErr() || B.isErr()) {
     return true;
@@ -69,40 +254,27 @@ bool TypeUnifier::unifyVars(TypeRef A, TypeRef B) {
     return false;
   }
 
-  Type *RootA = find(A);
-  Type *RootB = find(B);
-  assert(RootA && RootB);
+  uint64_t RootA = findRoot(getSlot(VarA));
+  uint64_t RootB = findRoot(getSlot(VarB));
 
   if (RootA == RootB) {
     return true;
   }
 
-  auto ItA = Nodes.find(RootA);
-  auto ItB = Nodes.find(RootB);
-  auto *RootNodeA = &ItA->second;
-  auto *RootNodeB = &ItB->second;
-
-  // RootA always has the larger size
-  if (RootNodeA->Size < RootNodeB->Size) {
+  // RootA always has the larger rank
+  if (Slots[RootA].Rank < Slots[RootB].Rank) {
     std::swap(RootA, RootB);
-    std::swap(RootNodeA, RootNodeB);
   }
 
   // RootA becomes root of all nodes under RootB
-  RootNodeA->Size += RootNodeB->Size;
-  RootNodeB->Parent = RootA;
-
-  // Make sure to update the domain
-  RootNodeA->Domain = *NewDomain;
-  RootNodeB->Domain = *NewDomain;
-
-  if (auto *RootVar = llvm::dyn_cast<VarTy>(RootA)) {
-    RootVar->setDomain(*NewDomain);
+  Slots[RootB].Parent = RootA;
+  if (Slots[RootA].Rank == Slots[RootB].Rank) {
+    ++Slots[RootA].Rank;
   }
 
-  if (auto *OtherVar = llvm::dyn_cast<VarTy>(RootB)) {
-    OtherVar->setDomain(*NewDomain);
-  }
+  // Make sure to update the domain
+  Slots[RootA].Var->setDomain(*NewDomain);
+  Slots[RootB].Var->setDomain(*NewDomain);
 
   return true;
 }
@@ -201,6 +373,10 @@ bool TypeUnifier::unifyConcretes(TypeRef A, TypeRef B) {
         auto Other = llvm::dyn_cast<ArrayTy>(B.getPtr());
         assert(Other && "Types must be same kind at this point");
 
+        // Only coerce() lets a fixed-size array meet a slice
+        if (Arr->getLength() != Other->getLength()) {
+          return false;
+        }
         return unify(Arr->getContainedTy(), Other->getContainedTy());
       })
       .Case<GenericTy>([&](const GenericTy *Generic) {
@@ -214,45 +390,50 @@ bool TypeUnifier::unifyConcretes(TypeRef A, TypeRef B) {
       });
 }
 
+bool TypeUnifier::coerce(TypeRef From, TypeRef To) {
+  From = shallow(From);
+  To = shallow(To);
+
+  // The elements of an array are converted along with it, so they may be
+  // coerced too. A slice's elements are already in memory and stay as is.
+  auto *FromArr = llvm::dyn_cast<ArrayTy>(From.getPtr());
+  auto *ToArr = llvm::dyn_cast<ArrayTy>(To.getPtr());
+  if (FromArr && ToArr && FromArr->isFixed()) {
+    if (ToArr->isFixed() && ToArr->getLength() != FromArr->getLength()) {
+      return false;
+    }
+    return coerce(FromArr->getContainedTy(), ToArr->getContainedTy());
+  }
+  return unify(From, To);
+}
+
 bool TypeUnifier::unifyVarAndConcrete(TypeRef Var, TypeRef Con) {
   assert(Var.getPtr()->isVar());
   assert(!Con.getPtr()->isVar() && !Con.getPtr()->isErr());
 
-  if (auto X = llvm::dyn_cast<VarTy>(Var.getPtr()); !X->accepts(Con)) {
-    return false;
-  }
+  auto *X = llvm::cast<VarTy>(Var.getPtr());
+  uint64_t Root = findRoot(getSlot(X));
 
-  Type *VarRoot = find(Var);
-  Type *ConRoot = find(Con);
-  assert(VarRoot && ConRoot);
-
-  if (VarRoot == ConRoot) {
-    return true;
+  // Builtins are checked against the variable's domain; anything else only
+  // has to pass the occurs check, which must look through bound variables
+  if (Con.isBuiltin() ? !X->accepts(Con) : occurs(Root, Con.getPtr())) {
+    return false;
   }
 
-  auto VarIt = Nodes.find(VarRoot);
-  auto ConIt = Nodes.find(ConRoot);
-  auto &VarRootNode = VarIt->second;
-  auto &ConRootNode = ConIt->second;
-
-  // RootA becomes root of all nodes under RootB
-  ConRootNode.Size += VarRootNode.Size;
-  VarRootNode.Parent = ConRoot;
+  // `Var` is already resolved, so its root is still unbound
+  assert(!Slots[Root].Bound);
+  Slots[Root].Bound = Con.getPtr();
 
-  // Make sure to update the domain
-  ConRootNode.Domain = std::nullopt;
   return true;
 }
 
 void TypeUnifier::emit() const {
-  for (auto N : Nodes) {
-    if (!N.getSecond().TheType->isVar()) {
-      continue;
-    }
-
-    std::println("Type: {} Parent: {}", N.getSecond().TheType->toString(),
-                 N.getSecond().Parent->toString());
+  for (const auto &S : Slots) {
+    std::println("Type: {} Parent: {}", S.Var->toString(),
+                 Slots[S.Parent].Var->toString());
   }
 }
 
 } // namespace phi
+
+#undef DEBUG_TYPE
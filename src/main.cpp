@@ -25,9 +25,17 @@ COMMANDS:
 COMPILE OPTIONS:
     -o <path>                Output path
     --release                Optimized build
+    --check-all              Type check items unreachable from main too
+    --stats[=json]           Print compiler statistics as text or JSON
+    --mono-report            List each generic instance and its methods
+    --layout-report          List the size and padding of each struct and enum
 
 BUILD/RUN OPTIONS:
     --release                Build in release mode
+    --check-all              Type check items unreachable from main too
+    --stats[=json]           Print compiler statistics as text or JSON
+    --mono-report            List each generic instance and its methods
+    --layout-report          List the size and padding of each struct and enum
     --args <args...>         Arguments to pass to program (run only)
 
 EXAMPLES:
@@ -71,7 +79,9 @@ int main(int argc, char *argv[]) {
   if (Command == "compile") {
     if (argc < 3) {
       llvm::errs() << "Error: Missing source file\n";
-      llvm::errs() << "Usage: phi compile <file> [-o output] [--release]\n";
+      llvm::errs() << "Usage: phi compile <file> [-o output] [--release] "
+                    "[--check-all] [--stats[=json]] [--mono-report] "
+                    "[--layout-report]\n";
       return 1;
     }
 
@@ -88,6 +98,16 @@ int main(int argc, char *argv[]) {
         Opts.IsRelease = true;
       } else if (Arg == "-v" || Arg == "--verbose") {
         Opts.Verbose = true;
+      } else if (Arg == "--check-all") {
+        Opts.CheckAll = true;
+      } else if (Arg == "--stats") {
+        Opts.Stats = StatsFormat::Text;
+      } else if (Arg == "--stats=json") {
+        Opts.Stats = StatsFormat::Json;
+      } else if (Arg == "--mono-report") {
+        Opts.MonoReport = true;
+      } else if (Arg == "--layout-report") {
+        Opts.LayoutReport = true;
       } else {
         llvm::errs() << "Error: Unknown option: " << Arg << "\n";
         return 1;
@@ -110,6 +130,16 @@ int main(int argc, char *argv[]) {
         Opts.IsRelease = true;
       } else if (Arg == "-v" || Arg == "--verbose") {
         Opts.Verbose = true;
+      } else if (Arg == "--check-all") {
+        Opts.CheckAll = true;
+      } else if (Arg == "--stats") {
+        Opts.Stats = StatsFormat::Text;
+      } else if (Arg == "--stats=json") {
+        Opts.Stats = StatsFormat::Json;
+      } else if (Arg == "--mono-report") {
+        Opts.MonoReport = true;
+      } else if (Arg == "--layout-report") {
+        Opts.LayoutReport = true;
       } else {
         llvm::errs() << "Error: Unknown option: " << Arg << "\n";
         return 1;
@@ -135,6 +165,16 @@ int main(int argc, char *argv[]) {
         Opts.IsRelease = true;
       } else if (Arg == "-v" || Arg == "--verbose") {
         Opts.Verbose = true;
+      } else if (Arg == "--check-all") {
+        Opts.CheckAll = true;
+      } else if (Arg == "--stats") {
+        Opts.Stats = StatsFormat::Text;
+      } else if (Arg == "--stats=json") {
+        Opts.Stats = StatsFormat::Json;
+      } else if (Arg == "--mono-report") {
+        Opts.MonoReport = true;
+      } else if (Arg == "--layout-report") {
+        Opts.LayoutReport = true;
       } else if (CollectingArgs) {
         RunArgs.push_back(Arg);
       } else {
@@ -7,8 +7,11 @@
 #include "Parser/Parser.hpp"
 #include "Sema/Sema.hpp"
 
+#include <llvm/ADT/Statistic.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Timer.h>
 
 #include <memory>
 #include <string>
@@ -28,7 +31,7 @@ struct PipelineResult {
 };
 
 // Helper: run full frontend (lex → parse → sema), return result
-static PipelineResult frontend(const std::string &Src) {
+static PipelineResult frontend(const std::string &Src, bool CheckAll = false) {
   PipelineResult R;
   R.Diags.getSrcManager().addSrcFile("test.phi", Src);
 
@@ -43,7 +46,7 @@ static PipelineResult frontend(const std::string &Src) {
     return R;
 
   std::vector<ModuleDecl *> Mods = {R.Mod.get()};
-  Sema S(Mods, &R.Diags);
+  Sema S(Mods, &R.Diags, CheckAll);
   S.analyze();
   return R;
 }
@@ -73,6 +76,24 @@ static bool fullPipeline(const std::string &Src) {
   return true;
 }
 
+// Helper: full pipeline, returning the printed IR (empty on failure)
+static std::string lowerToIR(const std::string &Src) {
+  auto R = frontend(Src);
+  if (!R.Mod || R.Diags.hasError())
+    return "";
+
+  std::vector<ModuleDecl *> Mods = {R.Mod.get()};
+  CodeGen CG(Mods, "test");
+  CG.generate();
+  if (llvm::verifyModule(CG.getModule(), &llvm::errs()))
+    return "";
+
+  std::string IR;
+  llvm::raw_string_ostream OS(IR);
+  CG.getModule().print(OS, nullptr);
+  return IR;
+}
+
 //===----------------------------------------------------------------------===//
 // Simple Programs (full pipeline with codegen)
 //===----------------------------------------------------------------------===//
@@ -168,6 +189,51 @@ TEST(Integration, BreakInLoop) {
   )"));
 }
 
+TEST(Integration, DeferRunsOnEveryExit) {
+  auto IR = lowerToIR(R"(
+    fun mark(const n: i32) {}
+
+    fun f(const n: i32) -> i32 {
+      defer mark(1);
+      var i = 0;
+      while i < 3 {
+        defer mark(2);
+        if i == n {
+          return i;
+        }
+        i = i + 1;
+        if i == 1 {
+          continue;
+        }
+        mark(3);
+      }
+      return 0;
+    }
+
+    fun main() -> i32 {
+      return f(1);
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+
+  // Innermost first on return, only the loop body's on continue, and after
+  // the body's own statements when it falls through
+  EXPECT_NE(IR.find("  call fastcc void @mark(i32 2) #2\n"
+                    "  call fastcc void @mark(i32 1) #2\n"
+                    "  ret i32 %i"),
+            std::string::npos);
+  EXPECT_NE(IR.find("  call fastcc void @mark(i32 2) #2\n"
+                    "  br label %while.cond"),
+            std::string::npos);
+  EXPECT_NE(IR.find("  call fastcc void @mark(i32 3) #2\n"
+                    "  call fastcc void @mark(i32 2) #2\n"
+                    "  br label %while.cond"),
+            std::string::npos);
+  EXPECT_NE(IR.find("  call fastcc void @mark(i32 1) #2\n"
+                    "  ret i32 0"),
+            std::string::npos);
+}
+
 //===----------------------------------------------------------------------===//
 // Functions
 //===----------------------------------------------------------------------===//
@@ -328,6 +394,470 @@ TEST(Integration, EnumMethod) {
   )"));
 }
 
+TEST(Integration, MatchOrPatternWithBinding) {
+  EXPECT_TRUE(fullPipeline(R"(
+    enum Event {
+      Key: i32,
+      Click: i32,
+      Quit
+    }
+
+    fun code(const e: Event) -> i32 {
+      return match e {
+        .Key(c) => c,
+        .Click(c) | .Quit => 0,
+      };
+    }
+
+    fun main() -> i32 {
+      const e = Event { Click : 3 };
+      return code(e);
+    }
+  )"));
+}
+
+TEST(Integration, MatchWildcardBeforeLaterArms) {
+  EXPECT_TRUE(fullPipeline(R"(
+    fun classify(const n: i32) -> i32 {
+      return match n {
+        0 | 1 => 10,
+        1 => 20,
+        _ => 30,
+        2 => 40,
+      };
+    }
+
+    fun main() -> i32 {
+      return classify(2);
+    }
+  )"));
+}
+
+TEST(Integration, MatchFloatLiterals) {
+  EXPECT_TRUE(fullPipeline(R"(
+    fun half(const x: f64) -> bool {
+      return match x {
+        0.5 => true,
+        _ => false,
+      };
+    }
+
+    fun main() -> bool {
+      return half(0.5);
+    }
+  )"));
+}
+
+TEST(Integration, MatchTestsDiscriminantOnce) {
+  auto IR = lowerToIR(R"(
+    enum Op { Add: i32, Sub: i32, Neg, Halt }
+
+    fun step(const o: Op) -> i32 {
+      return match o {
+        .Add(v) => v,
+        .Sub(v) => 0 - v,
+        .Neg | .Halt => 1,
+      };
+    }
+
+    fun main() -> i32 {
+      return step(Op { Add : 1 });
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+
+  // One switch on one load, with a case per variant and no compare chain
+  auto Count = [&](const std::string &Needle) {
+    size_t N = 0;
+    for (size_t Pos = IR.find(Needle); Pos != std::string::npos;
+         Pos = IR.find(Needle, Pos + 1)) {
+      ++N;
+    }
+    return N;
+  };
+  EXPECT_EQ(Count("%match.disc = load"), 1u);
+  EXPECT_EQ(Count("switch i8 %match.disc"), 1u);
+  EXPECT_EQ(Count("icmp eq i8 %match.disc"), 0u);
+  EXPECT_EQ(Count("i8 3, label"), 1u);
+}
+
+TEST(Integration, EnumTagIsNarrowAndPayloadAligned) {
+  auto IR = lowerToIR(R"(
+    enum Shape { Circle: f64, Square: i32, Dot }
+
+    fun area(const s: Shape) -> i32 {
+      return match s {
+        .Square(w) => w * w,
+        .Circle(r) => 3,
+        .Dot => 0,
+      };
+    }
+
+    fun main() -> i32 {
+      return area(Shape { Square : 5 });
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+  EXPECT_NE(IR.find("%Shape = type { i8, [1 x i64] }"), std::string::npos);
+  EXPECT_NE(IR.find("switch i8 %match.disc"), std::string::npos);
+}
+
+TEST(Integration, EnumDiscriminantInNiche) {
+  auto IR = lowerToIR(R"(
+    enum Option<T> {
+      Some: T,
+      None
+    }
+
+    fun read(const r: &i32) -> i32 {
+      return 1;
+    }
+
+    fun get(const o: Option<&i32>) -> i32 {
+      return match o {
+        .Some(r) => read(r),
+        .None => 0,
+      };
+    }
+
+    fun inner(const o: Option<bool>) -> i32 {
+      return 1;
+    }
+
+    fun flag(const o: Option<Option<bool>>) -> i32 {
+      return match o {
+        .Some(b) => inner(b),
+        .None => 0,
+      };
+    }
+
+    fun main() -> i32 {
+      var x = 3;
+      const a = Option::<&i32> { Some : &x };
+      const b = Option::<Option<bool>> { None };
+      return get(a) + flag(b);
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+
+  // A reference option is a pointer, and matching it is one null check
+  EXPECT_NE(IR.find("%Option__ptr = type { ptr }"), std::string::npos);
+  EXPECT_NE(IR.find("icmp eq ptr %match.niche, null"), std::string::npos);
+  EXPECT_EQ(IR.find("%match.disc"), std::string::npos);
+
+  // The inner option keeps `None` in the bool's byte, the outer one in the
+  // next unused value
+  EXPECT_NE(IR.find("%Option_bool = type { i8 }"), std::string::npos);
+  EXPECT_NE(IR.find("%Option_Option_bool_ = type { %Option_bool }"),
+            std::string::npos);
+  EXPECT_NE(IR.find("store i8 3, ptr %niche"), std::string::npos);
+}
+
+TEST(Integration, StructFieldsOrderedByAlignment) {
+  auto IR = lowerToIR(R"(
+    struct Wasteful { public a: u8, public b: f64, public c: u8, public d: i64 }
+
+    #[repr(C)]
+    struct Wire { public a: u8, public b: f64, public c: u8, public d: i64 }
+
+    fun pick(const d: i64) -> i64 {
+      const w = Wasteful { a: 1, b: 2.0, c: 3, d: d };
+      const x = Wire { a: 1, b: 2.0, c: 3, d: d };
+      return w.d + x.d;
+    }
+
+    fun main() -> i64 { return pick(4); }
+  )");
+  ASSERT_FALSE(IR.empty());
+  EXPECT_NE(IR.find("%Wasteful = type { double, i64, i8, i8 }"),
+            std::string::npos);
+  EXPECT_NE(IR.find("%Wire = type { i8, double, i8, i64 }"),
+            std::string::npos);
+  EXPECT_NE(IR.find("getelementptr inbounds %Wasteful, ptr %w, i32 0, i32 1"),
+            std::string::npos);
+}
+
+TEST(Integration, FixedSizeArrays) {
+  auto IR = lowerToIR(R"(
+    struct Vec3 { public v: [f64; 3] }
+
+    fun sum(const xs: [i64]) -> i64 {
+      return xs[0] + xs[1];
+    }
+
+    fun make() -> [i64; 2] {
+      return [4, 5];
+    }
+
+    fun main() -> i64 {
+      var a = [1, 2, 3];
+      a[1] = 10;
+      const p = Vec3 { v: [1.0, 2.0, 3.0] };
+      return sum(a) + make()[1];
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+  // Fixed-size arrays are stored inline and indexed in place
+  EXPECT_NE(IR.find("%Vec3 = type { [3 x double] }"), std::string::npos);
+  EXPECT_NE(IR.find("define internal fastcc [2 x i64] @make()"),
+            std::string::npos);
+  EXPECT_NE(IR.find("%a = alloca [3 x i64]"), std::string::npos);
+  EXPECT_NE(IR.find("getelementptr inbounds [3 x i64], ptr %a, i64 0, i64 1"),
+            std::string::npos);
+  // Passing one where a slice is expected borrows it with its length
+  EXPECT_NE(IR.find("insertvalue { ptr, i64 } %"), std::string::npos);
+  EXPECT_NE(IR.find("i64 3, 1"), std::string::npos);
+}
+
+TEST(Integration, SliceAsArrayIsRejected) {
+  // An array becomes a slice where one is expected, never the other way
+  EXPECT_FALSE(frontendOk(R"(
+    fun last(const a: [i32; 4]) -> i32 { return a[3]; }
+
+    fun take(const xs: [i32]) -> i32 { return last(xs); }
+
+    fun main() -> i32 { return take([1, 2]); }
+  )"));
+}
+
+TEST(Integration, ConstantAggregatesAsGlobals) {
+  auto IR = lowerToIR(R"(
+    struct Coeffs { public a: f64, public b: f64, public c: f64 }
+
+    fun factorial(const i: u64) -> i64 {
+      const table = [1, 1, 2, 6, 24, 120];
+      return table[i];
+    }
+
+    fun main() -> i64 {
+      var scratch = [1, 1, 2, 6, 24, 120];
+      scratch[0] = 7;
+      const k = Coeffs { a: 1.0, b: 2.0, c: 3.0 };
+      const pair = (1, 2);
+      return factorial(3) + scratch[0] + (k.c as i64) + pair.1;
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+  // Both literals share one read-only table
+  EXPECT_NE(IR.find("@const = private unnamed_addr constant [6 x i64] "
+                    "[i64 1, i64 1, i64 2, i64 6, i64 24, i64 120]"),
+            std::string::npos)
+      << IR;
+  EXPECT_EQ(IR.find("@const.1 = private unnamed_addr constant [6 x i64]"),
+            std::string::npos);
+  // A table that is only read is indexed in place
+  EXPECT_NE(IR.find("getelementptr inbounds [6 x i64], ptr @const, i64 0"),
+            std::string::npos);
+  EXPECT_EQ(IR.find("%table = alloca"), std::string::npos);
+  // One that is written starts as a copy
+  EXPECT_NE(IR.find("@llvm.memcpy.p0.p0.i64(ptr align 8 %scratch, "
+                    "ptr align 8 @const, i64 48"),
+            std::string::npos);
+  // Struct literals of constants are constants too
+  EXPECT_NE(IR.find("private unnamed_addr constant %Coeffs { double"),
+            std::string::npos);
+  EXPECT_NE(IR.find("store { i32, i64 } { i32 1, i64 2 }, ptr %pair"),
+            std::string::npos);
+}
+
+TEST(Integration, PackedAndAlignedStructs) {
+  auto IR = lowerToIR(R"(
+    #[packed]
+    struct Wire { public tag: u8, public len: i64 }
+
+    #[packed]
+    struct Frame { public tag: u8, public data: [i32; 6] }
+
+    #[align(64)]
+    struct Line { public hits: i32 }
+
+    #[repr(C)]
+    struct Outer { public a: u8, public l: Line, public b: u8 }
+
+    enum Slot { Held: Line, Empty }
+
+    fun touch(const len: i64, const hits: i32) -> i64 {
+      var w = Wire { tag: 1, len: len };
+      w.len = w.len + 1;
+      const l = Line { hits: hits };
+      var f = Frame { tag: 1, data: [1, 2, 3, 4, 5, 6] };
+      f.data = [4, 5, 6, 7, 8, 9];
+      const o = Outer { a: 1, l: l, b: 2 };
+      const s = Slot { Held : l };
+      return w.len;
+    }
+
+    fun main() -> i64 { return touch(40, 1); }
+  )");
+  ASSERT_FALSE(IR.empty());
+  // Packed fields may sit at any offset, so every access is unaligned
+  EXPECT_NE(IR.find("%Wire = type <{ i8, i64 }>"), std::string::npos);
+  EXPECT_NE(IR.find("store i64 %len3, ptr %1, align 1"), std::string::npos);
+  EXPECT_NE(IR.find("store i64 %add, ptr %5, align 1"), std::string::npos);
+  // An over-aligned struct is padded to a multiple of its alignment
+  EXPECT_NE(IR.find("%Line = type { i32, [60 x i8] }"), std::string::npos);
+  EXPECT_NE(IR.find("%l = alloca %Line, align 64"), std::string::npos);
+  // A copied table lands unaligned in a packed field too
+  EXPECT_NE(IR.find("@llvm.memcpy.p0.p0.i64(ptr align 1 %8, "
+                    "ptr align 4 @const.1, i64 24"),
+            std::string::npos);
+  // A nested over-aligned struct or payload is padded to its alignment
+  EXPECT_NE(IR.find("%Outer = type { i8, [63 x i8], %Line, i8, [63 x i8] }"),
+            std::string::npos);
+  EXPECT_NE(IR.find("%Slot = type { i8, [63 x i8], [4 x i128] }"),
+            std::string::npos);
+  EXPECT_NE(IR.find("%s = alloca %Slot, align 64"), std::string::npos);
+}
+
+TEST(Integration, LargeAggregatesPassedIndirectly) {
+  auto IR = lowerToIR(R"(
+    struct V3 {
+      public x: i64, public y: i64, public z: i64,
+
+      fun add(const this, const o: V3) -> V3 {
+        return V3 { x: this.x + o.x, y: this.y + o.y, z: this.z + o.z };
+      }
+    }
+
+    struct Pair { public a: i64, public b: i64 }
+
+    fun bump(var v: V3) -> i64 {
+      v.x = v.x + 1;
+      return v.x;
+    }
+
+    fun norm(const v: V3) -> i64 { return v.x * v.x + v.y * v.y; }
+
+    fun swap(const p: Pair) -> Pair { return Pair { a: p.b, b: p.a }; }
+
+    fun main() -> i64 {
+      const p = V3 { x: 1, y: 2, z: 3 };
+      const q = p.add(p);
+      return bump(q) + norm(q) + swap(Pair { a: 1, b: 2 }).a;
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+  // Over 16 bytes is returned through the caller's memory
+  EXPECT_NE(IR.find("define internal fastcc void @V3_add(ptr noalias "
+                    "nocapture writeonly sret(%V3) align 8 %agg.result, "
+                    "ptr nocapture nonnull readonly align 8 "
+                    "dereferenceable(24) %this, ptr noalias nocapture "
+                    "readonly align 8 dereferenceable(24) %o)"),
+            std::string::npos)
+      << IR;
+  EXPECT_NE(IR.find("define internal fastcc i64 @bump(ptr nocapture "
+                    "byval(%V3) align 8 %v)"),
+            std::string::npos);
+  EXPECT_NE(IR.find("define internal fastcc i64 @norm(ptr noalias nocapture "
+                    "readonly align 8 dereferenceable(24) %v)"),
+            std::string::npos);
+  // A local that is never written is passed where it lives
+  EXPECT_NE(IR.find("call fastcc i64 @bump(ptr byval(%V3) align 8 %q)"),
+            std::string::npos);
+  EXPECT_NE(IR.find("call fastcc i64 @norm(ptr noalias nocapture readonly "
+                    "align 8 dereferenceable(24) %q)"),
+            std::string::npos);
+  // Two eightbytes still travel as a value
+  EXPECT_NE(IR.find("define internal fastcc %Pair @swap(%Pair %p)"),
+            std::string::npos);
+}
+
+TEST(Integration, LinkageAndAttributes) {
+  auto IR = lowerToIR(R"(
+    public struct Counter {
+      public n: i64,
+
+      public fun get(const this) -> i64 { return this.n; }
+      fun reset(var this) { this.n = 0; }
+    }
+
+    fun helper(const x: i64) -> i64 { return x + 1; }
+    public fun api(const x: i64) -> i64 { return helper(x); }
+
+    fun main() -> i64 {
+      var c = Counter { n: 3 };
+      const n = c.get();
+      c.reset();
+      return api(n);
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+  // Only public items and the entry point keep external linkage
+  EXPECT_NE(IR.find("define i64 @api(i64 %x)"), std::string::npos) << IR;
+  EXPECT_NE(IR.find("define i64 @Counter_get(ptr "), std::string::npos);
+  EXPECT_NE(IR.find("define internal fastcc i64 @helper(i64 %x)"),
+            std::string::npos);
+  EXPECT_NE(IR.find("define internal fastcc void @Counter_reset(ptr "),
+            std::string::npos);
+  EXPECT_NE(IR.find("call fastcc i64 @helper("), std::string::npos);
+  EXPECT_NE(IR.find("define i64 @main()"), std::string::npos);
+  // References are never null, and a const one that is only read is
+  // readonly
+  EXPECT_NE(IR.find("@Counter_get(ptr nocapture nonnull readonly align 8 "
+                    "dereferenceable(8) %this)"),
+            std::string::npos);
+  EXPECT_NE(IR.find("@Counter_reset(ptr nonnull align 8 "
+                    "dereferenceable(8) %this)"),
+            std::string::npos);
+  EXPECT_NE(IR.find("nounwind"), std::string::npos);
+}
+
+TEST(Integration, LayoutReport) {
+  auto R = frontend(R"(
+    struct Wasteful { public a: u8, public b: f64, public c: u8, public d: i64 }
+
+    enum Shape { Circle: f64, Dot }
+
+    fun main() {
+      const w = Wasteful { a: 1, b: 2.0, c: 3, d: 4 };
+      const s = Shape { Dot };
+    }
+  )");
+  ASSERT_TRUE(R.Mod && !R.Diags.hasError());
+
+  std::vector<ModuleDecl *> Mods = {R.Mod.get()};
+  CodeGen CG(Mods, "test");
+  CG.generate();
+
+  std::string Report;
+  llvm::raw_string_ostream OS(Report);
+  CG.printLayoutReport(OS);
+  EXPECT_NE(
+      Report.find("Wasteful: size 24, align 8, padding 6 (fields b, d, a, c)"),
+      std::string::npos)
+      << Report;
+  EXPECT_NE(Report.find("Shape: size 16, align 8, padding 7"),
+            std::string::npos)
+      << Report;
+}
+
+TEST(Integration, MatchStringLiterals) {
+  auto IR = lowerToIR(R"(
+    fun opcode(const cmd: string) -> i32 {
+      return match cmd {
+        "get" => 1,
+        "put" => 2,
+        "pop" => 3,
+        "delete" | "del" => 4,
+        "" => 5,
+        "get" => 6,
+        _ => 0,
+      };
+    }
+
+    fun main() -> i32 {
+      return opcode("put");
+    }
+  )");
+  ASSERT_FALSE(IR.empty());
+
+  // Switch on the length, then on the bytes that tell same-length keys apart
+  EXPECT_NE(IR.find("switch i64 %match.len"), std::string::npos) << IR;
+  EXPECT_NE(IR.find("i64 3, label"), std::string::npos) << IR;
+  EXPECT_NE(IR.find("call i32 @memcmp"), std::string::npos) << IR;
+  EXPECT_EQ(IR.find("icmp eq ptr"), std::string::npos) << IR;
+}
+
 //===----------------------------------------------------------------------===//
 // Tuples
 //===----------------------------------------------------------------------===//
@@ -863,3 +1393,97 @@ TEST(Integration, CastBoolToFloatDisallowed) {
     }
   )"));
 }
+
+//===----------------------------------------------------------------------===//
+// Reachability
+//===----------------------------------------------------------------------===//
+
+static const std::string UnusedHelpers = R"(
+  struct Unused {
+    x: i32,
+
+    fun get(const this) -> i32 { return helper(); }
+  }
+
+  fun helper() -> i32 { return true; }
+
+  fun main() {}
+)";
+
+TEST(Integration, UnreachableBodySkipped) {
+  auto R = frontend(UnusedHelpers);
+  ASSERT_TRUE(R.Mod && !R.Diags.hasError());
+
+  for (auto &Item : R.Mod->getItems()) {
+    EXPECT_EQ(Item->isReachable(), Item->getId() == "main") << Item->getId();
+  }
+
+  std::vector<ModuleDecl *> Mods = {R.Mod.get()};
+  CodeGen CG(Mods, "test");
+  CG.generate();
+  EXPECT_NE(CG.getModule().getFunction("main"), nullptr);
+  EXPECT_EQ(CG.getModule().getFunction("helper"), nullptr);
+}
+
+TEST(Integration, UnreachableBodyCheckedWithCheckAll) {
+  auto R = frontend(UnusedHelpers, /*CheckAll=*/true);
+  EXPECT_TRUE(R.Diags.hasError());
+}
+
+TEST(Integration, ReachableThroughAdtMethod) {
+  EXPECT_FALSE(frontendOk(R"(
+    struct Counter {
+      n: i32,
+
+      fun get(const this) -> i32 { return helper(); }
+    }
+
+    fun helper() -> i32 { return true; }
+
+    fun main() {
+      const c = Counter { n: 1 };
+    }
+  )"));
+}
+
+//===----------------------------------------------------------------------===//
+// Statistics
+//===----------------------------------------------------------------------===//
+
+// Prints the report `--stats=json` prints and exits with 0 if it parses and
+// carries the front-end counters
+[[noreturn]] static void checkStatsJson() {
+  llvm::EnableStatistics(/*DoPrintOnExit=*/false);
+  bool Ok = frontendOk(R"(
+    fun main() { const x = 1; const y = x; }
+  )");
+
+  std::string Report;
+  llvm::raw_string_ostream OS(Report);
+  llvm::PrintStatisticsJSON(OS);
+  llvm::TimerGroup::clearAll();
+  llvm::errs() << Report;
+
+  auto Json = llvm::json::parse(Report);
+  if (!Json) {
+    llvm::errs() << llvm::toString(Json.takeError()) << "\n";
+    std::exit(1);
+  }
+#if LLVM_ENABLE_STATS
+  if (auto *Stats = Json->getAsObject()) {
+    auto Lookups = Stats->getInteger("symtab.NumLookups");
+    auto Bodies = Stats->getInteger("infer.NumBodies");
+    Ok = Ok && Lookups && *Lookups > 0 && Bodies && *Bodies == 1;
+  } else {
+    Ok = false;
+  }
+#endif
+  std::exit(Ok ? 0 : 1);
+}
+
+TEST(Integration, StatsJsonReport) {
+  // A counter only registers if statistics are already enabled the first
+  // time it is bumped, so the report has to come from a fresh process
+  GTEST_FLAG_SET(death_test_style, "threadsafe");
+  EXPECT_EXIT(checkStatsJson(), testing::ExitedWithCode(0), "");
+}
@@ -8,6 +8,7 @@
 
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Support/Parallel.h>
 #include <llvm/Support/raw_ostream.h>
 
 #include <memory>
@@ -134,6 +135,22 @@ TEST(Monomorphization, StructMethod) {
   EXPECT_TRUE(hasFunction(M, "Box_f64_get"));
 }
 
+TEST(Monomorphization, TypeArgsInDeclarationOrder) {
+  auto CG = compile(R"(
+    fun second<A, B, C>(const a: A, const b: B, const c: C) -> B {
+      return b;
+    }
+
+    fun main() {
+      second(1, true, 2.0);
+    }
+  )");
+  ASSERT_TRUE(CG);
+  auto &M = CG->getModule();
+
+  EXPECT_TRUE(hasFunction(M, "second_i32_bool_f64"));
+}
+
 TEST(Monomorphization, NestedGenerics) {
   auto CG = compile(R"(
     struct Wrapper<T> {
@@ -174,3 +191,211 @@ TEST(Monomorphization, UnusedInstantiations) {
   // Also should not have generic version
   EXPECT_FALSE(hasFunction(M, "unused"));
 }
+
+TEST(Monomorphization, RecordedDuringFinalization) {
+  const std::string Src = R"(
+    struct Wrapper<T> {
+      public val: T
+    }
+
+    fun foo<T>(const x: T) -> T {
+      return x;
+    }
+
+    fun main() {
+      foo(1);
+      foo(2);
+      foo(3.0);
+      const w = Wrapper::<i32> { val: 10 };
+    }
+  )";
+  DiagnosticManager Diags(DiagnosticConfig{.UseColors = false});
+  Diags.getSrcManager().addSrcFile("test.phi", Src);
+  auto Tokens = Lexer(Src, "test.phi", &Diags).scan();
+  auto Mod = Parser(Tokens, &Diags).parse();
+  ASSERT_TRUE(Mod && !Diags.hasError());
+
+  std::vector<ModuleDecl *> Mods = {Mod.get()};
+  ASSERT_TRUE(Sema(Mods, &Diags).analyze());
+
+  // foo<i32> is used twice but recorded once, in order of first use
+  std::vector<std::string> Recorded;
+  for (const auto &TI : Mod->getInstantiations()) {
+    std::string Name = TI.GenericDecl->getId();
+    for (const auto &Arg : TI.TypeArgs) {
+      Name += "_" + Arg.toString();
+    }
+    Recorded.push_back(Name);
+  }
+  EXPECT_EQ(Recorded, (std::vector<std::string>{"foo_i32", "foo_f64",
+                                                "Wrapper_i32"}));
+}
+
+TEST(Monomorphization, OnlyCalledMethods) {
+  auto CG = compile(R"(
+    struct Box<T> {
+      public val: T,
+      fun get(const this) -> T { return this.val; }
+      fun peek(const this) -> T { return this.get(); }
+      fun unused(const this) -> T { return this.val; }
+    }
+
+    fun main() {
+      const a = Box::<i32> { val: 1 };
+      a.peek();
+      const b = Box::<f64> { val: 1.0 };
+      b.get();
+    }
+  )");
+  ASSERT_TRUE(CG);
+  auto &M = CG->getModule();
+
+  // get<i32> is only called from inside peek<i32>
+  EXPECT_TRUE(hasFunction(M, "Box_i32_peek"));
+  EXPECT_TRUE(hasFunction(M, "Box_i32_get"));
+  EXPECT_TRUE(hasFunction(M, "Box_f64_get"));
+  EXPECT_FALSE(hasFunction(M, "Box_f64_peek"));
+  EXPECT_FALSE(hasFunction(M, "Box_i32_unused"));
+  EXPECT_FALSE(hasFunction(M, "Box_f64_unused"));
+
+  std::string Report;
+  llvm::raw_string_ostream OS(Report);
+  CG->printMonomorphizationReport(OS);
+  EXPECT_NE(Report.find("Box_i32: 2 of 3 methods (peek, get)"),
+            std::string::npos)
+      << Report;
+  EXPECT_NE(Report.find("Box_f64: 1 of 3 methods (get)"), std::string::npos)
+      << Report;
+}
+
+TEST(Monomorphization, ParallelBodiesAreDeterministic) {
+  // `peek` instantiates `get` for its own type argument, so bodies take two
+  // rounds
+  const std::string Src = R"(
+    struct Cell<T> {
+      public v: T,
+
+      fun get(const this) -> T {
+        return this.v;
+      }
+    }
+
+    fun id<T>(const x: T) -> T {
+      return x;
+    }
+
+    fun peek<T>(const x: T) -> T {
+      const c = Cell::<T> { v: x };
+      return c.get();
+    }
+
+    fun main() {
+      id(true);
+      id(1.0);
+      peek(2.0);
+      peek(3);
+      id(1);
+      id(false);
+    }
+  )";
+  auto print = [](CodeGen &CG) {
+    std::string IR;
+    llvm::raw_string_ostream OS(IR);
+    CG.getModule().print(OS, nullptr);
+    return IR;
+  };
+
+  // One thread lowers every chunk in turn on the calling thread
+  auto Saved = llvm::parallel::strategy;
+  llvm::parallel::strategy = llvm::hardware_concurrency(1);
+  auto Serial = compile(Src);
+  llvm::parallel::strategy = Saved;
+  ASSERT_TRUE(Serial);
+
+  // Instances are defined in the order the program first uses them, and the
+  // methods found while lowering them come after `main`
+  std::vector<std::string> Defined;
+  for (const auto &Fn : Serial->getModule()) {
+    if (!Fn.isDeclaration() && Fn.getName() != "main") {
+      Defined.push_back(Fn.getName().str());
+    }
+  }
+  EXPECT_EQ(Defined, (std::vector<std::string>{
+                         "id_bool", "id_f64", "peek_f64", "peek_i32", "id_i32",
+                         "Cell_f64_get", "Cell_i32_get"}));
+
+  // The methods are declared for the instance their caller was lowered for
+  auto *Get = Serial->getModule().getFunction("Cell_i32_get");
+  ASSERT_TRUE(Get);
+  EXPECT_EQ(Get->getParamDereferenceableBytes(0), 4u);
+
+  // Workers on other threads link back to the same module, every time
+  std::string Expected = print(*Serial);
+  for (int I = 0; I < 4; ++I) {
+    auto Parallel = compile(Src);
+    ASSERT_TRUE(Parallel);
+    EXPECT_EQ(print(*Parallel), Expected);
+  }
+}
+
+TEST(Monomorphization, MergesLayoutIdenticalInstances) {
+  auto CG = compile(R"(
+    struct Cell<T> {
+      public v: T,
+      fun get(const this) -> T { return this.v; }
+    }
+
+    struct A { public x: i32 }
+    struct B { public y: f64 }
+
+    fun id<T>(const x: T) -> T {
+      return x;
+    }
+
+    fun keep<T>(const c: Cell<T>) -> Cell<T> {
+      return c;
+    }
+
+    fun main() {
+      var a = A { x: 1 };
+      var b = B { y: 1.0 };
+      const ra: &A = &a;
+      const rb: &B = &b;
+      id(ra);
+      id(rb);
+      const p = Cell::<&A> { v: ra };
+      p.get();
+      const q = Cell::<&B> { v: rb };
+      q.get();
+
+      const n: u32 = 1;
+      id(1);
+      id(n);
+      keep(Cell::<i32> { v: 1 });
+      keep(Cell::<u32> { v: n });
+      id(1.0);
+    }
+  )");
+  ASSERT_TRUE(CG);
+  auto &M = CG->getModule();
+
+  // Every reference lowers to a pointer, so `&A` and `&B` make one instance
+  EXPECT_TRUE(hasFunction(M, "id__ptr"));
+  EXPECT_TRUE(hasFunction(M, "Cell__ptr_get"));
+  EXPECT_TRUE(llvm::StructType::getTypeByName(M.getContext(), "Cell__ptr"));
+  std::string Report;
+  llvm::raw_string_ostream OS(Report);
+  CG->printMonomorphizationReport(OS);
+  EXPECT_EQ(Report.find("_A"), std::string::npos);
+  EXPECT_EQ(Report.find("_B"), std::string::npos);
+
+  // i32 and u32 are different instances that lower to the same code, which
+  // is merged after the fact, even through distinct struct types
+  EXPECT_TRUE(hasFunction(M, "id_i32"));
+  EXPECT_FALSE(hasFunction(M, "id_u32"));
+  EXPECT_TRUE(hasFunction(M, "keep_i32"));
+  EXPECT_FALSE(hasFunction(M, "keep_u32"));
+
+  // A different layout keeps its own body
+  EXPECT_TRUE(hasFunction(M, "id_f64"));
+}
@@ -109,6 +109,16 @@ TEST(Lexer, Identifiers) {
   EXPECT_EQ(Tokens.back().getKind().Value, TokenKind::Eof);
 }
 
+TEST(Lexer, IdentifiersAreInterned) {
+  auto Tokens = lexOk("foo bar foo fun");
+  ASSERT_EQ(Tokens.size(), 5u);
+  EXPECT_EQ(Tokens[0].getIdentifier(), Tokens[2].getIdentifier());
+  EXPECT_NE(Tokens[0].getIdentifier(), Tokens[1].getIdentifier());
+  EXPECT_EQ(Tokens[0].getIdentifier(), Identifier("foo"));
+  EXPECT_EQ(Tokens[0].getIdentifier().str(), "foo");
+  EXPECT_TRUE(Tokens[3].getIdentifier().empty());
+}
+
 TEST(Lexer, Wildcard) {
   auto Tokens = lexOk("_");
   ASSERT_GE(Tokens.size(), 2u);
@@ -186,7 +196,7 @@ TEST(Lexer, CharLiteralNull) {
 //===----------------------------------------------------------------------===//
 
 TEST(Lexer, SingleCharOperators) {
-  auto Tokens = lexOk("+ - * / % ! & ? . : = < > ( ) { } [ ] , ; |");
+  auto Tokens = lexOk("+ - * / % ! & ? . : = < > ( ) { } [ ] , ; | #");
   std::vector<TokenKind::Kind> Expected = {
       TokenKind::Plus,         TokenKind::Minus,    TokenKind::Star,
       TokenKind::Slash,        TokenKind::Percent,  TokenKind::Bang,
@@ -196,7 +206,7 @@ TEST(Lexer, SingleCharOperators) {
       TokenKind::OpenBrace,    TokenKind::CloseBrace,
       TokenKind::OpenBracket,  TokenKind::CloseBracket,
       TokenKind::Comma,        TokenKind::Semicolon, TokenKind::Pipe,
-      TokenKind::Eof,
+      TokenKind::Hash,         TokenKind::Eof,
   };
   ASSERT_EQ(Tokens.size(), Expected.size());
   for (size_t I = 0; I < Expected.size(); ++I) {
@@ -4,9 +4,12 @@
 #include "Lexer/Lexer.hpp"
 #include "Parser/Parser.hpp"
 #include "Sema/NameResolution/NameResolver.hpp"
+#include "Sema/NameResolution/SuggestionIndex.hpp"
+#include "Sema/NameResolution/SymbolTable.hpp"
 
 #include "AST/Nodes/Decl.hpp"
 
+#include <format>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,6 +39,31 @@ static bool resolve(const std::string &Src) {
   return !Diags.hasError();
 }
 
+// Helper: resolve several source files together as separate modules
+static bool resolveAll(const std::vector<std::string> &Srcs) {
+  DiagnosticConfig Cfg;
+  Cfg.UseColors = false;
+  DiagnosticManager Diags(Cfg);
+
+  std::vector<std::unique_ptr<ModuleDecl>> Owned;
+  std::vector<ModuleDecl *> Mods;
+  for (size_t I = 0; I < Srcs.size(); ++I) {
+    auto Path = std::format("test{}.phi", I);
+    Diags.getSrcManager().addSrcFile(Path, Srcs[I]);
+
+    Lexer L(Srcs[I], Path, &Diags);
+    Parser P(L.scan(), &Diags);
+    Owned.push_back(P.parse());
+    if (!Owned.back() || Diags.hasError())
+      return false;
+    Mods.push_back(Owned.back().get());
+  }
+
+  NameResolver NR(Mods, &Diags);
+  NR.resolve();
+  return !Diags.hasError();
+}
+
 //===----------------------------------------------------------------------===//
 // Variable Resolution
 //===----------------------------------------------------------------------===//
@@ -216,6 +244,31 @@ TEST(NameResolver, StructRedefinition) {
   )"));
 }
 
+//===----------------------------------------------------------------------===//
+// Attributes
+//===----------------------------------------------------------------------===//
+
+TEST(NameResolver, LayoutAttributes) {
+  EXPECT_TRUE(resolve(R"(
+    #[packed] struct Wire { public tag: u8, public len: u64 }
+    #[align(64)] struct Line { public x: i32 }
+    #[align(16)] enum Slot { Empty, Full: i64 }
+  )"));
+}
+
+TEST(NameResolver, UnknownAttribute) {
+  EXPECT_FALSE(resolve("#[inline] struct S { public x: i32 }"));
+  EXPECT_FALSE(resolve("#[repr(packed)] struct S { public x: i32 }"));
+  EXPECT_FALSE(resolve("#[repr(C, packed)] struct S { public x: i32 }"));
+}
+
+TEST(NameResolver, BadAlignAttribute) {
+  EXPECT_FALSE(resolve("#[align(12)] struct S { public x: i32 }"));
+  EXPECT_FALSE(resolve("#[align] struct S { public x: i32 }"));
+  EXPECT_FALSE(resolve("#[packed] enum E { A, B }"));
+  EXPECT_FALSE(resolve("#[packed] #[align(8)] struct S { public x: i32 }"));
+}
+
 //===----------------------------------------------------------------------===//
 // Generics
 //===----------------------------------------------------------------------===//
@@ -289,6 +342,104 @@ TEST(NameResolver, WhileLoopScope) {
   )"));
 }
 
+TEST(NameResolver, OutOfScopeAfterBlock) {
+  EXPECT_FALSE(resolve(R"(
+    fun main() {
+      for i in 0..10 {
+        const x = i;
+      }
+      const y = x;
+    }
+  )"));
+}
+
+TEST(NameResolver, SiblingScopesReuseName) {
+  EXPECT_TRUE(resolve(R"(
+    fun main() {
+      for i in 0..10 {
+        const x = i;
+      }
+      for i in 0..10 {
+        const x = i;
+        while x < 10 {
+          const y = x;
+          for j in 0..y {
+            const z = j + i;
+          }
+        }
+      }
+    }
+  )"));
+}
+
+//===----------------------------------------------------------------------===//
+// Imports
+//===----------------------------------------------------------------------===//
+
+static const std::string MathModule = R"(
+  module math;
+
+  public fun add(const a: i32, const b: i32) -> i32 { return a + b; }
+  public struct Vec { public x: i32 }
+  fun hidden() {}
+)";
+
+TEST(NameResolver, ImportedModuleQualified) {
+  EXPECT_TRUE(resolveAll({MathModule, R"(
+    import math;
+
+    fun main() {
+      const v = math::Vec { x: math::add(1, 2) };
+    }
+  )"}));
+}
+
+TEST(NameResolver, ImportedModuleAlias) {
+  EXPECT_TRUE(resolveAll({MathModule, R"(
+    import math as m;
+
+    fun main() {
+      const x = m::add(1, 2);
+    }
+  )"}));
+}
+
+TEST(NameResolver, ImportedModulePrivateItem) {
+  EXPECT_FALSE(resolveAll({MathModule, R"(
+    import math;
+
+    fun main() {
+      math::hidden();
+    }
+  )"}));
+}
+
+TEST(NameResolver, ImportedModuleDuplicateAlias) {
+  EXPECT_FALSE(resolveAll({MathModule, R"(
+    import math;
+    import math;
+
+    fun main() {}
+  )"}));
+}
+
+TEST(NameResolver, ImportVisibleInEveryBody) {
+  // Each body resolves on its own worker over the frozen module scope
+  EXPECT_TRUE(resolveAll({MathModule, R"(
+    import math as m;
+
+    fun first() -> i32 { const x = m::add(1, 2); return x; }
+    fun second() -> i32 { const x = m::add(3, 4); return x; }
+  )"}));
+}
+
+TEST(NameResolver, LocalsDoNotLeakBetweenBodies) {
+  EXPECT_FALSE(resolve(R"(
+    fun first() { const secret = 1; }
+    fun second() { const y = secret; }
+  )"));
+}
+
 //===----------------------------------------------------------------------===//
 // Arrays
 //===----------------------------------------------------------------------===//
@@ -335,3 +486,83 @@ TEST(NameResolver, TupleReturn) {
     }
   )"));
 }
+
+//===----------------------------------------------------------------------===//
+// Suggestions
+//===----------------------------------------------------------------------===//
+
+TEST(SuggestionIndex, TranspositionIsOneEdit) {
+  SuggestionIndex Index;
+  Index.add("length", nullptr);
+  Index.add("width", nullptr);
+
+  auto Best = Index.findClosest("lenght", 2);
+  ASSERT_TRUE(Best.has_value());
+  EXPECT_EQ(Best->Name, "length");
+  EXPECT_EQ(Best->Distance, 1u);
+}
+
+TEST(SuggestionIndex, NothingWithinBound) {
+  SuggestionIndex Index;
+  Index.add("length", nullptr);
+  Index.add("len", nullptr);
+
+  EXPECT_FALSE(Index.findClosest("xyz", 1).has_value());
+}
+
+TEST(SuggestionIndex, TiesGoToFirstAdded) {
+  SuggestionIndex Index;
+  Index.add("counter", nullptr);
+  Index.add("cat", nullptr);
+  Index.add("bat", nullptr);
+
+  auto Best = Index.findClosest("hat", 1);
+  ASSERT_TRUE(Best.has_value());
+  EXPECT_EQ(Best->Name, "cat");
+}
+
+TEST(SuggestionIndex, LongQueryFallsBackToFullDistance) {
+  // Queries over 64 characters do not fit the bit-parallel kernel
+  const std::string Name(70, 'a');
+  SuggestionIndex Index;
+  Index.add(Name, nullptr);
+  Index.add(std::string(70, 'b'), nullptr);
+
+  auto Best = Index.findClosest(Name.substr(1) + "c", 2);
+  ASSERT_TRUE(Best.has_value());
+  EXPECT_EQ(Best->Name, Name);
+  EXPECT_EQ(Best->Distance, 1u);
+}
+
+static std::unique_ptr<VarDecl> local(const char *Name) {
+  SrcSpan Span(SrcLocation{"test.phi", 1, 1});
+  return std::make_unique<VarDecl>(Span, Mutability::Const, Identifier(Name),
+                                   std::nullopt);
+}
+
+TEST(SymbolTable, SuggestionsFollowLocalScopes) {
+  auto Counter = local("counter");
+  SymbolTable Outer;
+  Outer.insert(Counter.get());
+
+  SymbolTable Inner(&Outer);
+  EXPECT_EQ(Inner.getClosestLocal("countr"), Counter.get());
+
+  auto County = local("county");
+  {
+    SymbolTable::ScopeGuard Scope(Inner);
+    Inner.insert(County.get());
+    // Equally close, so the nearer declaration wins
+    EXPECT_EQ(Inner.getClosestLocal("countr"), County.get());
+  }
+  EXPECT_EQ(Inner.getClosestLocal("countr"), Counter.get());
+}
+
+TEST(SymbolTable, SuggestionsSeeLaterBindings) {
+  SymbolTable Table;
+  EXPECT_EQ(Table.getClosestLocal("width"), nullptr);
+
+  auto Width = local("widht");
+  Table.insert(Width.get());
+  EXPECT_EQ(Table.getClosestLocal("width"), Width.get());
+}
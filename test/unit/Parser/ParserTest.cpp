@@ -150,6 +150,26 @@ TEST(Parser, SimpleStruct) {
   EXPECT_EQ(S->getFields()[1]->getId(), "y");
 }
 
+TEST(Parser, StructAttribute) {
+  auto Mod = parseOk("#[repr(C)] public struct Header { tag: u8, len: u64 }");
+  ASSERT_NE(Mod, nullptr);
+  ASSERT_EQ(Mod->getItems().size(), 1u);
+  auto *S = llvm::dyn_cast<StructDecl>(Mod->getItems()[0].get());
+  ASSERT_NE(S, nullptr);
+  ASSERT_NE(S->getAttr("repr"), nullptr);
+  EXPECT_EQ(S->getAttr("repr")->Args, std::vector<std::string>{"C"});
+}
+
+TEST(Parser, AttributeOnImportRejected) {
+  parseOk("import std::io;");
+  parseError("#[packed] import std::io;");
+}
+
+TEST(Parser, MalformedAttribute) {
+  parseError("#[align(8) struct S { x: i32 }");
+  parseError("#align(8)] struct S { x: i32 }");
+}
+
 TEST(Parser, StructWithMethod) {
   // Comma between last field and first method
   auto Mod = parseOk(R"(
@@ -478,6 +498,19 @@ TEST(Parser, ArrayTypeAnnotation) {
   EXPECT_TRUE(Fun->getParams()[0]->getType().isArray());
 }
 
+TEST(Parser, FixedArrayTypeAnnotation) {
+  auto Mod = parseOk("fun foo(const m: [[f64; 3]; 3]) {}");
+  ASSERT_NE(Mod, nullptr);
+  auto *Fun = llvm::dyn_cast<FunDecl>(Mod->getItems()[0].get());
+  ASSERT_NE(Fun, nullptr);
+  auto *Arr = llvm::dyn_cast<ArrayTy>(Fun->getParams()[0]->getType().getPtr());
+  ASSERT_NE(Arr, nullptr);
+  EXPECT_EQ(Arr->getLength(), 3u);
+  EXPECT_EQ(Arr->toString(), "[[f64; 3]; 3]");
+
+  parseError("struct S { v: [i32; n] }");
+}
+
 TEST(Parser, TupleTypeAnnotation) {
   auto Mod = parseOk("fun foo() -> (i32, f64) { return (1, 2.0); }");
   ASSERT_NE(Mod, nullptr);
@@ -5,6 +5,7 @@
 #include "Parser/Parser.hpp"
 #include "Sema/NameResolution/NameResolver.hpp"
 #include "Sema/TypeInference/Inferencer.hpp"
+#include "Sema/TypeInference/Unifier.hpp"
 
 #include "AST/Nodes/Decl.hpp"
 #include "AST/TypeSystem/Type.hpp"
@@ -116,6 +117,30 @@ TEST(TypeInference, VarExplicitType) {
   )"));
 }
 
+TEST(TypeInference, VarChainBindsLate) {
+  EXPECT_TRUE(sema(R"(
+    fun main() {
+      const a = 1;
+      const b = a;
+      const c = b;
+      const d = c;
+      const e = d + a;
+      const f: i64 = e;
+    }
+  )"));
+}
+
+TEST(TypeInference, VarChainBindsConflicting) {
+  EXPECT_FALSE(sema(R"(
+    fun main() {
+      const a = 1;
+      const b = a;
+      const c: i64 = b;
+      const d: i32 = a;
+    }
+  )"));
+}
+
 //===----------------------------------------------------------------------===//
 // Type Mismatch Errors
 //===----------------------------------------------------------------------===//
@@ -344,6 +369,24 @@ TEST(TypeInference, NestedArray) {
   )"));
 }
 
+TEST(TypeInference, FixedArrayCoercesToSlice) {
+  EXPECT_TRUE(sema(R"(
+    fun first(const xs: [i64]) -> i64 { return xs[0]; }
+    fun main() {
+      const m: [[f64; 2]; 2] = [[1.0, 0.0], [0.0, 1.0]];
+      const x = first([1, 2, 3]);
+    }
+  )"));
+}
+
+TEST(TypeInference, FixedArrayLengthMismatch) {
+  EXPECT_FALSE(sema(R"(
+    fun main() {
+      const v: [i32; 2] = [1, 2, 3];
+    }
+  )"));
+}
+
 //===----------------------------------------------------------------------===//
 // Tuple Type Inference
 //===----------------------------------------------------------------------===//
@@ -519,6 +562,18 @@ TEST(TypeInference, EnumMethodAndMatch) {
   )"));
 }
 
+TEST(TypeInference, GenericInsideTuple) {
+  EXPECT_TRUE(sema(R"(
+    fun first<T>(const pair: (T, T)) -> T {
+      return pair.0;
+    }
+
+    fun main() {
+      const y: i32 = first((1, 2));
+    }
+  )"));
+}
+
 TEST(TypeInference, NestedGeneric) {
   EXPECT_TRUE(sema(R"(
     struct Box<T> { public value: T }
@@ -535,3 +590,67 @@ TEST(TypeInference, NestedGeneric) {
     }
   )"));
 }
+
+//===----------------------------------------------------------------------===//
+// Independent Function Bodies
+//===----------------------------------------------------------------------===//
+
+TEST(TypeInference, BodiesInferIndependently) {
+  // Each body is solved on its own, so `y` takes unrelated types in each of
+  // them and the error in `bad` is still reported
+  EXPECT_FALSE(sema(R"(
+    fun ints(const x: i32) -> i32 { const y = x + 1; return y; }
+    fun bad() -> bool { const y = 1; return y; }
+    fun floats(const x: f64) -> f64 { const y = x + 1.0; return y; }
+  )"));
+  EXPECT_TRUE(sema(R"(
+    fun ints(const x: i32) -> i32 { const y = x + 1; return y; }
+    fun floats(const x: f64) -> f64 { const y = x + 1.0; return y; }
+  )"));
+}
+
+//===----------------------------------------------------------------------===//
+// Unifier Resolution Cache
+//===----------------------------------------------------------------------===//
+
+static SrcSpan span() { return SrcSpan(SrcLocation{"test.phi", 1, 1}); }
+
+TEST(TypeInference, UnifierReusesResolvedType) {
+  TypeUnifier U;
+  auto I32 = TypeCtx::getBuiltin(BuiltinTy::i32, span());
+  auto A = TypeCtx::getVar(VarTy::Any, span());
+  auto Tup = TypeCtx::getTuple({A, I32}, span());
+
+  EXPECT_EQ(U.resolve(Tup).getPtr(), Tup.getPtr());
+  EXPECT_EQ(U.getNumCacheHits(), 0u);
+  EXPECT_EQ(U.resolve(Tup).getPtr(), Tup.getPtr());
+  EXPECT_EQ(U.getNumCacheHits(), 1u);
+}
+
+TEST(TypeInference, UnifierBindOnlyInvalidatesDependents) {
+  TypeUnifier U;
+  auto I32 = TypeCtx::getBuiltin(BuiltinTy::i32, span());
+  auto A = TypeCtx::getVar(VarTy::Any, span());
+  auto B = TypeCtx::getVar(VarTy::Any, span());
+  auto TupA = TypeCtx::getTuple({A, I32}, span());
+  auto TupB = TypeCtx::getTuple({B, I32}, span());
+
+  U.resolve(TupA);
+  U.resolve(TupB);
+  ASSERT_TRUE(U.unify(B, I32));
+
+  // Binding B leaves the entry for (A, i32) usable
+  EXPECT_EQ(U.resolve(TupA).getPtr(), TupA.getPtr());
+  EXPECT_EQ(U.getNumCacheHits(), 1u);
+
+  // but (B, i32) has to be recomputed
+  auto Expected = TypeCtx::getTuple({I32, I32}, span());
+  EXPECT_EQ(U.resolve(TupB).getPtr(), Expected.getPtr());
+  EXPECT_EQ(U.getNumCacheHits(), 1u);
+
+  // Merging A into another variable invalidates (A, i32) as well
+  auto C = TypeCtx::getVar(VarTy::Any, span());
+  ASSERT_TRUE(U.unify(A, C));
+  ASSERT_TRUE(U.unify(C, I32));
+  EXPECT_EQ(U.resolve(TupA).getPtr(), Expected.getPtr());
+}